@@ -0,0 +1,143 @@
+#include "attackmaps.h"
+#include "gamestate.h"
+#include "evaltables.h"
+
+namespace {
+
+/** @brief Mobility bonus per reachable square for knights, bishops, rooks and queens */
+const int MOBILITY_BONUS[4] = {
+    EvalTables::makeScore(4, 4),
+    EvalTables::makeScore(5, 5),
+    EvalTables::makeScore(2, 4),
+    EvalTables::makeScore(1, 2)
+};
+
+/** @brief Typical number of reachable squares, which scores no mobility bonus */
+const int MOBILITY_BASELINE[4] = {4, 6, 6, 12};
+
+/** @brief Weight of each piece type attacking the enemy king zone */
+const int KING_ATTACK_WEIGHT[EvalTables::PIECE_TYPES] = {0, 2, 2, 3, 5, 0};
+
+/** @brief Percentage of the attack weight counted, by number of attackers (capped at 7) */
+const int KING_ATTACK_SCALE[8] = {0, 0, 50, 75, 88, 94, 97, 99};
+
+/** @brief Midgame penalty per unit of scaled king attack weight */
+const int KING_ATTACK_PENALTY = 20;
+
+/** @brief Penalty for a piece that is attacked and not defended */
+const int HANGING_PIECE = EvalTables::makeScore(-30, -20);
+
+/** @brief Penalty for a piece attacked by an enemy pawn */
+const int PAWN_THREAT = EvalTables::makeScore(-50, -40);
+
+/**
+ * @brief Gets the squares attacked by one piece
+ *
+ * @param type Piece type index (pawn, knight, bishop, rook, queen, king)
+ * @param color 0 for white, 1 for black
+ * @param square Square of the piece
+ * @param occupied Occupied squares, which block sliders
+ * @return Attacked squares
+ */
+Bitboard pieceAttacks(int type, int color, int square, Bitboard occupied) {
+    switch (type) {
+        case 0: return Bitboards::ATTACK_TABLES.pawn[color][square];
+        case 1: return Bitboards::ATTACK_TABLES.knight[square];
+        case 2: return Bitboards::bishopAttacks(square, occupied);
+        case 3: return Bitboards::rookAttacks(square, occupied);
+        case 4: return Bitboards::bishopAttacks(square, occupied) | Bitboards::rookAttacks(square, occupied);
+        default: return Bitboards::ATTACK_TABLES.king[square];
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Builds the maps from the piece bitboards of a position
+ *
+ * Pawn attacks are taken set-wise. Every other piece is visited once:
+ * its attack set is added to the maps, the squares it reaches outside
+ * its own pieces and the enemy pawns' attacks count towards mobility,
+ * and it is recorded as a king attacker if it reaches the enemy king zone.
+ *
+ * @param gs Position to read
+ */
+void AttackMaps::build(const GameState& gs) {
+    const int types = EvalTables::PIECE_TYPES;
+    Bitboard occupied = gs.colorPieces(0) | gs.colorPieces(1);
+
+    for (int color = 0; color < 2; color++) {
+        Bitboard pawns = gs.pieceBitboards[color * types];
+        Bitboard left = (color == 0) ? ((pawns >> 9) & ~Bitboards::FILE_H) : ((pawns << 7) & ~Bitboards::FILE_H);
+        Bitboard right = (color == 0) ? ((pawns >> 7) & ~Bitboards::FILE_A) : ((pawns << 9) & ~Bitboards::FILE_A);
+        byPiece[color * types] = left | right;
+        byColor[color] = left | right;
+        attackedTwice[color] = left & right;
+
+        int kingSquare = Bitboards::lsb(gs.pieceBitboards[color * types + 5]);
+        kingZone[color] = Bitboards::ATTACK_TABLES.king[kingSquare] | Bitboards::squareBit(kingSquare);
+        mobility[color] = 0;
+        kingAttackers[color] = 0;
+        kingAttackWeight[color] = 0;
+    }
+
+    for (int color = 0; color < 2; color++) {
+        int enemy = 1 - color;
+        Bitboard mobilityArea = ~(gs.colorPieces(color) | byPiece[enemy * types]);
+
+        for (int type = 1; type < types; type++) {
+            int piece = color * types + type;
+            byPiece[piece] = 0;
+            Bitboard pieces = gs.pieceBitboards[piece];
+            while (pieces) {
+                int square = Bitboards::popLsb(pieces);
+                Bitboard attacks = pieceAttacks(type, color, square, occupied);
+                attackedTwice[color] |= byColor[color] & attacks;
+                byColor[color] |= attacks;
+                byPiece[piece] |= attacks;
+
+                if (type == 5) {
+                    continue;
+                }
+                mobility[color] += MOBILITY_BONUS[type - 1] *
+                                   (Bitboards::popCount(attacks & mobilityArea) - MOBILITY_BASELINE[type - 1]);
+                if (attacks & kingZone[enemy]) {
+                    kingAttackers[color]++;
+                    kingAttackWeight[color] += KING_ATTACK_WEIGHT[type];
+                }
+            }
+        }
+    }
+
+    for (int color = 0; color < 2; color++) {
+        int enemy = 1 - color;
+        Bitboard pieces = gs.colorPieces(color) & ~gs.pieceBitboards[color * types]
+                        & ~gs.pieceBitboards[color * types + 5];
+        hanging[color] = pieces & byColor[enemy] & ~byColor[color];
+        threatenedByPawns[color] = pieces & byPiece[enemy * types];
+    }
+}
+
+/**
+ * @brief Evaluates mobility, king safety and hanging pieces
+ *
+ * King safety only counts once at least two pieces attack the king zone,
+ * and then grows with the number of attackers. It is a midgame term.
+ *
+ * @return Packed midgame/endgame score, white minus black
+ */
+int AttackMaps::score() const {
+    int score = mobility[0] - mobility[1];
+
+    for (int color = 0; color < 2; color++) {
+        int enemy = 1 - color;
+        int sign = (color == 0) ? 1 : -1;
+
+        int danger = kingAttackWeight[enemy] * KING_ATTACK_SCALE[qMin(kingAttackers[enemy], 7)] / 100;
+        score -= sign * EvalTables::makeScore(danger * KING_ATTACK_PENALTY, 0);
+
+        score += sign * (HANGING_PIECE * Bitboards::popCount(hanging[color]) +
+                         PAWN_THREAT * Bitboards::popCount(threatenedByPawns[color]));
+    }
+    return score;
+}
@@ -0,0 +1,66 @@
+#ifndef ATTACKMAPS_H
+#define ATTACKMAPS_H
+
+#include "bitboard.h"
+
+class GameState;
+
+/**
+ * @struct AttackMaps
+ * @brief Squares attacked by every piece of a position, built once per node
+ *
+ * The evaluation reads mobility, king-zone attacks and hanging pieces from
+ * here, and the search uses the same maps to tell defended captures from
+ * free ones, so the attack sets are never generated twice for one
+ * position. GameState::attackMaps() builds them on demand and keeps them
+ * until the position changes.
+ *
+ * Pieces are indexed color * 6 + type and colors with white as 0, as in
+ * evaltables.h.
+ *
+ * @author Group 69 (mittensOS)
+ */
+struct AttackMaps {
+    /** @brief Squares attacked by each kind of piece (color * 6 + type) */
+    Bitboard byPiece[12];
+
+    /** @brief Squares attacked by each color */
+    Bitboard byColor[2];
+
+    /** @brief Squares attacked at least twice by each color */
+    Bitboard attackedTwice[2];
+
+    /** @brief King square and its neighbours, for each color's king */
+    Bitboard kingZone[2];
+
+    /** @brief Packed midgame/endgame mobility score of each color */
+    int mobility[2];
+
+    /** @brief Number of each color's pieces attacking the enemy king zone */
+    int kingAttackers[2];
+
+    /** @brief Summed weights of each color's pieces attacking the enemy king zone */
+    int kingAttackWeight[2];
+
+    /** @brief Each color's knights, bishops, rooks and queens attacked by the enemy and not defended */
+    Bitboard hanging[2];
+
+    /** @brief Each color's knights, bishops, rooks and queens attacked by an enemy pawn */
+    Bitboard threatenedByPawns[2];
+
+    /**
+     * @brief Builds the maps from the piece bitboards of a position
+     *
+     * @param gs Position to read
+     */
+    void build(const GameState& gs);
+
+    /**
+     * @brief Evaluates mobility, king safety and hanging pieces
+     *
+     * @return Packed midgame/endgame score, white minus black
+     */
+    int score() const;
+};
+
+#endif // ATTACKMAPS_H
@@ -0,0 +1,825 @@
+#include "bench.h"
+#include "chessai.h"
+#include "gamestate.h"
+#include "nnue.h"
+#include "syzygy.h"
+#include "tablebase.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <cstring>
+#ifdef MITTENS_ALLOC_CHECK
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+}
+#endif
+#endif
+
+namespace {
+
+#ifdef MITTENS_ALLOC_CHECK
+/** @brief Heap allocations made by this thread while counting, or -1 when not counting */
+thread_local qint64 allocationCount = -1;
+
+/**
+ * @brief Counts an allocation if counting is on for this thread
+ */
+inline void countAllocation() {
+    if (allocationCount >= 0) {
+        allocationCount++;
+    }
+}
+
+/**
+ * @brief Allocates memory for the operator new replacements, counting it
+ *
+ * With the GNU C library the malloc wrappers below do the counting.
+ *
+ * @param size Bytes wanted
+ * @return void* The memory, or nullptr if there is none
+ */
+void* countedAllocate(std::size_t size) {
+#ifndef __GLIBC__
+    countAllocation();
+#endif
+    return std::malloc(size > 0 ? size : 1);
+}
+
+/**
+ * @brief Allocates aligned memory for the operator new replacements, counting it
+ *
+ * aligned_alloc is not wrapped, so this counts on every platform.
+ *
+ * @param size Bytes wanted
+ * @param alignment Alignment, a power of two
+ * @return void* The memory, or nullptr if there is none; freed by countedFreeAligned()
+ */
+void* countedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+    countAllocation();
+    std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    return _aligned_malloc(size > 0 ? size : 1, align);
+#else
+    // aligned_alloc wants a size that is a multiple of the alignment
+    return std::aligned_alloc(align, (size + align) / align * align);
+#endif
+}
+
+/**
+ * @brief Frees memory from countedAllocateAligned()
+ *
+ * @param pointer The memory, or nullptr
+ */
+void countedFreeAligned(void* pointer) {
+#ifdef _WIN32
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+#endif
+
+/**
+ * @brief Compares incremental and reference network evaluations in a subtree
+ *
+ * @param gs Position to walk (restored before returning)
+ * @param network Network attached to gs
+ * @param depth Remaining plies to walk
+ * @param checked Incremented for every position compared
+ * @return Number of positions where the evaluations differed
+ */
+int compareNnueSubtree(GameState& gs, const NnueNetwork& network, int depth, qint64& checked) {
+    NnueAccumulator reference;
+    network.refreshReference(reference, gs);
+    int incremental = network.evaluate(gs.accumulator, gs.whiteToMove);
+    int expected = network.evaluateReference(reference, gs.whiteToMove);
+    bool accumulatorMatches = std::memcmp(reference.values, gs.accumulator.values, sizeof(reference.values)) == 0;
+
+    checked++;
+    int mismatches = (incremental != expected || !accumulatorMatches) ? 1 : 0;
+    if (depth == 0) {
+        return mismatches;
+    }
+
+    QVector<Move> moves = gs.getValidMoves();
+    for (const Move& move : moves) {
+        gs.makeMove(move);
+        mismatches += compareNnueSubtree(gs, network, depth - 1, checked);
+        gs.undoMove();
+    }
+    return mismatches;
+}
+
+/**
+ * @brief Checks that MultiPV lines are distinct root moves, best first
+ *
+ * @param lines Lines of the search
+ * @param rootMoves Legal moves of the position
+ * @param expectedLines Number of lines the search must return
+ * @return True if the lines are consistent
+ */
+bool checkAnalysisLines(const QVector<AnalysisLine>& lines, const QVector<Move>& rootMoves, int expectedLines) {
+    if (lines.size() != expectedLines) {
+        return false;
+    }
+    for (int i = 0; i < lines.size(); i++) {
+        bool legal = false;
+        for (const Move& move : rootMoves) {
+            legal = legal || move.moveID == lines[i].move.moveID;
+        }
+        if (!legal || lines[i].pv.isEmpty() || lines[i].pv[0].moveID != lines[i].move.moveID ||
+            lines[i].depth != lines[0].depth) {
+            return false;
+        }
+        for (int j = 0; j < i; j++) {
+            if (lines[j].move.moveID == lines[i].move.moveID || lines[j].score < lines[i].score) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Builds a FEN from pieces placed on squares
+ *
+ * @param squares FEN letter of each square, rank 8 first, or 0 for an empty square
+ * @param whiteToMove Side to move
+ * @return QString FEN without castling rights or en passant square, with a fresh fifty-move counter
+ */
+QString fenFromSquares(const char squares[64], bool whiteToMove) {
+    QString fen;
+    for (int row = 0; row < 8; row++) {
+        int empty = 0;
+        for (int col = 0; col < 8; col++) {
+            char piece = squares[row * 8 + col];
+            if (piece == 0) {
+                empty++;
+                continue;
+            }
+            if (empty > 0) {
+                fen += QString::number(empty);
+                empty = 0;
+            }
+            fen += QLatin1Char(piece);
+        }
+        if (empty > 0) {
+            fen += QString::number(empty);
+        }
+        if (row < 7) {
+            fen += '/';
+        }
+    }
+    return fen + (whiteToMove ? " w - - 0 1" : " b - - 0 1");
+}
+
+/**
+ * @brief Checks the Syzygy tables of one ending against the endgame tablebase
+ *
+ * Places the pieces at random until enough legal positions have been
+ * compared. The tablebase ignores the fifty-move rule, so every mate it
+ * finds within 100 plies must be a plain win or loss in the Syzygy WDL
+ * table. The DTZ must have the same sign, and since a mate resets the
+ * counter too, it can't be further away than the mate (Syzygy DTZ values
+ * may be one ply long).
+ *
+ * @param syzygy Tables to check
+ * @param reference Tablebase to check them against
+ * @param pieces FEN letters of the pieces, kings included (e.g. "KQk")
+ * @param random Source of the placements
+ * @param out Stream for the results
+ * @return int Number of positions that disagreed or could no longer be read,
+ *         or -1 if either side has no table for the ending
+ */
+int verifySyzygyEnding(SyzygyTablebase& syzygy, const EndgameTablebase& reference, const QString& pieces,
+                       QRandomGenerator& random, QTextStream& out) {
+    const int samples = 2000;
+    int compared = 0;
+    int mismatches = 0;
+    for (int attempt = 0; attempt < samples * 20 && compared < samples; attempt++) {
+        char squares[64] = {};
+        bool placed = true;
+        for (QChar letter : pieces) {
+            int square = random.bounded(64);
+            bool pawn = letter.toUpper() == 'P';
+            if (squares[square] != 0 || (pawn && (square < 8 || square >= 56))) {
+                placed = false;
+                break;
+            }
+            squares[square] = letter.toLatin1();
+        }
+        bool whiteToMove = random.bounded(2) == 0;
+        GameState waiting;
+        if (!placed || !waiting.loadFen(fenFromSquares(squares, !whiteToMove)) || waiting.isInCheck()) {
+            continue;
+        }
+
+        QString fen = fenFromSquares(squares, whiteToMove);
+        GameState gs;
+        gs.loadFen(fen);
+        int wdl = 0;
+        int dtm = 0;
+        if (!reference.probe(gs, wdl, dtm)) {
+            return -1;
+        }
+        QVector<Move> moves = gs.getValidMoves();
+        int syzygyWdl = 0;
+        int dtz = 0;
+        bool covered = syzygy.probeWdl(gs, moves, syzygyWdl);
+        if (!covered && compared == 0) {
+            return -1;
+        }
+        compared++;
+
+        covered = covered && syzygy.probeDtz(gs, dtz);
+        int sign = (syzygyWdl > 0) - (syzygyWdl < 0);
+        bool matches = covered && sign == wdl && (wdl == 0 || dtm > 100 || qAbs(syzygyWdl) == SyzygyTablebase::Win) &&
+                       (dtz > 0) - (dtz < 0) == sign && qAbs(dtz) <= dtm + 1;
+        if (!matches) {
+            if (mismatches < 5) {
+                out << "  " << fen << "  tablebase wdl " << wdl << " dtm " << dtm
+                    << "  syzygy wdl " << syzygyWdl << " dtz " << (covered ? QString::number(dtz) : QString("-"))
+                    << Qt::endl;
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+#ifdef MITTENS_ALLOC_CHECK
+#ifdef __GLIBC__
+// Qt containers allocate their storage with malloc and realloc, so wrapping
+// them sees the QVector and QString growth the search must avoid. Only this
+// build wraps them; the normal program keeps the C library's allocator.
+extern "C" {
+
+void* malloc(size_t size) {
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    countAllocation();
+    return __libc_realloc(pointer, size);
+}
+
+}
+#endif
+
+// Replacing every form of operator new and delete also sees aligned
+// allocations, and every allocation made with new where malloc can't be
+// wrapped. Releasing memory is not counted: it cannot happen without an
+// allocation first.
+
+void* operator new(std::size_t size) {
+    void* pointer = countedAllocate(size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* pointer = countedAllocateAligned(size, alignment);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    countedFreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    countedFreeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    countedFreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    countedFreeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    countedFreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    countedFreeAligned(pointer);
+}
+#endif
+
+/**
+ * @brief Fixed position suite used by the benchmarks
+ */
+const QStringList Bench::positions = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    "8/8/8/4k3/8/8/3QK3/8 w - - 0 1"
+};
+
+/**
+ * @brief Searches the suite to a fixed depth and prints a node signature
+ *
+ * Uses principal variation search with the root moves in generation
+ * order, no time budget and no endgame tables. Only the first search of
+ * each position is timed.
+ *
+ * @param depth Search depth
+ * @return int Process exit code (0 if both searches of every position matched)
+ */
+int Bench::run(int depth) {
+    QTextStream out(stdout);
+    ChessAI ai;
+    ai.searchAlgorithm = ChessAI::PrincipalVariation;
+    ai.setRandomSeed(1);
+    // Tables cached in the tablebase directory would make the signature depend on it
+    ai.useTablebase = false;
+    qint64 totalNodes = 0;
+    qint64 totalTimeMs = 0;
+    int mismatches = 0;
+
+    out << "depth " << depth << "  evaluation " << (ai.nnueActive() ? "network" : "classical") << Qt::endl;
+
+    for (int i = 0; i < positions.size(); i++) {
+        GameState gs;
+        if (!gs.loadFen(positions[i])) {
+            out << "invalid FEN: " << positions[i] << Qt::endl;
+            return 1;
+        }
+        QVector<Move> rootMoves = gs.getValidMoves();
+
+        ai.resetSearchState();
+        QElapsedTimer timer;
+        timer.start();
+        Move move = ai.searchRootMoves(&gs, rootMoves, depth);
+        qint64 timeMs = timer.elapsed();
+        qint64 nodes = ai.nodeCount();
+
+        // The same search again must visit exactly the same nodes
+        ai.resetSearchState();
+        ai.searchRootMoves(&gs, rootMoves, depth);
+        bool reproducible = ai.nodeCount() == nodes;
+        if (!reproducible) {
+            mismatches++;
+        }
+
+        totalNodes += nodes;
+        totalTimeMs += timeMs;
+        out << "position " << (i + 1) << "  nodes " << nodes << "  time " << timeMs << " ms"
+            << "  (" << move.toString() << " " << ai.lastScore() << ")";
+        if (!reproducible) {
+            out << "  MISMATCH " << ai.nodeCount();
+        }
+        out << Qt::endl;
+    }
+
+    out << "nodes " << totalNodes << Qt::endl;
+    out << "time " << totalTimeMs << " ms" << Qt::endl;
+    out << "nps " << (totalNodes * 1000 / qMax<qint64>(totalTimeMs, 1)) << Qt::endl;
+    if (mismatches > 0) {
+        out << mismatches << " positions searched differently the second time" << Qt::endl;
+    }
+    return (mismatches == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Compares plain alpha-beta against principal variation search
+ *
+ * Each position is searched twice with the root moves in generation order,
+ * so both runs see the same tree and the counts are reproducible.
+ *
+ * @param depth Search depth for both algorithms
+ * @return int Process exit code (0 on success)
+ */
+int Bench::comparePvsNodeCounts(int depth) {
+    QTextStream out(stdout);
+    ChessAI ai;
+    ai.useTablebase = false;
+    qint64 totalAlphaBeta = 0;
+    qint64 totalPvs = 0;
+
+    out << "depth " << depth << Qt::endl;
+
+    for (int i = 0; i < positions.size(); i++) {
+        GameState gs;
+        if (!gs.loadFen(positions[i])) {
+            out << "invalid FEN: " << positions[i] << Qt::endl;
+            return 1;
+        }
+        QVector<Move> rootMoves = gs.getValidMoves();
+
+        // Plain fixed-depth alpha-beta with the full window
+        ai.searchAlgorithm = ChessAI::AlphaBeta;
+        Move alphaBetaMove = ai.searchRootMoves(&gs, rootMoves, depth);
+        qint64 alphaBetaNodes = ai.nodeCount();
+        int alphaBetaScore = ai.lastScore();
+
+        // Iterative deepening with aspiration windows and PVS, from an empty table
+        ai.searchAlgorithm = ChessAI::PrincipalVariation;
+        ai.clearTranspositionTable();
+        Move pvsMove = ai.searchRootMoves(&gs, rootMoves, depth);
+        qint64 pvsNodes = ai.nodeCount();
+        int pvsScore = ai.lastScore();
+        double pvsCacheHitRate = ai.evalCacheHitRate();
+
+        totalAlphaBeta += alphaBetaNodes;
+        totalPvs += pvsNodes;
+
+        out << "position " << (i + 1)
+            << "  alpha-beta " << alphaBetaNodes << " (" << alphaBetaMove.toString() << " " << alphaBetaScore << ")"
+            << "  pvs " << pvsNodes << " (" << pvsMove.toString() << " " << pvsScore << ")"
+            << "  eval cache hits " << QString::number(100.0 * pvsCacheHitRate, 'f', 1) << "%"
+            << Qt::endl;
+    }
+
+    out << "total  alpha-beta " << totalAlphaBeta << "  pvs " << totalPvs;
+    if (totalAlphaBeta > 0) {
+        out << "  ratio " << QString::number(double(totalPvs) / totalAlphaBeta, 'f', 3);
+    }
+    out << Qt::endl;
+
+    return 0;
+}
+
+/**
+ * @brief Compares a MultiPV search against separate searches per line
+ *
+ * @param depth Search depth
+ * @param lineCount Number of lines
+ * @return int Process exit code (0 on success)
+ */
+int Bench::compareMultiPv(int depth, int lineCount) {
+    QTextStream out(stdout);
+    ChessAI ai;
+    ai.searchAlgorithm = ChessAI::PrincipalVariation;
+    ai.useTablebase = false;
+    qint64 totalMultiPv = 0;
+    qint64 totalSeparate = 0;
+
+    out << "depth " << depth << "  lines " << lineCount << Qt::endl;
+
+    for (int i = 0; i < positions.size(); i++) {
+        GameState gs;
+        if (!gs.loadFen(positions[i])) {
+            out << "invalid FEN: " << positions[i] << Qt::endl;
+            return 1;
+        }
+        QVector<Move> rootMoves = gs.getValidMoves();
+
+        ai.multiPv = lineCount;
+        ai.clearTranspositionTable();
+        ai.searchRootMoves(&gs, rootMoves, depth);
+        qint64 multiPvNodes = ai.nodeCount();
+        QVector<AnalysisLine> lines = ai.lastAnalysisLines();
+
+        // One search per line, each without the moves of the lines before it
+        ai.multiPv = 1;
+        qint64 separateNodes = 0;
+        QVector<Move> remaining = rootMoves;
+        out << "position " << (i + 1) << Qt::endl;
+        for (int line = 0; line < lines.size() && !remaining.isEmpty(); line++) {
+            ai.clearTranspositionTable();
+            Move move = ai.searchRootMoves(&gs, remaining, depth);
+            separateNodes += ai.nodeCount();
+            out << "  " << (line + 1) << ". " << lines[line].move.toString() << " " << lines[line].score
+                << "  separate " << move.toString() << " " << ai.lastScore() << Qt::endl;
+
+            for (int j = 0; j < remaining.size(); j++) {
+                if (remaining[j].moveID == lines[line].move.moveID) {
+                    remaining.removeAt(j);
+                    break;
+                }
+            }
+        }
+
+        totalMultiPv += multiPvNodes;
+        totalSeparate += separateNodes;
+        out << "  nodes  multipv " << multiPvNodes << "  separate " << separateNodes << Qt::endl;
+    }
+
+    out << "total  multipv " << totalMultiPv << "  separate " << totalSeparate;
+    if (totalSeparate > 0) {
+        out << "  ratio " << QString::number(double(totalMultiPv) / totalSeparate, 'f', 3);
+    }
+    out << Qt::endl;
+
+    // More lines than legal moves: one line per move (the king is in check with three escapes)
+    int failures = 0;
+    GameState fewMoves;
+    fewMoves.loadFen("4k3/8/8/8/8/8/8/r3K3 w - - 0 1");
+    QVector<Move> fewRootMoves = fewMoves.getValidMoves();
+    ai.multiPv = fewRootMoves.size() + 2;
+    ai.clearTranspositionTable();
+    ai.searchRootMoves(&fewMoves, fewRootMoves, depth);
+    bool fewOk = checkAnalysisLines(ai.lastAnalysisLines(), fewRootMoves, fewRootMoves.size());
+    out << "more lines than moves  " << ai.lastAnalysisLines().size() << " of " << ai.multiPv
+        << " lines  " << (fewOk ? "ok" : "MISMATCH") << Qt::endl;
+    failures += fewOk ? 0 : 1;
+
+    // Stopped by the node budgets of the weaker levels, mostly partway through an iteration:
+    // the lines of the last completed iteration
+    GameState stopped;
+    stopped.loadFen(positions[0]);
+    QVector<Move> stoppedRootMoves = stopped.getValidMoves();
+    ai.multiPv = qMax(lineCount, 2);
+    ai.setRandomSeed(1);
+    for (int level = 1; level <= 5; level++) {
+        ai.setSkillLevel(level);
+        ai.searchRootMoves(&stopped, stoppedRootMoves, ChessAI::MAX_DEPTH);
+        const QVector<AnalysisLine>& stoppedLines = ai.lastAnalysisLines();
+        bool stoppedOk = !stoppedLines.isEmpty() && stoppedLines[0].depth < ChessAI::MAX_DEPTH &&
+                         checkAnalysisLines(stoppedLines, stoppedRootMoves, ai.multiPv);
+        out << "stopped at level " << level << "  depth " << (stoppedLines.isEmpty() ? 0 : stoppedLines[0].depth)
+            << "  nodes " << ai.nodeCount() << "  " << (stoppedOk ? "ok" : "MISMATCH") << Qt::endl;
+        failures += stoppedOk ? 0 : 1;
+    }
+    ai.setSkillLevel(ChessAI::MAX_SKILL_LEVEL);
+
+    return failures > 0 ? 1 : 0;
+}
+
+/**
+ * @brief Checks the network kernels against the scalar reference code
+ *
+ * @param weightsPath Weight file to load, or empty for random weights
+ * @return int Process exit code (0 if every evaluation matched)
+ */
+int Bench::verifyNnue(const QString& weightsPath) {
+    QTextStream out(stdout);
+    NnueNetwork network;
+    if (weightsPath.isEmpty()) {
+        network.initRandom(1);
+    } else if (!network.load(weightsPath)) {
+        out << "could not load network: " << weightsPath << Qt::endl;
+        return 1;
+    }
+    out << "kernels " << NnueNetwork::kernelName() << Qt::endl;
+
+    qint64 checked = 0;
+    int mismatches = 0;
+    for (int i = 0; i < positions.size(); i++) {
+        GameState gs;
+        if (!gs.loadFen(positions[i])) {
+            out << "invalid FEN: " << positions[i] << Qt::endl;
+            return 1;
+        }
+        gs.setNetwork(&network);
+        int positionMismatches = compareNnueSubtree(gs, network, 3, checked);
+        out << "position " << (i + 1) << "  eval " << network.evaluate(gs.accumulator, gs.whiteToMove)
+            << "  mismatches " << positionMismatches << Qt::endl;
+        mismatches += positionMismatches;
+    }
+
+    out << "checked " << checked << " positions, " << mismatches << " mismatches" << Qt::endl;
+    return (mismatches == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Builds the endgame tables and saves them for the AI
+ *
+ * The material of each well-known ending is read from a FEN, so the
+ * material keys come from GameState as they do in the search.
+ *
+ * @param maxPieces Most pieces, kings included
+ * @param directory Directory to save the tables in (created if missing)
+ * @return int Process exit code (0 on success)
+ */
+int Bench::generateTablebases(int maxPieces, const QString& directory) {
+    QTextStream out(stdout);
+    if (!QDir().mkpath(directory)) {
+        out << "could not create directory: " << directory << Qt::endl;
+        return 1;
+    }
+
+    EndgameTablebase tablebase;
+    tablebase.setCacheDirectory(directory);
+    QElapsedTimer timer;
+    timer.start();
+    int tableCount = tablebase.generateAll(maxPieces);
+    out << tableCount << " tables in " << directory << "  time " << timer.elapsed() << " ms" << Qt::endl;
+
+    const QStringList endings = {
+        "8/8/8/4k3/8/8/3QK3/8 w - - 0 1",
+        "8/8/8/4k3/8/8/3RK3/8 w - - 0 1",
+        "8/8/8/4k3/8/8/3PK3/8 w - - 0 1",
+        "8/8/8/4k3/8/8/2BNK3/8 w - - 0 1",
+        "8/8/8/3rk3/8/8/3QK3/8 w - - 0 1"
+    };
+    for (const QString& fen : endings) {
+        GameState gs;
+        gs.loadFen(fen);
+        if (tablebase.contains(gs.materialKey)) {
+            out << EndgameTablebase::signature(gs.materialKey)
+                << "  longest mate " << tablebase.longestMate(gs.materialKey) << " plies" << Qt::endl;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Probes positions in the Syzygy tables and prints the results
+ *
+ * @param path Directories of the tables, separated by QDir::listSeparator()
+ * @param fen Position to probe, or an empty string for the built-in endings
+ * @return int Process exit code (0 if every position was covered)
+ */
+int Bench::probeSyzygy(const QString& path, const QString& fen) {
+    QTextStream out(stdout);
+    SyzygyTablebase syzygy;
+    int tableCount = syzygy.setPath(path);
+    out << tableCount << " tables in " << path << "  up to " << syzygy.maxPieces() << " pieces" << Qt::endl;
+
+    const QStringList endings = fen.isEmpty() ? QStringList{
+        "8/8/8/3rk3/8/8/3QK3/8 w - - 0 1",
+        "8/8/3k4/8/3PK3/8/r7/7R w - - 0 1",
+        "8/6P1/8/8/4k3/8/1q5Q/4K3 w - - 0 1"
+    } : QStringList{fen};
+
+    int uncovered = 0;
+    for (const QString& position : endings) {
+        GameState gs;
+        gs.loadFen(position);
+        QVector<Move> moves = gs.getValidMoves();
+        QElapsedTimer timer;
+        timer.start();
+        int wdl = 0;
+        int dtz = 0;
+        if (!syzygy.probeWdl(gs, moves, wdl) || !syzygy.probeDtz(gs, dtz) ||
+            !syzygy.filterRootMoves(gs, moves)) {
+            out << position << "  not covered" << Qt::endl;
+            uncovered++;
+            continue;
+        }
+        out << position << "  wdl " << wdl << "  dtz " << dtz << "  moves";
+        for (const Move& move : moves) {
+            out << ' ' << move.getChessNotation();
+        }
+        out << "  time " << timer.elapsed() << " ms" << Qt::endl;
+    }
+    if (!fen.isEmpty()) {
+        return (uncovered == 0) ? 0 : 1;
+    }
+
+    // Check the decoder against the tables built here; four-piece ones only if tbgen has cached them
+    EndgameTablebase reference;
+    reference.setCacheDirectory(ChessAI::TABLEBASE_DIR);
+    reference.loadCachedTables();
+    reference.generateAll(3);
+    const QStringList verified = {
+        "KQk", "KRk", "KBk", "KNk", "KPk",
+        "KQkr", "KRkb", "KRkn", "KQkq", "KBNk", "KNNk", "KQkp", "KRkp", "KPPk"
+    };
+    QRandomGenerator random(1);
+    int endingsChecked = 0;
+    int mismatches = 0;
+    for (const QString& pieces : verified) {
+        int result = verifySyzygyEnding(syzygy, reference, pieces, random, out);
+        if (result < 0) {
+            out << pieces << "  skipped, no table" << Qt::endl;
+            continue;
+        }
+        endingsChecked++;
+        mismatches += result;
+        out << pieces << "  " << (result == 0 ? QString("ok") : QString::number(result) + " MISMATCHES") << Qt::endl;
+    }
+    out << endingsChecked << " endings checked against the endgame tablebase  mismatches " << mismatches << Qt::endl;
+    return (uncovered == 0 && endingsChecked > 0 && mismatches == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Checks that the search does not allocate memory
+ *
+ * The first search of each position fills the move buffers and the
+ * game state's logs to their working size; only the second one is
+ * counted. Both use principal variation search with the root moves in
+ * generation order.
+ *
+ * @param depth Search depth
+ * @return int Process exit code (0 if no search allocated)
+ */
+int Bench::checkSearchAllocations(int depth) {
+    QTextStream out(stdout);
+#ifndef MITTENS_ALLOC_CHECK
+    Q_UNUSED(depth);
+    out << "allocation counting needs a build with MITTENS_ALLOC_CHECK defined" << Qt::endl;
+    return 1;
+#else
+    // The counter must see Qt containers, which allocate with malloc
+    allocationCount = 0;
+    {
+        QVector<Move> probe;
+        probe.reserve(ChessAI::MAX_MOVES);
+    }
+    qint64 probeAllocations = allocationCount;
+    allocationCount = -1;
+    out << "self-test  QVector allocations " << probeAllocations << Qt::endl;
+    if (probeAllocations == 0) {
+        out << "allocation counting does not see Qt containers on this platform" << Qt::endl;
+        return 1;
+    }
+
+    ChessAI ai;
+    ai.searchAlgorithm = ChessAI::PrincipalVariation;
+    ai.useTablebase = false;
+    qint64 totalAllocations = 0;
+
+    out << "depth " << depth << Qt::endl;
+
+    for (int i = 0; i < positions.size(); i++) {
+        GameState gs;
+        if (!gs.loadFen(positions[i])) {
+            out << "invalid FEN: " << positions[i] << Qt::endl;
+            return 1;
+        }
+        QVector<Move> rootMoves = gs.getValidMoves();
+        ai.searchRootMoves(&gs, rootMoves, depth);
+
+        allocationCount = 0;
+        ai.searchRootMoves(&gs, rootMoves, depth);
+        qint64 allocations = allocationCount;
+        allocationCount = -1;
+
+        totalAllocations += allocations;
+        out << "position " << (i + 1) << "  nodes " << ai.nodeCount()
+            << "  allocations " << allocations << Qt::endl;
+    }
+
+    out << "total allocations " << totalAllocations << Qt::endl;
+    return (totalAllocations == 0) ? 0 : 1;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <QStringList>
+
+/**
+ * @class Bench
+ * @brief Command-line search benchmarks for the chess engine
+ *
+ * Runs the engine on a fixed suite of positions without the GUI so that
+ * changes to the search can be compared by node count. The searches don't
+ * use the endgame tables, so results don't depend on what is cached.
+ *
+ * @author Group 69 (mittensOS)
+ */
+class Bench {
+public:
+    /**
+     * @brief Fixed position suite in FEN
+     *
+     * Covers the opening, tactical middlegames with castling and en passant
+     * available, and a few simple endgames.
+     */
+    static const QStringList positions;
+
+    /**
+     * @brief Searches the suite to a fixed depth and prints a node signature
+     *
+     * Every position is searched from a reset search state with a fixed
+     * random seed, so the total node count is the same on every run and
+     * machine for an unchanged engine; a change in it means the search
+     * itself changed. Each position is searched twice to check this. Prints
+     * the nodes and time per position, the total nodes and the speed in
+     * nodes per second.
+     *
+     * @param depth Search depth
+     * @return Process exit code (0 if both searches of every position matched)
+     */
+    static int run(int depth);
+
+    /**
+     * @brief Compares plain alpha-beta against principal variation search
+     *
+     * Searches every position of the suite to the given depth with both
+     * algorithms and prints the node counts, scores and chosen moves,
+     * followed by the totals.
+     *
+     * @param depth Search depth for both algorithms
+     * @return Process exit code (0 on success)
+     */
+    static int comparePvsNodeCounts(int depth);
+
+    /**
+     * @brief Compares a MultiPV search against separate searches per line
+     *
+     * Searches every position of the suite with the given number of lines,
+     * then finds the same lines one search at a time, each from an empty
+     * table and without the moves of the lines before it, and prints the
+     * lines and node counts of both, followed by the totals. Then checks
+     * that asking for more lines than there are legal moves gives one
+     * line per move, and that searches stopped by the node budgets of the
+     * weaker skill levels keep the distinct, sorted lines of their last
+     * completed iteration.
+     *
+     * @param depth Search depth
+     * @param lineCount Number of lines
+     * @return Process exit code (0 if both checks passed)
+     */
+    static int compareMultiPv(int depth, int lineCount);
+
+    /**
+     * @brief Checks the network kernels against the scalar reference code
+     *
+     * Walks every position of the suite a few plies deep with the
+     * accumulator updated incrementally by makeMove()/undoMove(), and
+     * compares each evaluation with one computed from scratch by the
+     * scalar reference path.
+     *
+     * @param weightsPath Weight file to load, or empty for random weights
+     * @return Process exit code (0 if every evaluation matched)
+     */
+    static int verifyNnue(const QString& weightsPath);
+
+    /**
+     * @brief Builds the endgame tables and saves them for the AI
+     *
+     * Builds every table with up to the given number of pieces into the
+     * directory, reusing the tables already there, and prints the time
+     * taken and the longest mate of a few well-known endings.
+     *
+     * @param maxPieces Most pieces, kings included
+     * @param directory Directory to save the tables in (created if missing)
+     * @return Process exit code (0 on success)
+     */
+    static int generateTablebases(int maxPieces, const QString& directory);
+
+    /**
+     * @brief Probes positions in the Syzygy tables and prints the results
+     *
+     * Prints the WDL and DTZ of each position, the root moves that keep
+     * its result and the time taken, which includes mapping the files on
+     * first use. Without a FEN, a few well-known endings are probed, then
+     * random positions of the three-piece endings, and of the four-piece
+     * ones cached in ChessAI::TABLEBASE_DIR, are compared with the endgame
+     * tablebase: the WDL results must match, and the DTZ must agree with
+     * them and not exceed the distance to mate.
+     *
+     * @param path Directories of the tables, separated by QDir::listSeparator()
+     * @param fen Position to probe, or an empty string for the built-in endings
+     * @return Process exit code (0 if every position was covered and, without
+     *         a FEN, at least one ending was checked and none disagreed)
+     */
+    static int probeSyzygy(const QString& path, const QString& fen);
+
+    /**
+     * @brief Checks that the search does not allocate memory
+     *
+     * Searches every position of the suite once to warm up the tables and
+     * buffers, then again while counting heap allocations, and prints the
+     * counts. A self-test first checks that growing a QVector is counted.
+     * Counting wraps malloc (GNU C library only) and replaces the global
+     * operator new and delete, so it is only built with MITTENS_ALLOC_CHECK
+     * defined; otherwise the check reports that it is unsupported.
+     *
+     * @param depth Search depth
+     * @return Process exit code (0 if no search allocated)
+     */
+    static int checkSearchAllocations(int depth);
+};
+
+#endif // BENCH_H
@@ -0,0 +1,253 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <QtGlobal>
+#include <QtAlgorithms>
+
+/**
+ * @file bitboard.h
+ * @brief 64-bit square sets and compile-time attack tables
+ *
+ * Bit n of a Bitboard is square n, indexed row * 8 + col with row 0 the
+ * eighth rank, matching GameState::board and evaltables.h. Colors are
+ * indexed with white as 0. Leaper and pawn attacks are looked up in
+ * tables built at compile time; slider attacks follow each ray up to the
+ * first occupied square.
+ *
+ * @author Group 69 (mittensOS)
+ */
+
+/** @brief Set of squares, one bit per square */
+typedef quint64 Bitboard;
+
+namespace Bitboards {
+
+/** @brief Squares on the a-file (column 0) */
+constexpr Bitboard FILE_A = 0x0101010101010101ULL;
+
+/** @brief Squares on the h-file (column 7) */
+constexpr Bitboard FILE_H = FILE_A << 7;
+
+/**
+ * @brief Ray directions as (row, column) steps
+ *
+ * The first four are orthogonal (rook) directions and the last four
+ * diagonal (bishop) directions. Even directions move towards higher
+ * square indices, odd directions towards lower ones.
+ */
+constexpr int DIRECTIONS[8][2] = {
+    {1, 0}, {-1, 0}, {0, 1}, {0, -1},
+    {1, 1}, {-1, -1}, {1, -1}, {-1, 1}
+};
+
+/**
+ * @brief Attack sets of every piece from every square on an empty board
+ */
+struct AttackTables {
+    /** @brief Knight attacks by square */
+    Bitboard knight[64];
+
+    /** @brief King attacks by square */
+    Bitboard king[64];
+
+    /** @brief Pawn captures by [color][square] */
+    Bitboard pawn[2][64];
+
+    /** @brief Squares along each direction by [direction][square], excluding the square itself */
+    Bitboard rays[8][64];
+};
+
+/**
+ * @brief Gets the square at an offset, or -1 if it is off the board
+ *
+ * @param square Starting square
+ * @param dRow Row offset
+ * @param dCol Column offset
+ * @return The target square, or -1
+ */
+constexpr int offsetSquare(int square, int dRow, int dCol) {
+    return (square / 8 + dRow >= 0 && square / 8 + dRow < 8 && square % 8 + dCol >= 0 && square % 8 + dCol < 8)
+        ? square + dRow * 8 + dCol : -1;
+}
+
+/**
+ * @brief Builds the attack tables
+ *
+ * @return Leaper, pawn and ray attacks for every square
+ */
+constexpr AttackTables buildAttackTables() {
+    const int knightSteps[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
+    const int kingSteps[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+
+    AttackTables tables{};
+    for (int square = 0; square < 64; square++) {
+        for (int i = 0; i < 8; i++) {
+            int target = offsetSquare(square, knightSteps[i][0], knightSteps[i][1]);
+            if (target >= 0) {
+                tables.knight[square] |= 1ULL << target;
+            }
+            target = offsetSquare(square, kingSteps[i][0], kingSteps[i][1]);
+            if (target >= 0) {
+                tables.king[square] |= 1ULL << target;
+            }
+        }
+
+        // White pawns capture towards row 0, black pawns towards row 7
+        for (int dCol = -1; dCol <= 1; dCol += 2) {
+            int target = offsetSquare(square, -1, dCol);
+            if (target >= 0) {
+                tables.pawn[0][square] |= 1ULL << target;
+            }
+            target = offsetSquare(square, 1, dCol);
+            if (target >= 0) {
+                tables.pawn[1][square] |= 1ULL << target;
+            }
+        }
+
+        for (int direction = 0; direction < 8; direction++) {
+            int target = offsetSquare(square, DIRECTIONS[direction][0], DIRECTIONS[direction][1]);
+            while (target >= 0) {
+                tables.rays[direction][square] |= 1ULL << target;
+                target = offsetSquare(target, DIRECTIONS[direction][0], DIRECTIONS[direction][1]);
+            }
+        }
+    }
+    return tables;
+}
+
+/** @brief The attack tables, generated at compile time */
+constexpr AttackTables ATTACK_TABLES = buildAttackTables();
+
+static_assert(ATTACK_TABLES.knight[0] == ((1ULL << 10) | (1ULL << 17)), "knight on a8 attacks c7 and b6");
+static_assert(ATTACK_TABLES.pawn[0][52] == ((1ULL << 43) | (1ULL << 45)), "white pawn on e2 attacks d3 and f3");
+static_assert(ATTACK_TABLES.rays[0][0] == (FILE_A & ~1ULL), "ray from a8 towards rank 1 covers the a-file");
+
+/**
+ * @brief Gets the bit of one square
+ *
+ * @param square Square index
+ * @return Bitboard with only that square set
+ */
+constexpr Bitboard squareBit(int square) {
+    return 1ULL << square;
+}
+
+/**
+ * @brief Counts the squares in a set
+ *
+ * @param bitboard Set of squares
+ * @return Number of squares
+ */
+inline int popCount(Bitboard bitboard) {
+    return static_cast<int>(qPopulationCount(bitboard));
+}
+
+/**
+ * @brief Gets the lowest square in a non-empty set
+ *
+ * @param bitboard Set of squares (must not be empty)
+ * @return Lowest square index
+ */
+inline int lsb(Bitboard bitboard) {
+    return static_cast<int>(qCountTrailingZeroBits(bitboard));
+}
+
+/**
+ * @brief Gets the highest square in a non-empty set
+ *
+ * @param bitboard Set of squares (must not be empty)
+ * @return Highest square index
+ */
+inline int msb(Bitboard bitboard) {
+    return 63 - static_cast<int>(qCountLeadingZeroBits(bitboard));
+}
+
+/**
+ * @brief Removes and returns the lowest square of a non-empty set
+ *
+ * @param bitboard Set of squares (must not be empty); the square is cleared
+ * @return Lowest square index
+ */
+inline int popLsb(Bitboard& bitboard) {
+    int square = lsb(bitboard);
+    bitboard &= bitboard - 1;
+    return square;
+}
+
+/**
+ * @brief Gets the squares attacked by a slider along one direction
+ *
+ * @param square Square of the slider
+ * @param direction Index into DIRECTIONS
+ * @param occupied Occupied squares; the ray stops at the first one
+ * @return Attacked squares, including the first blocker
+ */
+inline Bitboard rayAttacks(int square, int direction, Bitboard occupied) {
+    Bitboard ray = ATTACK_TABLES.rays[direction][square];
+    Bitboard blockers = ray & occupied;
+    if (blockers) {
+        int blocker = (direction % 2 == 0) ? lsb(blockers) : msb(blockers);
+        ray ^= ATTACK_TABLES.rays[direction][blocker];
+    }
+    return ray;
+}
+
+/**
+ * @brief Gets the squares strictly between two squares on a line
+ *
+ * @param from One end of the line
+ * @param to The other end
+ * @return The squares in between, or 0 if the squares don't share a line
+ */
+inline Bitboard between(int from, int to) {
+    for (int direction = 0; direction < 8; direction++) {
+        if (ATTACK_TABLES.rays[direction][from] & squareBit(to)) {
+            return ATTACK_TABLES.rays[direction][from] & ~ATTACK_TABLES.rays[direction][to] & ~squareBit(to);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Gets the squares attacked by a rook
+ *
+ * @param square Square of the rook
+ * @param occupied Occupied squares
+ * @return Attacked squares, including blockers
+ */
+inline Bitboard rookAttacks(int square, Bitboard occupied) {
+    return rayAttacks(square, 0, occupied) | rayAttacks(square, 1, occupied) |
+           rayAttacks(square, 2, occupied) | rayAttacks(square, 3, occupied);
+}
+
+/**
+ * @brief Gets the squares attacked by a bishop
+ *
+ * @param square Square of the bishop
+ * @param occupied Occupied squares
+ * @return Attacked squares, including blockers
+ */
+inline Bitboard bishopAttacks(int square, Bitboard occupied) {
+    return rayAttacks(square, 4, occupied) | rayAttacks(square, 5, occupied) |
+           rayAttacks(square, 6, occupied) | rayAttacks(square, 7, occupied);
+}
+
+/**
+ * @brief Gets the squares attacked by all pawns of one color
+ *
+ * @param color 0 for white, 1 for black
+ * @param pawns Squares of the pawns
+ * @return Squares attacked by at least one of them
+ */
+constexpr Bitboard pawnAttacks(int color, Bitboard pawns) {
+    return (color == 0) ? (((pawns >> 9) & ~FILE_H) | ((pawns >> 7) & ~FILE_A))
+                        : (((pawns << 7) & ~FILE_H) | ((pawns << 9) & ~FILE_A));
+}
+
+static_assert(pawnAttacks(0, squareBit(52)) == ATTACK_TABLES.pawn[0][52] &&
+              pawnAttacks(1, squareBit(8)) == ATTACK_TABLES.pawn[1][8],
+              "set-wise and per-square pawn attacks must agree");
+
+} // namespace Bitboards
+
+#endif // BITBOARD_H
@@ -1,129 +1,118 @@
 #include "chessai.h"
+#include "evaltables.h"
 #include <QRandomGenerator>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QMetaMethod>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <algorithm>
+#include <cmath>
+
+namespace {
+
+/**
+ * @brief Node budget and evaluation noise of a skill level
+ */
+struct SkillSetting {
+    /** @brief Nodes after which a search stops (0: no limit) */
+    qint64 nodeLimit;
+
+    /** @brief Largest evaluation offset in centipawns */
+    int evalNoise;
+};
+
+/** @brief Settings of levels 1 to MAX_SKILL_LEVEL */
+const SkillSetting SKILL_SETTINGS[ChessAI::MAX_SKILL_LEVEL] = {
+    {300, 250},
+    {1000, 180},
+    {3000, 120},
+    {8000, 80},
+    {20000, 50},
+    {50000, 30},
+    {120000, 15},
+    {300000, 8},
+    {800000, 0},
+    {0, 0}
+};
+
+} // namespace
 
 /**
  * @brief Constructor for the ChessAI class
  * 
- * Initializes the AI with piece scores and position tables
- * for various chess pieces.
+ * Initializes the search configuration and the move ordering and
+ * reduction tables. Evaluation tables live in evaltables.h.
  * 
  * @param parent The parent QObject (default: nullptr)
  * @author Group 69 (mittensOS)
  */
-ChessAI::ChessAI(QObject *parent) : QObject(parent) {
-    // Initialize piece scores
-    pieceScore = {
-        {'K', 0},  ///< King value (not used for evaluation, just prevent capture)
-        {'Q', 9},  ///< Queen value
-        {'R', 5},  ///< Rook value
-        {'B', 3},  ///< Bishop value
-        {'N', 3},  ///< Knight value
-        {'p', 1}   ///< Pawn value
-    };
+ChessAI::ChessAI(QObject *parent)
+    : QObject(parent), stopRequested(false), tablebaseBuildStopped(false), abortedRequestId(0),
+      ponderHitRequestId(0), randomGenerator(QRandomGenerator::securelySeeded()) {
+    // Search configuration and statistics
+    searchAlgorithm = PrincipalVariation;
+    upcomingRepetitionCheck = true;
+    useTablebase = true;
+    useSyzygy = false;
+    tablebaseGenerationPieces = 3;
+    nodes = 0;
+    selDepth = 0;
+    ttProbes = 0;
+    ttHits = 0;
+    betaCutoffs = 0;
+    firstMoveCutoffs = 0;
+    tablebaseHits = 0;
+    searchRequestId = 0;
+    multiPv = 1;
+    rootSkipMoves = 0;
+    std::fill(lineScores, lineScores + MAX_MOVES, 0);
+    searchScore = 0;
+    searchAborted = false;
+    pondering = false;
+    ponderRequestId = 0;
+    heldRequestId = 0;
+    searchTimeBudget = 0;
+    rootDepth = 0;
 
-    // Initialize score tables
-    initScoreTables();
-}
-
-/**
- * @brief Initializes position evaluation tables for all chess pieces
- * 
- * Creates tables that assign positional values to each piece type
- * on different squares of the board. Creates separate tables for
- * white and black pieces (black tables are mirror images of white).
- */
-void ChessAI::initScoreTables() {
-    // Knight position scores - knights are more valuable in the center
-    knightScores = {
-        {0.0, 0.1, 0.2, 0.2, 0.2, 0.2, 0.1, 0.0},
-        {0.1, 0.3, 0.5, 0.5, 0.5, 0.5, 0.3, 0.1},
-        {0.2, 0.5, 0.6, 0.65, 0.65, 0.6, 0.5, 0.2},
-        {0.2, 0.55, 0.65, 0.7, 0.7, 0.65, 0.55, 0.2},
-        {0.2, 0.5, 0.65, 0.7, 0.7, 0.65, 0.5, 0.2},
-        {0.2, 0.55, 0.6, 0.65, 0.65, 0.6, 0.55, 0.2},
-        {0.1, 0.3, 0.5, 0.55, 0.55, 0.5, 0.3, 0.1},
-        {0.0, 0.1, 0.2, 0.2, 0.2, 0.2, 0.1, 0.0}
-    };
+    // Full strength, with noise that differs from one AI to the next
+    skill = MAX_SKILL_LEVEL;
+    nodeLimit = 0;
+    evalNoise = 0;
+    noiseSeed = randomGenerator.generate64();
+    nodeLimitReached = false;
+    timeLimitReached = false;
 
-    // Bishop position scores - bishops prefer diagonals and open positions
-    bishopScores = {
-        {0.0, 0.2, 0.2, 0.2, 0.2, 0.2, 0.2, 0.0},
-        {0.2, 0.4, 0.4, 0.4, 0.4, 0.4, 0.4, 0.2},
-        {0.2, 0.4, 0.5, 0.6, 0.6, 0.5, 0.4, 0.2},
-        {0.2, 0.5, 0.5, 0.6, 0.6, 0.5, 0.5, 0.2},
-        {0.2, 0.4, 0.6, 0.6, 0.6, 0.6, 0.4, 0.2},
-        {0.2, 0.6, 0.6, 0.6, 0.6, 0.6, 0.6, 0.2},
-        {0.2, 0.5, 0.4, 0.4, 0.4, 0.4, 0.5, 0.2},
-        {0.0, 0.2, 0.2, 0.2, 0.2, 0.2, 0.2, 0.0}
-    };
+    // Use the neural network if its weights are next to the program
+    useNnue = true;
+    loadNetwork(NNUE_FILE);
 
-    // Rook position scores - rooks prefer open files and 7th rank
-    rookScores = {
-        {0.25, 0.25, 0.25, 0.25, 0.25, 0.25, 0.25, 0.25},
-        {0.5, 0.75, 0.75, 0.75, 0.75, 0.75, 0.75, 0.5},
-        {0.0, 0.25, 0.25, 0.25, 0.25, 0.25, 0.25, 0.0},
-        {0.0, 0.25, 0.25, 0.25, 0.25, 0.25, 0.25, 0.0},
-        {0.0, 0.25, 0.25, 0.25, 0.25, 0.25, 0.25, 0.0},
-        {0.0, 0.25, 0.25, 0.25, 0.25, 0.25, 0.25, 0.0},
-        {0.0, 0.25, 0.25, 0.25, 0.25, 0.25, 0.25, 0.0},
-        {0.25, 0.25, 0.25, 0.5, 0.5, 0.25, 0.25, 0.25}
-    };
+    // Map the endgame tables built by earlier runs; only shutdown stops building more
+    tablebase.setCacheDirectory(TABLEBASE_DIR);
+    tablebase.setCancelFlag(&tablebaseBuildStopped);
+    tablebase.loadCachedTables();
 
-    // Queen position scores - queens are valuable but should not be developed too early
-    queenScores = {
-        {0.0, 0.2, 0.2, 0.3, 0.3, 0.2, 0.2, 0.0},
-        {0.2, 0.4, 0.4, 0.4, 0.4, 0.4, 0.4, 0.2},
-        {0.2, 0.4, 0.5, 0.5, 0.5, 0.5, 0.4, 0.2},
-        {0.3, 0.4, 0.5, 0.5, 0.5, 0.5, 0.4, 0.3},
-        {0.4, 0.4, 0.5, 0.5, 0.5, 0.5, 0.4, 0.3},
-        {0.2, 0.5, 0.5, 0.5, 0.5, 0.5, 0.4, 0.2},
-        {0.2, 0.4, 0.5, 0.4, 0.4, 0.4, 0.4, 0.2},
-        {0.0, 0.2, 0.2, 0.3, 0.3, 0.2, 0.2, 0.0}
-    };
+    // Late move reductions grow with the logarithms of depth and move number
+    for (int depth = 0; depth < MAX_PLY; depth++) {
+        for (int moveNumber = 0; moveNumber < MAX_PLY; moveNumber++) {
+            lmrReductions[depth][moveNumber] = (depth == 0 || moveNumber == 0) ? 0 :
+                static_cast<int>(0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+        }
+    }
 
-    // Pawn position scores - pawns are valuable as they advance
-    pawnScores = {
-        {0.8, 0.8, 0.8, 0.8, 0.8, 0.8, 0.8, 0.8},  ///< About to promote
-        {0.7, 0.7, 0.7, 0.7, 0.7, 0.7, 0.7, 0.7},  ///< Advanced pawns
-        {0.3, 0.3, 0.4, 0.5, 0.5, 0.4, 0.3, 0.3},  ///< Central pawns
-        {0.25, 0.25, 0.3, 0.45, 0.45, 0.3, 0.25, 0.25},
-        {0.2, 0.2, 0.2, 0.4, 0.4, 0.2, 0.2, 0.2},  ///< Center control
-        {0.25, 0.15, 0.1, 0.2, 0.2, 0.1, 0.15, 0.25},
-        {0.25, 0.3, 0.3, 0.0, 0.0, 0.3, 0.3, 0.25},
-        {0.2, 0.2, 0.2, 0.2, 0.2, 0.2, 0.2, 0.2}   ///< Starting position
-    };
+    // Move ordering tables start empty
+    std::fill(&killerMoves[0][0], &killerMoves[0][0] + MAX_PLY * 2, 0);
+    std::fill(&historyScores[0][0][0], &historyScores[0][0][0] + 2 * 64 * 64, 0);
 
-    // Create reversed copies for black pieces (mirror images)
-    QVector<QVector<double>> knightScoresReversed = knightScores;
-    std::reverse(knightScoresReversed.begin(), knightScoresReversed.end());
-
-    QVector<QVector<double>> bishopScoresReversed = bishopScores;
-    std::reverse(bishopScoresReversed.begin(), bishopScoresReversed.end());
-
-    QVector<QVector<double>> rookScoresReversed = rookScores;
-    std::reverse(rookScoresReversed.begin(), rookScoresReversed.end());
-
-    QVector<QVector<double>> queenScoresReversed = queenScores;
-    std::reverse(queenScoresReversed.begin(), queenScoresReversed.end());
-
-    QVector<QVector<double>> pawnScoresReversed = pawnScores;
-    std::reverse(pawnScoresReversed.begin(), pawnScoresReversed.end());
-
-    // Map piece identifiers to their position score tables
-    piecePositionScores = {
-        {"wN", knightScores},
-        {"bN", knightScoresReversed},
-        {"wB", bishopScores},
-        {"bB", bishopScoresReversed},
-        {"wQ", queenScores},
-        {"bQ", queenScoresReversed},
-        {"wR", rookScores},
-        {"bR", rookScoresReversed},
-        {"wp", pawnScores},
-        {"bp", pawnScoresReversed}
-    };
+    // Move lists are allocated once, at full size, and reused by every search
+    for (int ply = 0; ply <= MAX_PLY; ply++) {
+        moveStack[ply].reserve(MAX_MOVES);
+        orderedMoveStack[ply].reserve(MAX_MOVES);
+    }
+    rootMoveBuffer.reserve(MAX_MOVES);
+    moveScores.reserve(MAX_MOVES);
+    positionMoves = position.getValidMoves();
 }
 
 /**
@@ -131,32 +120,47 @@ void ChessAI::initScoreTables() {
  * 
  * Uses the negamax algorithm with alpha-beta pruning to search
  * for the best move. If no strong move is found, falls back to
- * selecting a random move.
+ * selecting a random move. Requests aborted before they start are
+ * skipped, and aborted searches return without emitting a result.
+ * The transposition table and history scores carry over from the
+ * previous search, since the position is the same game a move later.
  * 
- * @param gs The current game state
- * @param validMoves List of valid moves for the current position
- * @return Move The best move found by the AI
+ * @param update Moves played since the last request
+ * @param requestId Identifier of the request, passed back with the result
+ * @return Move The best move found by the AI, or an empty move if the request was aborted
  */
-Move ChessAI::findBestMove(GameState* gs, const QVector<Move>& validMoves) {
+Move ChessAI::findBestMove(const PositionUpdate& update, int requestId) {
+    // Always follow the game, so later updates apply to the right position
+    if (!syncPosition(update)) {
+        qDebug() << "Warning: AI position is out of sync with the game!";
+        return Move();
+    }
+    GameState* gs = &position;
+    const QVector<Move>& validMoves = positionMoves;
+
     // Safety check: if no valid moves, return empty move
     if (validMoves.isEmpty()) {
         qDebug() << "Warning: No valid moves available for AI!";
         return Move();
     }
-    
-    nextMove = Move();  // Initialize with default constructor
 
-    // Shuffle the valid moves for randomness when multiple moves have the same score
-    QVector<Move> shuffledMoves = validMoves;
-    for (int i = shuffledMoves.size() - 1; i > 0; i--) {
-        int j = QRandomGenerator::global()->bounded(i + 1);
-        if (i != j) {
-            std::swap(shuffledMoves[i], shuffledMoves[j]);
-        }
+    // Clear the stop flag, then drop the request if it was aborted while queued.
+    // abortSearch() stores the id before raising the flag, so one of the two is seen.
+    stopRequested.store(false);
+    if (requestId != 0 && requestId <= abortedRequestId.load()) {
+        return Move();
     }
 
-    // Find the best move using negamax with alpha-beta pruning
-    findMoveNegaMaxAlphaBeta(gs, shuffledMoves, DEPTH, -CHECKMATE, CHECKMATE, gs->whiteToMove ? 1 : -1);
+    // Find the best move using the configured search algorithm, with the moves
+    // shuffled for randomness when multiple moves have the same score
+    pondering = false;
+    searchRequestId = requestId;
+    nextMove = searchRootMoves(gs, shuffleMoves(validMoves), MAX_DEPTH, TIME_BUDGET_MS);
+    searchRequestId = 0;
+    if (searchAborted && !nodeLimitReached && !timeLimitReached) {
+        qDebug() << "AI search aborted after" << nodes << "nodes";
+        return Move();
+    }
 
     // If no good move found, use a random move
     if (nextMove.moveID == 0 || !isValidMove(nextMove, validMoves)) {
@@ -165,14 +169,903 @@ Move ChessAI::findBestMove(GameState* gs, const QVector<Move>& validMoves) {
     }
 
     // Debug info
-    qDebug() << "AI selected move: " << nextMove.toString();
+    qDebug() << "AI selected move: " << nextMove.toString() << "nodes:" << nodes
+             << "eval cache hit rate:" << evalCache.hitRate();
 
-    // Emit signal with the found move
-    emit findBestMoveFinished(nextMove);
+    // Emit signal with the found move and the reply to ponder on
+    emit findBestMoveFinished(nextMove, expectedReply(gs, nextMove), requestId);
 
     return nextMove;
 }
 
+/**
+ * @brief Searches the position expected after the opponent's reply
+ *
+ * Runs the same search as findBestMove(), but no iteration is refused
+ * for lack of time until the ponder hit arrives. From then on the time
+ * budget counts from the start of pondering, so a long think by the
+ * opponent lets the move be returned at once. A search that ends on its
+ * own before the hit (a forced mate, or MAX_DEPTH) stores its move and
+ * returns, leaving the thread's event loop free; ponderHit() then has
+ * releaseHeldMove() emit it, unless the request was aborted first.
+ *
+ * @param update Moves played since the last request, ending with the predicted move
+ * @param requestId Identifier of the request, used by ponderHit() and abortSearch()
+ * @return Move The best move found, or an empty move if the request was aborted
+ */
+Move ChessAI::ponder(const PositionUpdate& update, int requestId) {
+    if (!syncPosition(update)) {
+        qDebug() << "Warning: AI position is out of sync with the game!";
+        return Move();
+    }
+    GameState* gs = &position;
+    const QVector<Move>& validMoves = positionMoves;
+
+    if (validMoves.isEmpty()) {
+        return Move();
+    }
+
+    // Same protocol as findBestMove() for requests aborted while queued
+    stopRequested.store(false);
+    if (requestId <= abortedRequestId.load()) {
+        return Move();
+    }
+
+    pondering = true;
+    ponderRequestId = requestId;
+    searchRequestId = requestId;
+    nextMove = searchRootMoves(gs, shuffleMoves(validMoves), MAX_DEPTH, TIME_BUDGET_MS);
+    searchRequestId = 0;
+    bool hit = !waitingForPonderHit();
+    pondering = false;
+    if (stopRequested.load()) {
+        qDebug() << "Ponder search aborted after" << nodes << "nodes";
+        return Move();
+    }
+
+    if (nextMove.moveID == 0 || !isValidMove(nextMove, validMoves)) {
+        qDebug() << "Using random move as fallback";
+        nextMove = findRandomMove(validMoves);
+    }
+
+    // Only a hit makes the move worth sending; until then, hold it and free the thread
+    if (!hit) {
+        heldMove = nextMove;
+        heldReply = expectedReply(gs, nextMove);
+        heldRequestId = requestId;
+        qDebug() << "Ponder search finished before the hit, holding" << nextMove.toString();
+        return nextMove;
+    }
+
+    qDebug() << "AI selected move after ponder hit: " << nextMove.toString() << "nodes:" << nodes
+             << "time:" << searchTimer.elapsed() << "ms";
+
+    emit findBestMoveFinished(nextMove, expectedReply(gs, nextMove), requestId);
+
+    return nextMove;
+}
+
+/**
+ * @brief Finds the best few moves of the current game state
+ *
+ * Runs a MultiPV search with the usual time budget and returns its
+ * lines, best first, without shuffling the root moves. As with
+ * findBestMove(), aborted requests return nothing and emit nothing.
+ *
+ * @param update Moves played since the last request
+ * @param lineCount Number of lines wanted
+ * @param requestId Identifier of the request, passed back with the result
+ * @return QVector<AnalysisLine> The lines, or an empty list if the request was aborted
+ */
+QVector<AnalysisLine> ChessAI::analyze(const PositionUpdate& update, int lineCount, int requestId) {
+    if (!syncPosition(update)) {
+        qDebug() << "Warning: AI position is out of sync with the game!";
+        return QVector<AnalysisLine>();
+    }
+
+    // Same protocol as findBestMove() for requests aborted while queued
+    stopRequested.store(false);
+    if (positionMoves.isEmpty() || (requestId != 0 && requestId <= abortedRequestId.load())) {
+        return QVector<AnalysisLine>();
+    }
+
+    int savedMultiPv = multiPv;
+    multiPv = qMax(lineCount, 1);
+    pondering = false;
+    searchRequestId = requestId;
+    searchRootMoves(&position, positionMoves, MAX_DEPTH, TIME_BUDGET_MS);
+    searchRequestId = 0;
+    multiPv = savedMultiPv;
+    if (searchAborted && !nodeLimitReached && !timeLimitReached) {
+        return QVector<AnalysisLine>();
+    }
+
+    // A single line is the normal search, which records no lines
+    if (analysisLines.isEmpty()) {
+        recordAnalysisLines(&position, 1, searchAborted ? rootDepth - 1 : rootDepth);
+    }
+
+    emit analysisFinished(analysisLines, requestId);
+    return analysisLines;
+}
+
+/**
+ * @brief Searches the root moves in the given order and returns the best one
+ *
+ * Plain alpha-beta runs a single full-window search to maxDepth.
+ * Principal variation search deepens one ply at a time; from the second
+ * iteration on, the root window is centred on the previous score and
+ * widened (doubling each time) whenever the result falls outside it.
+ * The best move of each iteration is searched first in the next.
+ * With a time budget, iterations beyond DEPTH are only started while
+ * less than half of it has been used, and one that is still running
+ * when the budget is used up is stopped; a ponder search ignores the
+ * budget until its ponder hit. A node budget works the same way, from
+ * the second iteration on. When the stop flag is raised or a budget
+ * runs out, the unfinished iteration is thrown away.
+ * With multiPv above 1, each iteration searches the root once per line,
+ * skipping the moves of the lines already found, and records the lines;
+ * a line whose search finds no move ends the lines there.
+ * The root moves are copied into rootMoveBuffer, and the game state's
+ * logs are grown beforehand, so nothing is allocated during the search.
+ * With useSyzygy, in an ending the Syzygy tables cover, only the root
+ * moves that keep the tables' result are copied.
+ *
+ * @param gs The game state to search (restored before returning)
+ * @param rootMoves Legal moves of the position, in search order
+ * @param maxDepth Depth of the final iteration
+ * @param timeBudgetMs Time budget in milliseconds for iterations beyond DEPTH (0: no limit)
+ * @return Move The best move found, or an empty move if none raised alpha.
+ *         If the search is stopped, the best move of the last completed iteration.
+ */
+Move ChessAI::searchRootMoves(GameState* gs, const QVector<Move>& rootMoves, int maxDepth, qint64 timeBudgetMs) {
+    // Copy element by element so the buffer keeps its own storage
+    rootMoveBuffer.resize(0);
+    for (const Move& move : rootMoves) {
+        rootMoveBuffer.push_back(move);
+    }
+    gs->reserveHistory(MAX_PLY + 1 + SyzygyTablebase::PROBE_DEPTH);
+
+    // Larger endings: only search the moves that keep the Syzygy result, unless the tablebase has the exact one
+    int rootWdl = 0;
+    int rootDtm = 0;
+    if (useTablebase && useSyzygy && !tablebase.probe(*gs, rootWdl, rootDtm)) {
+        syzygy.filterRootMoves(*gs, rootMoveBuffer);
+    }
+    searchTimer.start();
+    searchTimeBudget = timeBudgetMs;
+
+    nodes = 0;
+    selDepth = 0;
+    ttProbes = 0;
+    ttHits = 0;
+    betaCutoffs = 0;
+    firstMoveCutoffs = 0;
+    tablebaseHits = 0;
+    searchAborted = false;
+    nodeLimitReached = false;
+    timeLimitReached = false;
+    evalCache.resetStatistics();
+    gs->setNetwork(nnueActive() ? &network : nullptr);
+    nextMove = Move();
+    int turnMultiplier = gs->whiteToMove ? 1 : -1;
+
+    // Forget old killers and age the history so recent cutoffs dominate
+    std::fill(&killerMoves[0][0], &killerMoves[0][0] + MAX_PLY * 2, 0);
+    for (int side = 0; side < 2; side++) {
+        for (int from = 0; from < 64; from++) {
+            for (int to = 0; to < 64; to++) {
+                historyScores[side][from][to] /= 2;
+            }
+        }
+    }
+
+    // Plain alpha-beta: one full-window search to the final depth
+    if (searchAlgorithm == AlphaBeta) {
+        rootDepth = maxDepth;
+        searchScore = findMoveNegaMaxAlphaBeta(gs, rootMoveBuffer, maxDepth, 0,
+                                               -CHECKMATE, CHECKMATE, turnMultiplier);
+        if (searchAborted) {
+            return Move();
+        }
+        reportIteration(gs, maxDepth, searchScore, 0);
+        return nextMove;
+    }
+
+    // Several lines: each one searches the root moves the earlier lines didn't take
+    int lineCount = qBound(1, multiPv, rootMoveBuffer.size());
+    analysisLines.clear();
+
+    Move completedMove;
+    qint64 previousIterationNodes = 0;
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        // Don't start an iteration that is unlikely to finish in time or within the node budget
+        if (timeBudgetMs > 0 && depth > DEPTH && !waitingForPonderHit() &&
+            searchTimer.elapsed() > timeBudgetMs / 2) {
+            break;
+        }
+        if (nodeLimit > 0 && depth > 1 && nodes > nodeLimit / 2) {
+            break;
+        }
+        rootDepth = depth;
+        qint64 iterationStartNodes = nodes;
+
+        for (int line = 0; line < lineCount && !searchAborted; line++) {
+            // The moves of the earlier lines stand before this one and are skipped
+            rootSkipMoves = line;
+            nextMove = Move();
+
+            int delta = ASPIRATION_WINDOW;
+            int alpha = -CHECKMATE;
+            int beta = CHECKMATE;
+            int score = 0;
+
+            // Centre the window on the line's score in the previous iteration
+            if (depth > 1) {
+                alpha = qMax(lineScores[line] - delta, -CHECKMATE);
+                beta = qMin(lineScores[line] + delta, CHECKMATE);
+            }
+
+            while (true) {
+                score = findMoveNegaMaxAlphaBeta(gs, rootMoveBuffer, depth, 0, alpha, beta, turnMultiplier);
+                if (searchAborted) {
+                    break;
+                }
+
+                if (score <= alpha && alpha > -CHECKMATE) {
+                    // Fail low: the position is worse than expected
+                    alpha = qMax(score - delta, -CHECKMATE);
+                } else if (score >= beta && beta < CHECKMATE) {
+                    // Fail high: the position is better than expected
+                    beta = qMin(score + delta, CHECKMATE);
+                } else {
+                    break;
+                }
+                delta *= 2;
+            }
+            if (searchAborted) {
+                break;
+            }
+
+            // A line without a move of its own has nothing to show, and neither have the later ones
+            int bestIndex = rootMoveBuffer.indexOf(nextMove);
+            if (bestIndex < line) {
+                lineCount = line;
+                break;
+            }
+
+            // Search the line's move first in the next iteration, after the earlier lines
+            lineScores[line] = score;
+            if (bestIndex > line) {
+                rootMoveBuffer.move(bestIndex, line);
+            }
+        }
+        rootSkipMoves = 0;
+
+        // A stopped iteration may not have looked at the best move yet
+        if (searchAborted || lineCount == 0) {
+            nextMove = completedMove;
+            break;
+        }
+
+        // A later line can come out better than an earlier one, so sort them
+        for (int i = 1; i < lineCount; i++) {
+            for (int j = i; j > 0 && lineScores[j - 1] < lineScores[j]; j--) {
+                std::swap(lineScores[j - 1], lineScores[j]);
+                std::swap(rootMoveBuffer[j - 1], rootMoveBuffer[j]);
+            }
+        }
+        nextMove = rootMoveBuffer[0];
+        searchScore = lineScores[0];
+        completedMove = nextMove;
+        if (multiPv > 1) {
+            recordAnalysisLines(gs, lineCount, depth);
+        }
+
+        qint64 iterationNodes = nodes - iterationStartNodes;
+        reportIteration(gs, depth, searchScore,
+                        (previousIterationNodes > 0) ? double(iterationNodes) / previousIterationNodes : 0);
+        previousIterationNodes = iterationNodes;
+
+        // Forced mates in every line won't change with more depth
+        if (qAbs(lineScores[lineCount - 1]) >= MATE_BOUND) {
+            break;
+        }
+    }
+
+    return nextMove;
+}
+
+/**
+ * @brief Builds the endgame tables that are small enough to build during a game
+ *
+ * Tables already in TABLEBASE_DIR are only mapped. Searches aborted
+ * meanwhile (a reset, an undo) don't affect it; stopTablebaseBuild()
+ * stops it, and the tables not finished by then are not used.
+ */
+void ChessAI::prepareTablebases() {
+    if (!useTablebase) {
+        return;
+    }
+    int tables = tablebase.generateAll(qMin(tablebaseGenerationPieces, EndgameTablebase::MAX_PIECES));
+    qDebug() << "Endgame tables available:" << tables;
+}
+
+/**
+ * @brief Cancels the building of endgame tables, for shutdown
+ */
+void ChessAI::stopTablebaseBuild() {
+    tablebaseBuildStopped.store(true);
+}
+
+/**
+ * @brief Stops the search for a request and drops every earlier request
+ *
+ * The request id is published before the stop flag, which is what
+ * findBestMove() relies on when it clears the flag for a new request.
+ *
+ * @param requestId The newest request to abort
+ */
+void ChessAI::abortSearch(int requestId) {
+    int previous = abortedRequestId.load();
+    while (previous < requestId && !abortedRequestId.compare_exchange_weak(previous, requestId)) {
+    }
+    stopRequested.store(true);
+}
+
+/**
+ * @brief Tells a ponder search that its predicted move was played
+ *
+ * @param requestId Identifier passed to ponder()
+ */
+void ChessAI::ponderHit(int requestId) {
+    int previous = ponderHitRequestId.load();
+    while (previous < requestId && !ponderHitRequestId.compare_exchange_weak(previous, requestId)) {
+    }
+
+    // A ponder search that already finished is holding its move; send it from the AI's thread
+    QMetaObject::invokeMethod(this, [this, requestId]() { releaseHeldMove(requestId); }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Emits the move of a ponder search that finished before its ponder hit
+ *
+ * Runs on the AI's thread, queued by ponderHit(). Does nothing if no
+ * move is held for the request (the search is still running, or has
+ * already emitted) or if the request was aborted in the meantime.
+ *
+ * @param requestId Identifier passed to ponder()
+ */
+void ChessAI::releaseHeldMove(int requestId) {
+    if (heldRequestId == 0 || heldRequestId != requestId) {
+        return;
+    }
+    heldRequestId = 0;
+    if (requestId <= abortedRequestId.load()) {
+        return;
+    }
+
+    qDebug() << "AI selected move after ponder hit: " << heldMove.toString();
+    emit findBestMoveFinished(heldMove, heldReply, requestId);
+}
+
+/**
+ * @brief Checks whether a ponder search is still waiting for its predicted move
+ *
+ * @return bool True while pondering and ponderHit() has not been called for the request
+ */
+bool ChessAI::waitingForPonderHit() const {
+    return pondering && ponderHitRequestId.load(std::memory_order_relaxed) < ponderRequestId;
+}
+
+/**
+ * @brief Checks the stop flag every STOP_CHECK_INTERVAL nodes
+ *
+ * @return bool True if the search must stop
+ */
+bool ChessAI::checkStop() {
+    if (searchAborted || (nodes & (STOP_CHECK_INTERVAL - 1)) != 0) {
+        return searchAborted;
+    }
+
+    if (stopRequested.load(std::memory_order_relaxed)) {
+        searchAborted = true;
+    } else if (searchTimeBudget > 0 && searchAlgorithm == PrincipalVariation && rootDepth > DEPTH &&
+               !waitingForPonderHit() && searchTimer.elapsed() >= searchTimeBudget) {
+        // Out of time; a ponder search counts from when pondering began, so a long think
+        // by the opponent covers this move's budget
+        timeLimitReached = true;
+        searchAborted = true;
+    } else if (nodeLimit > 0 && searchAlgorithm == PrincipalVariation && rootDepth > 1 && nodes >= nodeLimit) {
+        // Out of nodes for this skill level; the first iteration always completes
+        nodeLimitReached = true;
+        searchAborted = true;
+    }
+    return searchAborted;
+}
+
+/**
+ * @brief Brings the AI's position up to date with the game
+ *
+ * @param update Moves played since the last request
+ * @return bool True if every new move was legal in the AI's position
+ */
+bool ChessAI::syncPosition(const PositionUpdate& update) {
+    // A move held back by ponder() belongs to the position before this request
+    heldRequestId = 0;
+
+    // Take back the moves the game no longer has
+    while (position.moveLog.size() > qMax(update.keptMoves, 0)) {
+        position.undoMove();
+    }
+
+    // Play the new moves, matching each moveID against the legal moves
+    for (int moveId : update.moveIds) {
+        position.getValidMoves(positionMoves);
+        bool found = false;
+        for (const Move& move : positionMoves) {
+            if (move.moveID == moveId) {
+                position.makeMove(move);
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            position.getValidMoves(positionMoves);
+            return false;
+        }
+    }
+
+    position.getValidMoves(positionMoves);
+    return true;
+}
+
+/**
+ * @brief Shuffles moves so that equal scores don't always pick the same one
+ *
+ * @param moves Moves to shuffle
+ * @return QVector<Move> The moves in random order
+ */
+QVector<Move> ChessAI::shuffleMoves(const QVector<Move>& moves) {
+    QVector<Move> shuffledMoves = moves;
+    for (int i = shuffledMoves.size() - 1; i > 0; i--) {
+        int j = randomGenerator.bounded(i + 1);
+        if (i != j) {
+            std::swap(shuffledMoves[i], shuffledMoves[j]);
+        }
+    }
+    return shuffledMoves;
+}
+
+/**
+ * @brief Gets the opponent's expected reply to a move
+ *
+ * @param gs Game state the move is played in (restored before returning)
+ * @param move Move to find the reply to
+ * @return Move The expected reply, or an empty move if none is known
+ */
+Move ChessAI::expectedReply(GameState* gs, const Move& move) {
+    Move reply;
+    if (move.moveID == 0) {
+        return reply;
+    }
+
+    gs->makeMove(move);
+    QVector<Move>& replies = moveStack[1];
+    gs->getValidMoves(replies);
+    const TTEntry* entry = transpositionTable.probe(gs->zobristKey);
+    if (entry && entry->bestMove != 0) {
+        for (const Move& candidate : replies) {
+            if (candidate.moveID == entry->bestMove) {
+                reply = candidate;
+                break;
+            }
+        }
+    }
+    gs->undoMove();
+    return reply;
+}
+
+/**
+ * @brief Reports a completed iteration
+ *
+ * @param gs Game state at the root
+ * @param depth Depth of the iteration
+ * @param score Score of the iteration
+ * @param branchingFactor Nodes of the iteration divided by nodes of the previous one
+ */
+void ChessAI::reportIteration(GameState* gs, int depth, int score, double branchingFactor) {
+    static const QMetaMethod infoSignal = QMetaMethod::fromSignal(&ChessAI::searchInfoReady);
+    if (!searchLog.isOpen() && !isSignalConnected(infoSignal)) {
+        return;
+    }
+
+    SearchInfo info;
+    info.requestId = searchRequestId;
+    info.pondering = pondering;
+    info.depth = depth;
+    info.selDepth = qMax(selDepth, depth);
+    info.nodes = nodes;
+    info.timeMs = searchTimer.elapsed();
+    info.nps = nodes * 1000 / qMax<qint64>(info.timeMs, 1);
+    info.score = score;
+    info.pv = principalVariation(gs, nextMove, depth);
+    info.ttHitRate = (ttProbes > 0) ? double(ttHits) / ttProbes : 0;
+    info.firstMoveCutoffRate = (betaCutoffs > 0) ? double(firstMoveCutoffs) / betaCutoffs : 0;
+    info.branchingFactor = branchingFactor;
+    info.tbHits = tablebaseHits;
+
+    emit searchInfoReady(info);
+    if (searchLog.isOpen()) {
+        writeSearchLog(info);
+    }
+}
+
+/**
+ * @brief Reads the principal variation from the transposition table
+ *
+ * @param gs Game state at the root (restored before returning)
+ * @param firstMove Root move the variation starts with
+ * @param maxLength Greatest number of moves to return
+ * @return QVector<Move> The principal variation
+ */
+QVector<Move> ChessAI::principalVariation(GameState* gs, const Move& firstMove, int maxLength) {
+    QVector<Move> pv;
+    if (firstMove.moveID == 0) {
+        return pv;
+    }
+    pv.append(firstMove);
+    gs->makeMove(firstMove);
+
+    QVector<Move> moves;
+    while (pv.size() < maxLength && !gs->isRepetition()) {
+        const TTEntry* entry = transpositionTable.probe(gs->zobristKey);
+        if (!entry || entry->bestMove == 0) {
+            break;
+        }
+        gs->getValidMoves(moves);
+        int index = 0;
+        while (index < moves.size() && moves[index].moveID != entry->bestMove) {
+            index++;
+        }
+        if (index == moves.size()) {
+            break;
+        }
+        pv.append(moves[index]);
+        gs->makeMove(moves[index]);
+    }
+
+    for (int i = 0; i < pv.size(); i++) {
+        gs->undoMove();
+    }
+    return pv;
+}
+
+/**
+ * @brief Records the lines of a completed MultiPV iteration
+ *
+ * @param gs Game state at the root (restored before returning)
+ * @param lineCount Number of lines; their moves lead rootMoveBuffer, best first
+ * @param depth Depth of the iteration, the greatest length of each variation
+ */
+void ChessAI::recordAnalysisLines(GameState* gs, int lineCount, int depth) {
+    analysisLines.clear();
+    for (int line = 0; line < lineCount; line++) {
+        AnalysisLine analysisLine;
+        analysisLine.move = rootMoveBuffer[line];
+        analysisLine.score = lineScores[line];
+        analysisLine.depth = depth;
+        analysisLine.pv = principalVariation(gs, analysisLine.move, depth);
+        analysisLines.append(analysisLine);
+    }
+}
+
+/**
+ * @brief Gets the lines of the last MultiPV search
+ *
+ * @return const QVector<AnalysisLine>& The lines, best first
+ */
+const QVector<AnalysisLine>& ChessAI::lastAnalysisLines() const {
+    return analysisLines;
+}
+
+/**
+ * @brief Appends a report to the search log as one line of JSON
+ *
+ * @param info The report to write
+ */
+void ChessAI::writeSearchLog(const SearchInfo& info) {
+    QJsonArray pv;
+    for (const Move& move : info.pv) {
+        pv.append(move.getRankFile(move.startRow, move.startCol) + move.getRankFile(move.endRow, move.endCol));
+    }
+
+    QJsonObject line;
+    line.insert("requestId", info.requestId);
+    line.insert("pondering", info.pondering);
+    line.insert("depth", info.depth);
+    line.insert("seldepth", info.selDepth);
+    line.insert("nodes", info.nodes);
+    line.insert("nps", info.nps);
+    line.insert("timeMs", info.timeMs);
+    line.insert("score", info.score);
+    line.insert("pv", pv);
+    line.insert("ttHitRate", info.ttHitRate);
+    line.insert("firstMoveCutoffRate", info.firstMoveCutoffRate);
+    line.insert("branchingFactor", info.branchingFactor);
+    line.insert("tbHits", info.tbHits);
+
+    searchLog.write(QJsonDocument(line).toJson(QJsonDocument::Compact));
+    searchLog.write("\n", 1);
+    searchLog.flush();
+}
+
+/**
+ * @brief Starts or stops the JSON lines search log
+ *
+ * @param path File to append to, or an empty string to stop logging
+ * @return bool True if logging is off or the file could be opened
+ */
+bool ChessAI::setSearchLogFile(const QString& path) {
+    if (searchLog.isOpen()) {
+        searchLog.close();
+    }
+    if (path.isEmpty()) {
+        return true;
+    }
+    searchLog.setFileName(path);
+    return searchLog.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+}
+
+/**
+ * @brief Gets the number of nodes visited by the last search
+ *
+ * @return qint64 Count of moves made inside the search tree
+ */
+qint64 ChessAI::nodeCount() const {
+    return nodes;
+}
+
+/**
+ * @brief Gets the score of the last completed search
+ *
+ * @return int Score from the perspective of the side to move at the root
+ */
+int ChessAI::lastScore() const {
+    return searchScore;
+}
+
+/**
+ * @brief Gets the evaluation cache hit rate of the last search
+ *
+ * @return double Fraction of cache probes that hit, between 0 and 1
+ */
+double ChessAI::evalCacheHitRate() const {
+    return evalCache.hitRate();
+}
+
+/**
+ * @brief Gets the current skill level
+ *
+ * @return int Level from 1 to MAX_SKILL_LEVEL
+ */
+int ChessAI::skillLevel() const {
+    return skill;
+}
+
+/**
+ * @brief Sets how strongly the AI plays
+ *
+ * The transposition table holds scores computed with the old noise,
+ * so it is cleared when the level changes.
+ *
+ * @param level Level from 1 (weakest) to MAX_SKILL_LEVEL (full strength)
+ */
+void ChessAI::setSkillLevel(int level) {
+    level = qBound(1, level, MAX_SKILL_LEVEL);
+    if (level == skill) {
+        return;
+    }
+    skill = level;
+    nodeLimit = SKILL_SETTINGS[level - 1].nodeLimit;
+    evalNoise = SKILL_SETTINGS[level - 1].evalNoise;
+    clearTranspositionTable();
+}
+
+/**
+ * @brief Makes every random choice of the AI reproducible
+ *
+ * The noise seed is drawn from the generator, so it follows the seed too.
+ *
+ * @param seed Seed of the generator
+ */
+void ChessAI::setRandomSeed(quint32 seed) {
+    randomGenerator.seed(seed);
+    noiseSeed = randomGenerator.generate64();
+    clearTranspositionTable();
+}
+
+/**
+ * @brief Sets the directories of the Syzygy tables
+ *
+ * @param path Directories separated by QDir::listSeparator(), or an empty string for none
+ * @return int Number of tables found
+ */
+int ChessAI::setSyzygyPath(const QString& path) {
+    return syzygy.setPath(path);
+}
+
+/**
+ * @brief Limits Syzygy probing to positions with few pieces
+ *
+ * @param pieces Most pieces, kings included
+ */
+void ChessAI::setSyzygyMaxPieces(int pieces) {
+    syzygy.setMaxPieces(pieces);
+}
+
+/**
+ * @brief Gets the evaluation offset of a position
+ *
+ * Mixes the hash with the seed through the SplitMix64 finaliser, so that
+ * neighbouring positions get unrelated offsets.
+ *
+ * @param key Zobrist hash of the position
+ * @return int Offset between -evalNoise and evalNoise
+ */
+int ChessAI::noiseFor(quint64 key) const {
+    quint64 z = key ^ noiseSeed;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return static_cast<int>(z % quint64(2 * evalNoise + 1)) - evalNoise;
+}
+
+/**
+ * @brief Converts a tablebase result to a search score
+ *
+ * @param wdl 1 if the side to move wins, 0 for a draw, -1 if it loses
+ * @param dtm Plies to mate from the position
+ * @param ply Distance of the position from the root
+ * @return int Score from the side to move's perspective
+ */
+int ChessAI::tablebaseScore(int wdl, int dtm, int ply) {
+    if (wdl == 0) {
+        return DRAW;
+    }
+    int score = (ply + dtm < MAX_PLY) ? CHECKMATE - (ply + dtm) : MAX_EVAL - dtm;
+    return (wdl > 0) ? score : -score;
+}
+
+/**
+ * @brief Converts a Syzygy result to a search score
+ *
+ * @param wdl SyzygyTablebase::WdlScore for the side to move
+ * @return int Score from the side to move's perspective
+ */
+int ChessAI::syzygyScore(int wdl) {
+    if (wdl == SyzygyTablebase::Win) {
+        return SYZYGY_WIN;
+    }
+    if (wdl == SyzygyTablebase::Loss) {
+        return -SYZYGY_WIN;
+    }
+    return DRAW;
+}
+
+/**
+ * @brief Forgets all stored search results
+ */
+void ChessAI::clearTranspositionTable() {
+    transpositionTable.clear();
+}
+
+/**
+ * @brief Forgets stored search results and move ordering statistics
+ */
+void ChessAI::resetSearchState() {
+    clearTranspositionTable();
+    std::fill(&killerMoves[0][0], &killerMoves[0][0] + MAX_PLY * 2, 0);
+    std::fill(&historyScores[0][0][0], &historyScores[0][0][0] + 2 * 64 * 64, 0);
+}
+
+/**
+ * @brief Converts a search score for storage in the transposition table
+ *
+ * @param score Score from the search
+ * @param ply Distance of the position from the root
+ * @return int Mate scores counted from the position, other scores unchanged
+ */
+int ChessAI::scoreToTT(int score, int ply) {
+    if (score >= MATE_BOUND) {
+        return score + ply;
+    }
+    if (score <= -MATE_BOUND) {
+        return score - ply;
+    }
+    return score;
+}
+
+/**
+ * @brief Converts a stored score back to a search score
+ *
+ * @param score Score from the transposition table
+ * @param ply Distance of the position from the root
+ * @return int Mate scores counted from the root, other scores unchanged
+ */
+int ChessAI::scoreFromTT(int score, int ply) {
+    if (score >= MATE_BOUND) {
+        return score - ply;
+    }
+    if (score <= -MATE_BOUND) {
+        return score + ply;
+    }
+    return score;
+}
+
+/**
+ * @brief Loads neural network weights and switches to the network evaluation
+ *
+ * @param path Path of the weight file
+ * @return bool True if the weights were loaded
+ */
+bool ChessAI::loadNetwork(const QString& path) {
+    if (!network.load(path)) {
+        return false;
+    }
+    evalCache.clear();
+    return true;
+}
+
+/**
+ * @brief Chooses between the network and the hand-written evaluation
+ *
+ * @param enabled True to use the network when available
+ */
+void ChessAI::setUseNnue(bool enabled) {
+    if (enabled != useNnue) {
+        useNnue = enabled;
+        evalCache.clear();
+    }
+}
+
+/**
+ * @brief Checks whether searches evaluate with the network
+ *
+ * @return bool True if weights are loaded and the network is enabled
+ */
+bool ChessAI::nnueActive() const {
+    return useNnue && network.isLoaded();
+}
+
+/**
+ * @brief Sets one of the search parameters by name
+ *
+ * @param name Name of a SearchParameters field
+ * @param value New value
+ * @return bool True if the parameter exists, false otherwise
+ */
+bool ChessAI::setSearchParameter(const QString& name, int value) {
+    QMap<QString, int*> parameters = {
+        {"futilityMarginFrontier", &searchParameters.futilityMarginFrontier},
+        {"futilityMarginPreFrontier", &searchParameters.futilityMarginPreFrontier},
+        {"reverseFutilityMargin", &searchParameters.reverseFutilityMargin},
+        {"reverseFutilityMaxDepth", &searchParameters.reverseFutilityMaxDepth},
+        {"razorMargin", &searchParameters.razorMargin},
+        {"razorMarginPerDepth", &searchParameters.razorMarginPerDepth},
+        {"razorMaxDepth", &searchParameters.razorMaxDepth},
+        {"deltaMargin", &searchParameters.deltaMargin},
+        {"seeCaptureMargin", &searchParameters.seeCaptureMargin},
+        {"seePruneMaxDepth", &searchParameters.seePruneMaxDepth}
+    };
+
+    if (!parameters.contains(name)) {
+        return false;
+    }
+    *parameters[name] = value;
+    return true;
+}
+
 /**
  * @brief Validates if a move is in the list of valid moves
  * 
@@ -198,72 +1091,605 @@ bool ChessAI::isValidMove(const Move& move, const QVector<Move>& validMoves) {
  * Recursively evaluates positions by simulating moves and calculating
  * the best possible outcome assuming optimal play by both sides.
  * Alpha-beta pruning optimizes the search by skipping branches that
- * won't affect the final decision.
+ * won't affect the final decision. Under principal variation search,
+ * moves after the first are searched with a null window around alpha
+ * and only re-searched with the full window if they beat it.
+ * 
+ * Null-move pruning first lets the opponent move twice in a row. If a
+ * search reduced by R plies (2, or 3 deep in the tree) still fails high,
+ * the node is cut off. It is skipped in check, right after another null
+ * move, and when the side to move has only pawns and its king, where
+ * zugzwang makes passing unsound. Deep cutoffs are verified by a reduced
+ * search that does not use null moves at this node.
+ * 
+ * Moves are then searched in the order given by orderMoves(). Late quiet
+ * moves that neither escape nor give check are searched at a depth reduced
+ * by lmrReductions and re-searched at full depth if they beat alpha
+ * (late move reductions). Near the leaves of non-PV nodes, quiet moves past
+ * a move-count limit are not searched at all (late move pruning), and
+ * neither are captures whose static exchange loses more than
+ * seeCaptureMargin per ply of remaining depth.
+ * 
+ * Close to the leaves of non-PV nodes that are not in check, the static
+ * evaluation is compared with the window using the margins in
+ * searchParameters:
+ * - Reverse futility: far enough above beta, the node fails high at once.
+ * - Razoring: far below alpha, the node drops into quiescence search and
+ *   returns if that confirms the fail low.
+ * - Futility: below alpha by more than the frontier (depth 1) or
+ *   pre-frontier (depth 2) margin, quiet moves that don't give check
+ *   are skipped.
+ * At depth 0 the principal variation search calls quiescenceSearch().
+ * 
+ * Below the root, a position that repeats an earlier one since the last
+ * irreversible move, or whose halfmove clock reached 100, is a draw. If
+ * the side to move could repeat a position of this search with its next
+ * move, alpha is raised to the draw score first (upcomingRepetitionCheck).
+ * 
+ * Being mated scores -(CHECKMATE - ply). Mate-distance pruning narrows the
+ * window to the scores still possible at this ply: no line can mate faster
+ * than the next move or be mated sooner than now. The principal variation
+ * search also probes the transposition table: at non-PV nodes a stored
+ * result searched at least as deep cuts the node off if its bound allows,
+ * and otherwise the stored move is searched first. Every completed node
+ * stores its score, bound and best move, with mate scores made relative
+ * to the node by scoreToTT().
  * 
  * @param gs Current game state
  * @param validMoves List of valid moves to consider
- * @param depth Current search depth
+ * @param depth Remaining search depth
+ * @param ply Distance from the root (0 at the root)
  * @param alpha Alpha value for pruning
  * @param beta Beta value for pruning
  * @param turnMultiplier 1 for white, -1 for black (for score negation)
+ * @param allowNullMove False right after a null move, so two are never made in a row
  * @return int Score of the best move found
  */
 int ChessAI::findMoveNegaMaxAlphaBeta(GameState* gs, const QVector<Move>& validMoves,
-                                     int depth, int alpha, int beta, int turnMultiplier) {
-    // Base case: reached maximum depth
-    if (depth == 0) {
-        return turnMultiplier * scoreBoard(gs);
+                                     int depth, int ply, int alpha, int beta, int turnMultiplier,
+                                     bool allowNullMove) {
+    // Unwind at once when the search has been stopped
+    if (checkStop()) {
+        return 0;
+    }
+    selDepth = qMax(selDepth, ply);
+
+    // Base case: no moves left, so mated (the sooner the worse) or stalemate
+    if (validMoves.isEmpty()) {
+        return gs->checkmate ? -(CHECKMATE - ply) : STALEMATE;
+    }
+
+    bool enhancedSearch = (searchAlgorithm == PrincipalVariation);
+
+    if (ply > 0) {
+        // Draw by the fifty-move rule, or by returning to an earlier position
+        if (gs->halfmoveClock >= 100 || gs->isRepetition()) {
+            return DRAW;
+        }
+
+        // The side to move can repeat a position of this search, so it can at least draw
+        if (upcomingRepetitionCheck && alpha < DRAW && gs->hasUpcomingRepetition(ply)) {
+            alpha = DRAW;
+            if (alpha >= beta) {
+                return alpha;
+            }
+        }
+    }
+
+    // Mate-distance pruning: a shorter mate has already been found elsewhere
+    if (ply > 0) {
+        alpha = qMax(alpha, -(CHECKMATE - ply));
+        beta = qMin(beta, CHECKMATE - ply - 1);
+        if (alpha >= beta) {
+            return alpha;
+        }
+    }
+
+    // Small endings: the tablebase knows the exact result, whatever the depth
+    int tablebaseWdl = 0;
+    int tablebaseDtm = 0;
+    if (ply > 0 && useTablebase && tablebase.probe(*gs, tablebaseWdl, tablebaseDtm)) {
+        tablebaseHits++;
+        return tablebaseScore(tablebaseWdl, tablebaseDtm, ply);
+    }
+
+    // Larger endings: the Syzygy tables hold the result wherever the fifty-move counter was just reset
+    int syzygyWdl = 0;
+    if (ply > 0 && useTablebase && useSyzygy && gs->halfmoveClock == 0 &&
+        syzygy.probeWdl(*gs, validMoves, syzygyWdl)) {
+        tablebaseHits++;
+        return syzygyScore(syzygyWdl);
+    }
+
+    // Base case: reached maximum depth, so settle any captures first
+    if (depth <= 0) {
+        if (enhancedSearch) {
+            return quiescenceSearch(gs, validMoves, ply, alpha, beta, turnMultiplier);
+        }
+        return turnMultiplier * evaluate(gs);
+    }
+
+    bool pvNode = (beta - alpha > 1);
+    int originalAlpha = alpha;
+
+    // Transposition table: reuse a result searched at least this deep
+    const TTEntry* hashEntry = enhancedSearch ? transpositionTable.probe(gs->zobristKey) : nullptr;
+    int hashMove = hashEntry ? hashEntry->bestMove : 0;
+    if (enhancedSearch) {
+        ttProbes++;
+        ttHits += hashEntry ? 1 : 0;
+    }
+    if (hashEntry && !pvNode && ply > 0 && hashEntry->depth >= depth) {
+        int hashScore = scoreFromTT(hashEntry->score, ply);
+        if (hashEntry->bound == TTEntry::Exact ||
+            (hashEntry->bound == TTEntry::Lower && hashScore >= beta) ||
+            (hashEntry->bound == TTEntry::Upper && hashScore <= alpha)) {
+            return hashScore;
+        }
+    }
+    bool inCheck = gs->inCheck;
+    const SearchParameters& params = searchParameters;
+    int staticEval = turnMultiplier * evaluate(gs);
+    bool frontierPruning = enhancedSearch && !pvNode && !inCheck && ply > 0;
+
+    // Reverse futility pruning: far enough above beta that no move will drop below it
+    if (frontierPruning && depth <= params.reverseFutilityMaxDepth && beta < MATE_BOUND &&
+        staticEval - params.reverseFutilityMargin * depth >= beta) {
+        return staticEval;
+    }
+
+    // Razoring: far below alpha, so see whether captures alone can recover
+    if (frontierPruning && depth <= params.razorMaxDepth) {
+        int razorMargin = params.razorMargin + params.razorMarginPerDepth * depth;
+        if (staticEval + razorMargin <= alpha) {
+            if (depth <= 1) {
+                return quiescenceSearch(gs, validMoves, ply, alpha, beta, turnMultiplier);
+            }
+            int razorAlpha = alpha - razorMargin;
+            int razorScore = quiescenceSearch(gs, validMoves, ply, razorAlpha, razorAlpha + 1, turnMultiplier);
+            if (razorScore <= razorAlpha) {
+                return razorScore;
+            }
+        }
+    }
+
+    // Futility pruning: quiet moves can't gain more than the margin near the leaves
+    int futilityMargin = (depth <= 1) ? params.futilityMarginFrontier : params.futilityMarginPreFrontier;
+    bool futilityPruning = frontierPruning && depth <= 2 && qAbs(alpha) < MATE_BOUND &&
+                           staticEval + futilityMargin <= alpha;
+
+    // Null-move pruning: if passing still fails high, a real move would too
+    if (enhancedSearch && allowNullMove && ply > 0 &&
+        depth >= NULL_MOVE_MIN_DEPTH && !inCheck && beta < MATE_BOUND &&
+        gs->hasNonPawnMaterial(gs->whiteToMove) && staticEval >= beta) {
+        // Adaptive reduction: larger deep in the tree, smaller near the leaves
+        int reduction = (depth > NULL_MOVE_ADAPTIVE_DEPTH) ? 3 : 2;
+
+        gs->makeNullMove();
+        nodes++;
+        QVector<Move>& nullMoveReplies = moveStack[ply + 1];
+        gs->getValidMoves(nullMoveReplies);
+        int nullScore = -findMoveNegaMaxAlphaBeta(gs, nullMoveReplies, depth - 1 - reduction, ply + 1,
+                                                  -beta, -beta + 1, -turnMultiplier, false);
+        gs->undoNullMove();
+        if (searchAborted) {
+            return 0;
+        }
+
+        if (nullScore >= beta) {
+            // Mates found after passing are not real, so don't return them
+            if (nullScore >= MATE_BOUND) {
+                nullScore = beta;
+            }
+
+            // Near the leaves the cutoff is trusted outright
+            if (depth < NULL_MOVE_VERIFY_DEPTH) {
+                return nullScore;
+            }
+
+            // Deeper, confirm it with a reduced search that cannot pass here
+            int verifyScore = findMoveNegaMaxAlphaBeta(gs, validMoves, depth - reduction, ply,
+                                                       beta - 1, beta, turnMultiplier, false);
+            if (verifyScore >= beta) {
+                return nullScore;
+            }
+        }
     }
 
     int maxScore = -CHECKMATE;
+    int bestMove = 0;
+    int moveCount = 0;
+
+    // The root keeps its own order (best move of the previous iteration first)
+    const QVector<Move>& orderedMoves = (enhancedSearch && ply > 0) ? orderMoves(gs, validMoves, ply, hashMove) : validMoves;
+
+    // Evaluate each possible move; at the root, skip the moves of earlier MultiPV lines
+    for (int moveIndex = (ply == 0) ? rootSkipMoves : 0; moveIndex < orderedMoves.size(); moveIndex++) {
+        const Move& move = orderedMoves[moveIndex];
+        bool quietMove = !move.isCapture && !move.isPawnPromotion;
+        bool killerMove = isKillerMove(move, ply);
+
+        // Late move pruning: past enough moves, quiet ones rarely matter near the leaves
+        if (enhancedSearch && !pvNode && !inCheck && quietMove && !killerMove &&
+            depth <= LMP_MAX_DEPTH && moveCount >= 3 + depth * depth && maxScore > -CHECKMATE) {
+            continue;
+        }
+
+        // Static exchange pruning: near the leaves, skip captures that lose too much material
+        if (enhancedSearch && !pvNode && !inCheck && !quietMove && ply > 0 &&
+            depth <= params.seePruneMaxDepth && maxScore > -CHECKMATE &&
+            !gs->seeGe(move, -params.seeCaptureMargin * depth)) {
+            continue;
+        }
 
-    // Evaluate each possible move
-    for (const Move& move : validMoves) {
         // Make the move
         gs->makeMove(move);
 
+        // Futility pruning: skip quiet moves that don't give check
+        if (futilityPruning && quietMove && !gs->isInCheck()) {
+            gs->undoMove();
+            maxScore = qMax(maxScore, staticEval + futilityMargin);
+            continue;
+        }
+
+        nodes++;
+        moveCount++;
+
         // Get valid moves for the next position
-        QVector<Move> nextMoves = gs->getValidMoves();
+        QVector<Move>& nextMoves = moveStack[ply + 1];
+        gs->getValidMoves(nextMoves);
+        bool givesCheck = gs->inCheck;
 
         // Recursive call with negated parameters (minimax with negation)
-        int score = -findMoveNegaMaxAlphaBeta(gs, nextMoves, depth - 1, -beta, -alpha, -turnMultiplier);
+        int score;
+        if (moveCount == 1 || !enhancedSearch) {
+            score = -findMoveNegaMaxAlphaBeta(gs, nextMoves, depth - 1, ply + 1,
+                                              -beta, -alpha, -turnMultiplier);
+        } else {
+            // Late move reduction for quiet moves that don't change the check status
+            int reduction = 0;
+            if (depth >= LMR_MIN_DEPTH && moveCount > LMR_FULL_DEPTH_MOVES &&
+                quietMove && !killerMove && !inCheck && !givesCheck) {
+                reduction = lmrReductions[qMin(depth, MAX_PLY - 1)][qMin(moveCount, MAX_PLY - 1)];
+                if (pvNode) {
+                    reduction--;
+                }
+                reduction = qBound(0, reduction, depth - 2);
+            }
+
+            // Null window: only prove that the move does not beat alpha
+            score = -findMoveNegaMaxAlphaBeta(gs, nextMoves, depth - 1 - reduction, ply + 1,
+                                              -alpha - 1, -alpha, -turnMultiplier);
+
+            // A reduced move that beats alpha is checked again at full depth
+            if (reduction > 0 && score > alpha) {
+                score = -findMoveNegaMaxAlphaBeta(gs, nextMoves, depth - 1, ply + 1,
+                                                  -alpha - 1, -alpha, -turnMultiplier);
+            }
+
+            // It did, so get its exact score with the full window
+            if (score > alpha && score < beta) {
+                score = -findMoveNegaMaxAlphaBeta(gs, nextMoves, depth - 1, ply + 1,
+                                                  -beta, -alpha, -turnMultiplier);
+            }
+        }
 
         // Undo the move
         gs->undoMove();
 
+        // The score of a stopped search is meaningless, so don't let it near the root move
+        if (searchAborted) {
+            return 0;
+        }
+
         // Update max score
         if (score > maxScore) {
             maxScore = score;
+        }
+
+        // Alpha-beta pruning
+        if (score > alpha) {
+            alpha = score;
+            bestMove = move.moveID;
 
             // If this is the root call, update the best move
-            if (depth == DEPTH) {
+            if (ply == 0) {
                 nextMove = move;
             }
         }
 
-        // Alpha-beta pruning
-        if (maxScore > alpha) {
-            alpha = maxScore;
-        }
-
         if (alpha >= beta) {
+            betaCutoffs++;
+            firstMoveCutoffs += (moveCount == 1) ? 1 : 0;
+
+            // Remember quiet moves that refute this position
+            if (enhancedSearch && quietMove) {
+                updateQuietMoveStats(gs, move, depth, ply);
+            }
             break;  // Beta cutoff - opponent won't allow this position
         }
     }
 
+    // Remember the result for transpositions and the next iteration.
+    // A root that skipped moves has no true score, so it is not stored.
+    if (enhancedSearch && !(ply == 0 && rootSkipMoves > 0)) {
+        TTEntry::Bound bound = (maxScore >= beta) ? TTEntry::Lower :
+                               (maxScore > originalAlpha) ? TTEntry::Exact : TTEntry::Upper;
+        transpositionTable.store(gs->zobristKey, scoreToTT(maxScore, ply), bestMove, depth, bound);
+    }
+
     return maxScore;
 }
 
+/**
+ * @brief Searches captures until the position is quiet
+ *
+ * Being mated scores -(CHECKMATE - ply), and the window is narrowed by
+ * mate-distance pruning as in findMoveNegaMaxAlphaBeta().
+ * Unless in check, the side to move may stand pat on the static
+ * evaluation; otherwise only captures and promotions are searched, in
+ * MVV-LVA order. Captures that lose material by static exchange are
+ * skipped, and delta pruning skips those whose material gain plus
+ * deltaMargin still leaves the score at or below alpha. In check, every
+ * evasion is searched and there is no stand-pat score.
+ *
+ * @param gs Current game state
+ * @param validMoves Legal moves of the current position
+ * @param ply Distance from the root
+ * @param alpha Alpha value for pruning
+ * @param beta Beta value for pruning
+ * @param turnMultiplier 1 for white, -1 for black (for score negation)
+ * @return int Score of the position for the side to move
+ */
+int ChessAI::quiescenceSearch(GameState* gs, const QVector<Move>& validMoves,
+                              int ply, int alpha, int beta, int turnMultiplier) {
+    // Unwind at once when the search has been stopped
+    if (checkStop()) {
+        return 0;
+    }
+    selDepth = qMax(selDepth, ply);
+
+    // Checkmate or stalemate
+    if (validMoves.isEmpty()) {
+        return gs->checkmate ? -(CHECKMATE - ply) : STALEMATE;
+    }
+
+    // Too far from the root to continue
+    if (ply >= MAX_PLY) {
+        return turnMultiplier * evaluate(gs);
+    }
+
+    // Mate-distance pruning, as in the main search
+    alpha = qMax(alpha, -(CHECKMATE - ply));
+    beta = qMin(beta, CHECKMATE - ply - 1);
+    if (alpha >= beta) {
+        return alpha;
+    }
+
+    bool inCheck = gs->inCheck;
+    int bestScore = -CHECKMATE;
+    int standPat = 0;
+
+    // Stand pat: the side to move doesn't have to capture
+    if (!inCheck) {
+        standPat = turnMultiplier * evaluate(gs);
+        if (standPat >= beta) {
+            return standPat;
+        }
+        if (standPat > alpha) {
+            alpha = standPat;
+        }
+        bestScore = standPat;
+    }
+
+    // Only captures and promotions, unless every evasion must be tried
+    const QVector<Move>& tacticalMoves = orderMoves(gs, validMoves, ply, 0, !inCheck);
+
+    for (const Move& move : tacticalMoves) {
+        if (!inCheck) {
+            // Delta pruning: even winning this material can't reach alpha
+            int gain = move.isCapture ? EvalTables::pieceTypeValue(move.pieceCaptured[1].toLatin1()) : 0;
+            if (move.isPawnPromotion) {
+                gain += EvalTables::pieceTypeValue('Q') - EvalTables::pieceTypeValue('p');
+            }
+            if (standPat + gain + searchParameters.deltaMargin <= alpha) {
+                continue;
+            }
+
+            // The exchange on the target square loses material
+            if (!gs->seeGe(move, 0)) {
+                continue;
+            }
+        }
+
+        gs->makeMove(move);
+        nodes++;
+        QVector<Move>& nextMoves = moveStack[ply + 1];
+        gs->getValidMoves(nextMoves);
+        int score = -quiescenceSearch(gs, nextMoves, ply + 1, -beta, -alpha, -turnMultiplier);
+        gs->undoMove();
+        if (searchAborted) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+        }
+        if (score > alpha) {
+            alpha = score;
+        }
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    return bestScore;
+}
+
+/**
+ * @brief Orders moves so that the most promising are searched first
+ *
+ * The transposition table move is searched first. Captures and
+ * promotions are scored by most valuable victim, least valuable attacker.
+ * Those that don't lose material by static exchange come next; killer
+ * moves of this ply follow, then the remaining quiet moves by history
+ * score, then the losing captures. Equal scores keep
+ * their generation order: an insertion sort is stable and, on lists this
+ * short, needs no buffer of its own.
+ *
+ * @param gs Current game state
+ * @param moves Moves to order
+ * @param ply Distance from the root, used to look up killer moves
+ * @param hashMove moveID of the transposition table move (0 for none)
+ * @param tacticalOnly Leave out moves that are neither captures nor promotions
+ * @return const QVector<Move>& The moves in search order, in orderedMoveStack[ply]
+ */
+const QVector<Move>& ChessAI::orderMoves(GameState* gs, const QVector<Move>& moves, int ply,
+                                         int hashMove, bool tacticalOnly) {
+    static const int HASH_MOVE_BONUS = 2000000;
+    static const int CAPTURE_BONUS = 1000000;
+    static const int KILLER_BONUS = 900000;
+    static const int LOSING_CAPTURE_PENALTY = -CAPTURE_BONUS;
+
+    int side = gs->whiteToMove ? 0 : 1;
+    QVector<QPair<int, int>>& scoredMoves = moveScores;  // (score, index into moves)
+    scoredMoves.resize(0);
+
+    for (int i = 0; i < moves.size(); i++) {
+        const Move& move = moves[i];
+        if (tacticalOnly && !move.isCapture && !move.isPawnPromotion) {
+            continue;
+        }
+        int score;
+        if (hashMove != 0 && move.moveID == hashMove) {
+            score = HASH_MOVE_BONUS;
+        } else if (move.isCapture || move.isPawnPromotion) {
+            int victim = move.isCapture ? EvalTables::pieceTypeValue(move.pieceCaptured[1].toLatin1()) : 0;
+            int promotion = move.isPawnPromotion ? EvalTables::pieceTypeValue('Q') : 0;
+            int attacker = EvalTables::pieceTypeValue(move.pieceMoved[1].toLatin1());
+            int bonus = gs->seeGe(move, 0) ? CAPTURE_BONUS : LOSING_CAPTURE_PENALTY;
+            score = bonus + 10 * (victim + promotion) - attacker;
+        } else if (ply < MAX_PLY && move.moveID == killerMoves[ply][0]) {
+            score = KILLER_BONUS + 1;
+        } else if (ply < MAX_PLY && move.moveID == killerMoves[ply][1]) {
+            score = KILLER_BONUS;
+        } else {
+            score = historyScores[side][move.startRow * 8 + move.startCol][move.endRow * 8 + move.endCol];
+        }
+        scoredMoves.push_back(qMakePair(score, i));
+    }
+
+    // Highest score first
+    for (int i = 1; i < scoredMoves.size(); i++) {
+        QPair<int, int> scoredMove = scoredMoves[i];
+        int j = i;
+        while (j > 0 && scoredMoves[j - 1].first < scoredMove.first) {
+            scoredMoves[j] = scoredMoves[j - 1];
+            j--;
+        }
+        scoredMoves[j] = scoredMove;
+    }
+
+    QVector<Move>& ordered = orderedMoveStack[ply];
+    ordered.resize(0);
+    for (const QPair<int, int>& scoredMove : scoredMoves) {
+        ordered.push_back(moves[scoredMove.second]);
+    }
+    return ordered;
+}
+
+/**
+ * @brief Checks whether a move is a killer move at the given ply
+ *
+ * @param move The move to check
+ * @param ply Distance from the root
+ * @return bool True if the move is one of the ply's two killer moves
+ */
+bool ChessAI::isKillerMove(const Move& move, int ply) const {
+    return ply < MAX_PLY && (move.moveID == killerMoves[ply][0] || move.moveID == killerMoves[ply][1]);
+}
+
+/**
+ * @brief Records a quiet move that caused a beta cutoff
+ *
+ * Shifts the ply's killer moves down to make room for the new one, and
+ * raises the move's history score by depth * depth. When a history score
+ * grows large, the whole table is halved so the scores stay bounded.
+ *
+ * @param gs Current game state (the side to move made the move)
+ * @param move The quiet move that caused the cutoff
+ * @param depth Remaining depth of the node
+ * @param ply Distance from the root
+ */
+void ChessAI::updateQuietMoveStats(GameState* gs, const Move& move, int depth, int ply) {
+    if (ply < MAX_PLY && killerMoves[ply][0] != move.moveID) {
+        killerMoves[ply][1] = killerMoves[ply][0];
+        killerMoves[ply][0] = move.moveID;
+    }
+
+    int side = gs->whiteToMove ? 0 : 1;
+    int& history = historyScores[side][move.startRow * 8 + move.startCol][move.endRow * 8 + move.endCol];
+    history += depth * depth;
+
+    if (history > 100000) {
+        for (int s = 0; s < 2; s++) {
+            for (int from = 0; from < 64; from++) {
+                for (int to = 0; to < 64; to++) {
+                    historyScores[s][from][to] /= 2;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Evaluates a position, using the evaluation cache when possible
+ *
+ * Checkmate and stalemate depend on move generation rather than on the
+ * hash, so they are always scored directly; everything else is looked up
+ * by Zobrist hash before calling scoreBoard(), and clamped to MAX_EVAL
+ * so that no evaluation is mistaken for a mate score. Below full
+ * strength, the skill level's noise is added after the lookup.
+ *
+ * @param gs Current game state to evaluate
+ * @return int Score in centipawns from white's perspective
+ */
+int ChessAI::evaluate(GameState* gs) {
+    if (gs->checkmate || gs->stalemate) {
+        return scoreBoard(gs);
+    }
+
+    int score;
+    if (!evalCache.probe(gs->zobristKey, score)) {
+        score = qBound(-MAX_EVAL, scoreBoard(gs), MAX_EVAL);
+        evalCache.store(gs->zobristKey, score);
+    }
+    if (evalNoise > 0) {
+        score = qBound(-MAX_EVAL, score + noiseFor(gs->zobristKey), MAX_EVAL);
+    }
+    return score;
+}
+
 /**
  * @brief Evaluates the current board position
  * 
  * Assigns a score to the current board state by considering:
  * 1. Material value of all pieces
- * 2. Positional value of pieces based on their location
- * 3. Game-ending conditions (checkmate, stalemate)
+ * 2. Positional value of pieces based on their location, interpolated
+ *    between midgame and endgame tables by the game phase
+ * 3. Pawn structure and king pawn shields
+ * 4. Material imbalance, and endgame scaling or a specialised evaluator
+ *    for recognised endings
+ * 5. Mobility, attacks on the king zone and hanging pieces
+ * 6. Game-ending conditions (checkmate, stalemate)
+ * 
+ * The material and positional totals are kept up to date by
+ * GameState::makeMove() and undoMove(), and the pawn and material terms
+ * are looked up by pawn hash and material key. The attack terms come from
+ * GameState::attackMaps(), which the search reuses for move ordering.
  * 
  * @param gs Current game state to evaluate
- * @return int Score from white's perspective (positive is good for white)
+ * @return int Score in centipawns from white's perspective (positive is good for white)
  */
 int ChessAI::scoreBoard(GameState* gs) {
     // Check for game-ending conditions
@@ -275,33 +1701,41 @@ int ChessAI::scoreBoard(GameState* gs) {
         return STALEMATE;
     }
 
-    int score = 0;
-
-    // Evaluate each piece on the board
-    for (int row = 0; row < 8; row++) {
-        for (int col = 0; col < 8; col++) {
-            QString piece = gs->board[row][col];
+    // Recognised endings have their own evaluation
+    const MaterialEntry& material = materialHashTable.probe(*gs);
+    if (material.evaluator) {
+        return material.evaluator(*gs);
+    }
 
-            if (piece != "--") {
-                // Position score
-                double piecePositionScore = 0.0;
+    // Neural network evaluation from the incrementally updated accumulator
+    if (gs->network) {
+        int score = gs->network->evaluate(gs->accumulator, gs->whiteToMove);
+        return gs->whiteToMove ? score : -score;
+    }
 
-                // Don't evaluate king position since it's not in the position tables
-                if (piece[1] != 'K') {
-                    piecePositionScore = piecePositionScores[piece][row][col];
-                }
+    // Pawn structure and shields, cached by pawn hash, then mobility, king
+    // attacks and hanging pieces from the attack maps of this node
+    const PawnEntry& pawns = pawnHashTable.probe(*gs);
+    int packedScore = gs->positionScore + pawns.score + material.imbalance + gs->attackMaps().score();
+    if (gs->whiteKingLocation.first >= 6) {
+        packedScore += pawns.shelter[0][gs->whiteKingLocation.second];
+    }
+    if (gs->blackKingLocation.first <= 1) {
+        packedScore -= pawns.shelter[1][gs->blackKingLocation.second];
+    }
 
-                // Add or subtract score based on piece color
-                if (piece[0] == 'w') {
-                    score += pieceScore[piece[1]] + piecePositionScore;
-                } else {
-                    score -= pieceScore[piece[1]] + piecePositionScore;
-                }
-            }
-        }
+    // Material plus the positional terms, with the endgame half scaled
+    // down in drawish endings
+    int mg = gs->materialScore + EvalTables::mgValue(packedScore);
+    int eg = gs->materialScore + EvalTables::egValue(packedScore);
+    int scale = material.scaleFactor[eg > 0 ? 0 : 1];
+    if (material.scaleFunction) {
+        scale = qMin(scale, material.scaleFunction(*gs));
     }
+    eg = eg * scale / MaterialEntry::NORMAL_SCALE;
 
-    return score;
+    // Blend the two halves by the game phase
+    return (mg * material.gamePhase + eg * (EvalTables::TOTAL_PHASE - material.gamePhase)) / EvalTables::TOTAL_PHASE;
 }
 
 /**
@@ -320,6 +1754,6 @@ Move ChessAI::findRandomMove(const QVector<Move>& validMoves) {
         return Move();
     }
 
-    int randomIndex = QRandomGenerator::global()->bounded(validMoves.size());
+    int randomIndex = randomGenerator.bounded(validMoves.size());
     return validMoves[randomIndex];
 }
\ No newline at end of file
@@ -4,7 +4,169 @@
 #include <QObject>
 #include <QMap>
 #include <QVector>
+#include <QString>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <atomic>
 #include "gamestate.h"
+#include "pawnhash.h"
+#include "material.h"
+#include "evalcache.h"
+#include "transposition.h"
+#include "nnue.h"
+#include "tablebase.h"
+#include "syzygy.h"
+
+/**
+ * @struct SearchParameters
+ * @brief Tunable margins for the pruning done near the leaves of the search
+ *
+ * All margins are in centipawns, the scale of scoreBoard().
+ * They are kept out of the search code so that a tuning pipeline can set
+ * them, either directly or by name through ChessAI::setSearchParameter().
+ */
+struct SearchParameters {
+    /** @brief Futility margin at frontier nodes (depth 1) */
+    int futilityMarginFrontier;
+
+    /** @brief Futility margin at pre-frontier nodes (depth 2) */
+    int futilityMarginPreFrontier;
+
+    /** @brief Reverse futility (static null move) margin per ply of remaining depth */
+    int reverseFutilityMargin;
+
+    /** @brief Maximum remaining depth for reverse futility pruning */
+    int reverseFutilityMaxDepth;
+
+    /** @brief Base razoring margin */
+    int razorMargin;
+
+    /** @brief Extra razoring margin per ply of remaining depth */
+    int razorMarginPerDepth;
+
+    /** @brief Maximum remaining depth for razoring */
+    int razorMaxDepth;
+
+    /** @brief Margin added to a capture's gain before it is skipped in quiescence search */
+    int deltaMargin;
+
+    /** @brief Material a capture may lose by static exchange per ply of remaining depth before it is pruned */
+    int seeCaptureMargin;
+
+    /** @brief Maximum remaining depth for pruning captures by static exchange */
+    int seePruneMaxDepth;
+
+    /**
+     * @brief Constructor with the default margins
+     */
+    SearchParameters()
+        : futilityMarginFrontier(200), futilityMarginPreFrontier(500),
+          reverseFutilityMargin(100), reverseFutilityMaxDepth(3),
+          razorMargin(200), razorMarginPerDepth(100), razorMaxDepth(2),
+          deltaMargin(200), seeCaptureMargin(100), seePruneMaxDepth(3) {}
+};
+
+/**
+ * @struct PositionUpdate
+ * @brief Moves that bring the AI's own position up to date with the game
+ *
+ * The AI keeps one GameState for the whole game. Instead of a copy of
+ * the game, each request carries how many of the moves already applied
+ * to that position still belong to the game, and the moves played after
+ * them, by moveID. Moves taken back or a new game simply keep fewer
+ * moves; both positions start from the initial position.
+ */
+struct PositionUpdate {
+    /** @brief Number of moves of the AI's position that the game still shares */
+    int keptMoves;
+
+    /** @brief moveIDs of the moves played after those, in order */
+    QVector<int> moveIds;
+
+    /**
+     * @brief Constructor for an update that changes nothing
+     */
+    PositionUpdate() : keptMoves(0) {}
+};
+
+/**
+ * @struct AnalysisLine
+ * @brief One line of a MultiPV search: a root move, its score and its variation
+ */
+struct AnalysisLine {
+    /** @brief Root move of the line */
+    Move move;
+
+    /** @brief Score of the line from the side to move's perspective */
+    int score;
+
+    /** @brief Depth of the iteration the line comes from */
+    int depth;
+
+    /** @brief Principal variation, starting with move */
+    QVector<Move> pv;
+
+    /**
+     * @brief Constructor for an empty line
+     */
+    AnalysisLine() : score(0), depth(0) {}
+};
+
+/**
+ * @struct SearchInfo
+ * @brief Report on one completed iteration of a search
+ *
+ * Emitted by ChessAI::searchInfoReady() and written to the search log.
+ * Counters cover the whole search so far, not just the iteration.
+ */
+struct SearchInfo {
+    /** @brief Request the search belongs to (0 for searches outside findBestMove() and ponder()) */
+    int requestId;
+
+    /** @brief Whether the search is a ponder search */
+    bool pondering;
+
+    /** @brief Depth of the completed iteration */
+    int depth;
+
+    /** @brief Greatest distance from the root reached, quiescence search included */
+    int selDepth;
+
+    /** @brief Nodes visited */
+    qint64 nodes;
+
+    /** @brief Nodes per second */
+    qint64 nps;
+
+    /** @brief Time since the search started in milliseconds */
+    qint64 timeMs;
+
+    /** @brief Score from the side to move's perspective; beyond +-ChessAI::MATE_BOUND a mate */
+    int score;
+
+    /** @brief Principal variation, read back from the transposition table */
+    QVector<Move> pv;
+
+    /** @brief Fraction of transposition table probes that found an entry */
+    double ttHitRate;
+
+    /** @brief Fraction of beta cutoffs caused by the first move searched */
+    double firstMoveCutoffRate;
+
+    /** @brief Nodes of this iteration divided by nodes of the previous one (0 for the first) */
+    double branchingFactor;
+
+    /** @brief Nodes scored by the endgame tablebase */
+    qint64 tbHits;
+
+    /**
+     * @brief Constructor for an empty report
+     */
+    SearchInfo()
+        : requestId(0), pondering(false), depth(0), selDepth(0), nodes(0), nps(0), timeMs(0),
+          score(0), ttHitRate(0), firstMoveCutoffRate(0), branchingFactor(0), tbHits(0) {}
+};
 
 /**
  * @class ChessAI
@@ -26,84 +188,273 @@ public:
      */
     explicit ChessAI(QObject *parent = nullptr);
 
-    /** @brief Value assigned to a checkmate position */
-    static const int CHECKMATE = 1000;
+    /**
+     * @brief Value assigned to a checkmate position, above any material balance
+     *
+     * The search scores being mated n plies from the root as
+     * -(CHECKMATE - n), so shorter mates score higher. Window bounds of
+     * +-CHECKMATE therefore lie outside every real score.
+     */
+    static const int CHECKMATE = 100000;
     
     /** @brief Value assigned to a stalemate position */
     static const int STALEMATE = 0;
+
+    /** @brief Value assigned to a draw by repetition or the fifty-move rule */
+    static const int DRAW = 0;
     
-    /** @brief Maximum search depth for the AI */
+    /** @brief Search depth the AI always completes, regardless of the time budget */
     static const int DEPTH = 3;
-    
+
+    /** @brief Deepest iteration the AI will start */
+    static const int MAX_DEPTH = 32;
+
+    /** @brief Maximum distance from the root tracked by per-ply tables */
+    static const int MAX_PLY = 64;
+
+    /** @brief Capacity reserved for the move list of each ply; no legal position has more moves */
+    static const int MAX_MOVES = 256;
+
+    /** @brief Scores at or beyond +-MATE_BOUND are mates within MAX_PLY */
+    static const int MATE_BOUND = CHECKMATE - MAX_PLY;
+
+    /** @brief Largest static evaluation; evaluations are clamped so they never look like mates */
+    static const int MAX_EVAL = MATE_BOUND - 1;
+
     /**
-     * @brief Position evaluation table for knights
+     * @brief Time budget for one AI move in milliseconds
      *
-     * Higher values represent better squares for knights.
-     * Knights are most effective in the center of the board.
+     * Iterations beyond DEPTH are only started while less than half of the
+     * budget has been used, since each one takes longer than the last, and
+     * are stopped once the whole budget is used.
      */
-    QVector<QVector<double>> knightScores;
-    
+    static const int TIME_BUDGET_MS = 1000;
+
     /**
-     * @brief Position evaluation table for bishops
+     * @brief Number of nodes between two checks of the stop flag
      *
-     * Higher values represent better squares for bishops.
-     * Bishops are most effective on long diagonals.
+     * Must be a power of two. At the speed of the search this keeps the
+     * delay between abortSearch() and the search returning to a few
+     * milliseconds.
      */
-    QVector<QVector<double>> bishopScores;
-    
+    static const int STOP_CHECK_INTERVAL = 256;
+
     /**
-     * @brief Position evaluation table for rooks
+     * @brief Strongest skill level, which plays with the full time budget and no noise
      *
-     * Higher values represent better squares for rooks.
-     * Rooks are most effective on open files and the 7th rank.
+     * Weaker levels stop each search after a fixed number of nodes and add
+     * noise to the evaluation (see setSkillLevel()).
      */
-    QVector<QVector<double>> rookScores;
-    
+    static const int MAX_SKILL_LEVEL = 10;
+
+    /** @brief Initial half-width of the root aspiration window in centipawns */
+    static const int ASPIRATION_WINDOW = 50;
+
+    /** @brief Minimum remaining depth at which a null move is tried */
+    static const int NULL_MOVE_MIN_DEPTH = 2;
+
+    /** @brief Remaining depth above which the null move reduction grows from 2 to 3 */
+    static const int NULL_MOVE_ADAPTIVE_DEPTH = 6;
+
+    /** @brief Remaining depth from which a null move cutoff is verified by a reduced search */
+    static const int NULL_MOVE_VERIFY_DEPTH = 5;
+
+    /** @brief Minimum remaining depth at which late moves are reduced */
+    static const int LMR_MIN_DEPTH = 3;
+
+    /** @brief Number of moves searched at full depth before reductions start */
+    static const int LMR_FULL_DEPTH_MOVES = 3;
+
+    /** @brief Maximum remaining depth at which late quiet moves are pruned */
+    static const int LMP_MAX_DEPTH = 3;
+
     /**
-     * @brief Position evaluation table for queens
+     * @brief Tree search algorithms supported by the engine
      *
-     * Higher values represent better squares for queens.
-     * Queens combine the power of rooks and bishops.
+     * AlphaBeta is a single fixed-depth search with the full window.
+     * PrincipalVariation adds iterative deepening with root aspiration
+     * windows and null-window searches for every move after the first,
+     * together with move ordering and the pruning and reductions that
+     * depend on it. AlphaBeta is kept as the baseline for benchmarks.
      */
-    QVector<QVector<double>> queenScores;
-    
+    enum SearchAlgorithm {
+        AlphaBeta,
+        PrincipalVariation
+    };
+
+    /** @brief Algorithm used by findBestMove() (default: PrincipalVariation) */
+    SearchAlgorithm searchAlgorithm;
+
+    /** @brief Pruning margins used by the principal variation search */
+    SearchParameters searchParameters;
+
     /**
-     * @brief Position evaluation table for pawns
+     * @brief Whether the search raises alpha to a draw when a repetition is one move away
      *
-     * Higher values represent better squares for pawns.
-     * Pawns gain value as they advance toward promotion.
+     * Uses GameState::hasUpcomingRepetition() (default: true).
      */
-    QVector<QVector<double>> pawnScores;
-    
+    bool upcomingRepetitionCheck;
+
     /**
-     * @brief Mapping of piece types to their material values
+     * @brief Number of best root moves searched with exact scores (default: 1)
      *
-     * Standard chess piece values:
-     * - Pawn: 1
-     * - Knight: 3
-     * - Bishop: 3
-     * - Rook: 5
-     * - Queen: 9
-     * - King: 0 (not used for evaluation, just prevent capture)
+     * Above 1, every iteration of the principal variation search finds
+     * the best move, then the best of the remaining moves, and so on. The
+     * lines share the transposition table and move ordering, so they cost
+     * far less than as many separate searches. Ignored by AlphaBeta.
      */
-    QMap<QChar, int> pieceScore;
-    
+    int multiPv;
+
     /**
-     * @brief Mapping of piece identifiers to their position evaluation tables
+     * @brief Whether the search scores endings from the endgame tablebase and the Syzygy tables (default: true)
      *
-     * Maps piece identifiers (e.g., "wN" for white knight) to their
-     * corresponding position evaluation tables.
+     * Positions covered by an available table are scored as mates at
+     * their exact distance, or as draws, without searching them; see
+     * setSyzygyPath() and useSyzygy for the Syzygy tables.
      */
-    QMap<QString, QVector<QVector<double>>> piecePositionScores;
-    
+    bool useTablebase;
+
     /**
-     * @brief Initializes the position evaluation tables for all piece types
+     * @brief Whether the search also uses the Syzygy tables (default: false)
      *
-     * Creates and populates the tables that assign positional values to each
-     * piece type on different squares of the board. Creates separate tables
-     * for white and black pieces (black tables are mirror images of white).
+     * The Syzygy decoder has not been checked against real table files
+     * yet, so the root filtering and cutoffs that trust it stay off unless
+     * this is set; "ChessGame syzygy" checks the tables in use against the
+     * endgame tablebase. Only read when useTablebase is set.
      */
-    void initScoreTables();
+    bool useSyzygy;
+
+    /**
+     * @brief Most pieces, kings included, of the tables prepareTablebases() builds
+     *
+     * Building a table with EndgameTablebase::MAX_PIECES pieces takes
+     * tens of seconds, so by default only the smaller tables are built
+     * (default: 3). Larger ones are used when they are in TABLEBASE_DIR
+     * ("ChessGame tbgen" builds them). Searches never build tables.
+     */
+    int tablebaseGenerationPieces;
+
+    /** @brief Score of a position the Syzygy tables call won, below every tablebase mate */
+    static const int SYZYGY_WIN = MAX_EVAL - 256;
+
+    /** @brief Network weight file looked for when the AI is created */
+    static constexpr const char* NNUE_FILE = "mittens.nnue";
+
+    /** @brief Directory of cached endgame tables, mapped when the AI is created */
+    static constexpr const char* TABLEBASE_DIR = "tablebases";
+
+    /**
+     * @brief Loads neural network weights and switches to the network evaluation
+     *
+     * @param path Path of the weight file (see NnueNetwork for the layout)
+     * @return True if the weights were loaded
+     */
+    bool loadNetwork(const QString& path);
+
+    /**
+     * @brief Chooses between the network and the hand-written evaluation
+     *
+     * The network is only used when weights have been loaded.
+     *
+     * @param enabled True to use the network when available
+     */
+    void setUseNnue(bool enabled);
+
+    /**
+     * @brief Checks whether searches evaluate with the network
+     * @return True if weights are loaded and the network is enabled
+     */
+    bool nnueActive() const;
+
+    /**
+     * @brief Gets the current skill level
+     * @return Level from 1 to MAX_SKILL_LEVEL
+     */
+    int skillLevel() const;
+
+    /**
+     * @brief Makes every random choice of the AI reproducible
+     *
+     * Seeds the generator behind the root move shuffle, the fallback
+     * random move and the evaluation noise, which otherwise differ from
+     * one run to the next. Together with resetSearchState(), the same
+     * sequence of requests then visits the same nodes and picks the same
+     * moves, as long as no search is cut short by the time budget.
+     * Clears the transposition table, since the noise changes.
+     *
+     * @param seed Seed of the generator
+     */
+    void setRandomSeed(quint32 seed);
+
+    /**
+     * @brief Sets the directories of the Syzygy tables
+     *
+     * The files are only listed here; each is memory-mapped the first
+     * time the search needs it. With tables found, positions with few
+     * enough pieces and no castling rights are scored from them when
+     * useTablebase and useSyzygy are set: inside the tree wherever the fifty-move
+     * counter has just been reset (WDL tables), and at the root by
+     * keeping only the moves that best keep the result (DTZ tables).
+     * The endgame tablebase comes first where both cover a position.
+     *
+     * @param path Directories separated by QDir::listSeparator(), or an empty string for none
+     * @return Number of tables found
+     */
+    int setSyzygyPath(const QString& path);
+
+    /**
+     * @brief Limits Syzygy probing to positions with few pieces
+     *
+     * @param pieces Most pieces, kings included (default: SyzygyTablebase::MAX_PIECES)
+     */
+    void setSyzygyMaxPieces(int pieces);
+
+    /**
+     * @brief Sets one of the search parameters by name
+     *
+     * Names match the SearchParameters fields (e.g. "futilityMarginFrontier"),
+     * so tuning tools can drive the engine without recompiling it.
+     *
+     * @param name Name of the parameter
+     * @param value New value
+     * @return True if the parameter exists, false otherwise
+     */
+    bool setSearchParameter(const QString& name, int value);
+
+    /**
+     * @brief Stops the search for a request and drops every earlier request
+     *
+     * Safe to call from any thread. A running search for requestId or an
+     * earlier request returns within STOP_CHECK_INTERVAL nodes without
+     * emitting findBestMoveFinished(); such requests still waiting in the
+     * queue are skipped when they arrive.
+     *
+     * @param requestId The newest request to abort
+     */
+    void abortSearch(int requestId);
+
+    /**
+     * @brief Cancels the building of endgame tables, for shutdown
+     *
+     * Safe to call from any thread. A prepareTablebases() in progress
+     * returns within a few thousand positions without saving the table
+     * it was building, and later calls build nothing.
+     */
+    void stopTablebaseBuild();
+
+    /**
+     * @brief Tells a ponder search that its predicted move was played
+     *
+     * Safe to call from any thread, also before ponder() has started.
+     * The ponder search for requestId keeps its tree and becomes a normal
+     * search whose time budget counts from when pondering began, so the
+     * move is usually ready at once. If the search has already finished,
+     * the move it is holding is emitted from the AI's thread.
+     *
+     * @param requestId Identifier passed to ponder()
+     */
+    void ponderHit(int requestId);
+    
 
 public slots:
     /**
@@ -113,11 +464,75 @@ public slots:
      * for the best move. If no strong move is found, falls back to
      * selecting a random move.
      *
-     * @param gs The current game state
-     * @param validMoves List of valid moves for the current position
-     * @return The best move found by the AI
+     * The AI's own position is brought up to date first, even for a
+     * request that has already been aborted, so that the next update
+     * applies to the position it was computed for.
+     *
+     * @param update Moves played since the last request
+     * @param requestId Identifier of the request, passed back with the result
+     * @return The best move found by the AI, or an empty move if the request was aborted
+     */
+    Move findBestMove(const PositionUpdate& update, int requestId = 0);
+
+    /**
+     * @brief Searches the position expected after the opponent's reply
+     *
+     * Called with the position after the move predicted by the last
+     * search, while the opponent is still thinking. The search runs
+     * without a time limit until ponderHit() or abortSearch() is called
+     * for the request. After a ponder hit it finishes like findBestMove()
+     * and emits findBestMoveFinished(); after an abort it emits nothing.
+     * A search that ends before the hit returns at once and holds its
+     * move until ponderHit() releases it, so the thread never blocks.
+     *
+     * @param update Moves played since the last request, ending with the predicted move
+     * @param requestId Identifier of the request, used by ponderHit() and abortSearch()
+     * @return The best move found, or an empty move if the request was aborted
+     */
+    Move ponder(const PositionUpdate& update, int requestId);
+
+    /**
+     * @brief Finds the best few moves of the current game state
+     *
+     * For hints and game review. Brings the AI's position up to date like
+     * findBestMove(), then runs a MultiPV search with the given number of
+     * lines and emits analysisFinished().
+     *
+     * @param update Moves played since the last request
+     * @param lineCount Number of lines wanted
+     * @param requestId Identifier of the request, passed back with the result
+     * @return The lines, best first, or an empty list if the request was aborted
+     */
+    QVector<AnalysisLine> analyze(const PositionUpdate& update, int lineCount, int requestId);
+
+    /**
+     * @brief Sets how strongly the AI plays
+     *
+     * Below MAX_SKILL_LEVEL, every search stops after the level's node
+     * budget, so a move costs about the same CPU time in any position,
+     * and each evaluation is offset by up to the level's noise. The noise
+     * is a hash of the position, so a position always gets the same
+     * offset and the search stays consistent with its transposition
+     * table. The time budget still caps the search on slow machines: an
+     * iteration beyond DEPTH is stopped when it runs out, whichever budget
+     * is used up first. The node budget needs iterative deepening and is
+     * ignored by AlphaBeta.
+     *
+     * @param level Level from 1 (weakest) to MAX_SKILL_LEVEL (full strength); clamped to that range
      */
-    Move findBestMove(GameState* gs, const QVector<Move>& validMoves);
+    void setSkillLevel(int level);
+
+    /**
+     * @brief Builds the endgame tables that are small enough to build during a game
+     *
+     * Makes every table with up to tablebaseGenerationPieces pieces
+     * available, mapping the ones in TABLEBASE_DIR and building (and
+     * saving) the others. The first run takes a few seconds, so ChessBoard
+     * queues this on the AI's thread at startup, ahead of any search.
+     * Aborting a search doesn't stop it; only stopTablebaseBuild() does,
+     * leaving the unfinished tables out.
+     */
+    void prepareTablebases();
     
     /**
      * @brief Selects a random move from the list of valid moves
@@ -130,11 +545,314 @@ public slots:
      */
     Move findRandomMove(const QVector<Move>& validMoves);
 
+public:
+    /**
+     * @brief Searches the root moves in the given order and returns the best one
+     *
+     * Runs the configured search algorithm to the requested depth without
+     * shuffling the root moves, so repeated calls on the same position
+     * visit the same tree. Used by findBestMove() and by the benchmarks.
+     * The moves are copied into a buffer of the AI, so the search itself
+     * never allocates.
+     *
+     * @param gs The game state to search (restored before returning)
+     * @param rootMoves Legal moves of the position, in search order
+     * @param maxDepth Depth of the final iteration
+     * @param timeBudgetMs Time budget in milliseconds for iterations beyond DEPTH (0: no limit)
+     * @return The best move found, or an empty move if none raised alpha.
+     *         If the search is stopped, the best move of the last completed iteration.
+     */
+    Move searchRootMoves(GameState* gs, const QVector<Move>& rootMoves, int maxDepth, qint64 timeBudgetMs = 0);
+
+    /**
+     * @brief Gets the number of nodes visited by the last search
+     * @return Count of moves made inside the search tree
+     */
+    qint64 nodeCount() const;
+
+    /**
+     * @brief Gets the score of the last completed search
+     * @return Score from the perspective of the side to move at the root
+     */
+    int lastScore() const;
+
+    /**
+     * @brief Gets the evaluation cache hit rate of the last search
+     * @return Fraction of cache probes that hit, between 0 and 1
+     */
+    double evalCacheHitRate() const;
+
+    /**
+     * @brief Appends a JSON object per completed iteration to a file
+     *
+     * Each line holds the fields of one SearchInfo, with the principal
+     * variation as a list of moves in coordinate notation ("e2e4").
+     * Call it before the AI is moved to its thread.
+     *
+     * @param path File to append to, or an empty string to stop logging
+     * @return True if logging is off or the file could be opened
+     */
+    bool setSearchLogFile(const QString& path);
+
+    /**
+     * @brief Gets the lines of the last MultiPV search
+     *
+     * Lines are recorded after every completed iteration while multiPv is
+     * above 1; a stopped iteration leaves those of the previous one.
+     *
+     * @return The lines, best first, or an empty list if multiPv was 1
+     */
+    const QVector<AnalysisLine>& lastAnalysisLines() const;
+
+    /**
+     * @brief Forgets all stored search results
+     *
+     * Searches reuse the transposition table across moves; benchmarks
+     * clear it so that every run starts from the same state.
+     */
+    void clearTranspositionTable();
+
+    /**
+     * @brief Forgets stored search results and move ordering statistics
+     *
+     * Clears the transposition table, the killer moves and the history
+     * scores, so that the next search doesn't depend on earlier ones and
+     * visits the same nodes every time.
+     */
+    void resetSearchState();
+
+    /**
+     * @brief Converts a search score for storage in the transposition table
+     *
+     * Mate scores count plies from the root; stored ones count from the
+     * position itself, so they stay correct when it is reached at another ply.
+     *
+     * @param score Score from the search
+     * @param ply Distance of the position from the root
+     * @return Score to store
+     */
+    static int scoreToTT(int score, int ply);
+
+    /**
+     * @brief Converts a stored score back to a search score
+     *
+     * @param score Score from the transposition table
+     * @param ply Distance of the position from the root
+     * @return Score relative to the root
+     */
+    static int scoreFromTT(int score, int ply);
+
 private:
     /**
      * @brief The best move found by the search algorithm
      */
     Move nextMove;
+
+    /** @brief Number of nodes visited by the current search */
+    qint64 nodes;
+
+    /** @brief Greatest ply reached by the current search */
+    int selDepth;
+
+    /** @brief Transposition table probes of the current search */
+    qint64 ttProbes;
+
+    /** @brief Transposition table probes of the current search that found an entry */
+    qint64 ttHits;
+
+    /** @brief Beta cutoffs in the current search */
+    qint64 betaCutoffs;
+
+    /** @brief Beta cutoffs in the current search caused by the first move searched */
+    qint64 firstMoveCutoffs;
+
+    /** @brief Nodes of the current search scored by the endgame tablebase */
+    qint64 tablebaseHits;
+
+    /** @brief Request being searched, reported in SearchInfo */
+    int searchRequestId;
+
+    /** @brief JSON lines log of completed iterations; closed unless setSearchLogFile() opened it */
+    QFile searchLog;
+
+    /** @brief Root score of the last completed search iteration */
+    int searchScore;
+
+    /**
+     * @brief Late move reductions indexed by [remaining depth][move number]
+     *
+     * Filled in the constructor from log(depth) * log(moveNumber), so
+     * reductions grow slowly with both.
+     */
+    int lmrReductions[MAX_PLY][MAX_PLY];
+
+    /**
+     * @brief Legal moves of the node at each ply, indexed by distance from the root
+     *
+     * A node generates its children's moves into the next ply's list,
+     * which keeps its capacity from node to node, so the search makes and
+     * searches moves without allocating. Index MAX_PLY holds the replies
+     * at the deepest quiescence node.
+     */
+    QVector<Move> moveStack[MAX_PLY + 1];
+
+    /** @brief Moves of the node at each ply in search order, filled by orderMoves() */
+    QVector<Move> orderedMoveStack[MAX_PLY + 1];
+
+    /**
+     * @brief The AI's copy of the game, kept for the whole game
+     *
+     * Only the AI thread touches it. Its move log lets the search see
+     * repetitions of positions played before the request.
+     */
+    GameState position;
+
+    /** @brief Legal moves of position, set by syncPosition() */
+    QVector<Move> positionMoves;
+
+    /** @brief Number of leading root moves the root skips, taken by earlier MultiPV lines */
+    int rootSkipMoves;
+
+    /** @brief Score of each MultiPV line in the current search, by line */
+    int lineScores[MAX_MOVES];
+
+    /** @brief Lines of the last completed MultiPV iteration */
+    QVector<AnalysisLine> analysisLines;
+
+    /** @brief Root moves of the current search, best move of the last iteration first */
+    QVector<Move> rootMoveBuffer;
+
+    /** @brief (score, index) pairs sorted by orderMoves() */
+    QVector<QPair<int, int>> moveScores;
+
+    /** @brief Two most recent quiet moves (by moveID) that caused a beta cutoff at each ply */
+    int killerMoves[MAX_PLY][2];
+
+    /**
+     * @brief History heuristic scores indexed by [side][from square][to square]
+     *
+     * Quiet moves that cause beta cutoffs gain depth * depth, so moves that
+     * were good elsewhere in the tree are tried earlier.
+     */
+    int historyScores[2][64][64];
+
+    /** @brief Cache of pawn-structure evaluations, keyed by GameState::pawnKey */
+    PawnHashTable pawnHashTable;
+
+    /** @brief Cache of material configurations, keyed by GameState::materialKey */
+    MaterialHashTable materialHashTable;
+
+    /** @brief Cache of static evaluations, keyed by GameState::zobristKey */
+    EvalCache evalCache;
+
+    /** @brief Search results of the principal variation search, keyed by GameState::zobristKey */
+    TranspositionTable transpositionTable;
+
+    /** @brief Exact results of small endings */
+    EndgameTablebase tablebase;
+
+    /** @brief Results of larger endings, read from Syzygy files */
+    SyzygyTablebase syzygy;
+
+    /** @brief Set from other threads to make the running search return */
+    std::atomic<bool> stopRequested;
+
+    /** @brief Set by stopTablebaseBuild() to cancel prepareTablebases() for good */
+    std::atomic<bool> tablebaseBuildStopped;
+
+    /** @brief Newest request aborted by abortSearch(); requests up to it are dropped */
+    std::atomic<int> abortedRequestId;
+
+    /** @brief Newest ponder request whose predicted move was played */
+    std::atomic<int> ponderHitRequestId;
+
+    /** @brief Whether the current search must unwind, because of the stop flag, the time budget or the node budget */
+    bool searchAborted;
+
+    /** @brief Whether the current search is a ponder search */
+    bool pondering;
+
+    /** @brief Request being searched by the current ponder search */
+    int ponderRequestId;
+
+    /** @brief Move of a ponder search that finished before its ponder hit */
+    Move heldMove;
+
+    /** @brief Expected reply to heldMove */
+    Move heldReply;
+
+    /** @brief Request heldMove belongs to (0: no move held) */
+    int heldRequestId;
+
+    /** @brief Time since the current search (or ponder search) started */
+    QElapsedTimer searchTimer;
+
+    /** @brief Time budget of the current search in milliseconds (0: no limit) */
+    qint64 searchTimeBudget;
+
+    /** @brief Depth of the current root iteration */
+    int rootDepth;
+
+    /** @brief Neural network evaluator (empty unless weights were loaded) */
+    NnueNetwork network;
+
+    /** @brief Whether to evaluate with the network when it is loaded */
+    bool useNnue;
+
+    /** @brief Current skill level, from 1 to MAX_SKILL_LEVEL */
+    int skill;
+
+    /** @brief Nodes after which a search stops, from the skill level (0: no limit) */
+    qint64 nodeLimit;
+
+    /** @brief Largest evaluation offset in centipawns, from the skill level */
+    int evalNoise;
+
+    /** @brief Seed mixed into the evaluation noise hash */
+    quint64 noiseSeed;
+
+    /** @brief Source of the AI's random choices; securely seeded unless setRandomSeed() was called */
+    QRandomGenerator randomGenerator;
+
+    /** @brief Whether the current search stopped because it used up its node budget */
+    bool nodeLimitReached;
+
+    /** @brief Whether the current search stopped because it used up its time budget */
+    bool timeLimitReached;
+
+    /**
+     * @brief Gets the evaluation offset of a position
+     *
+     * @param key Zobrist hash of the position
+     * @return Offset between -evalNoise and evalNoise
+     */
+    int noiseFor(quint64 key) const;
+
+    /**
+     * @brief Converts a tablebase result to a search score
+     *
+     * Mates that end within MAX_PLY of the root get their usual score.
+     * Longer ones are scored just below the mate range, less the
+     * distance to mate, so they are not mistaken for mates found by the
+     * search yet still prefer the quicker win.
+     *
+     * @param wdl 1 if the side to move wins, 0 for a draw, -1 if it loses
+     * @param dtm Plies to mate from the position
+     * @param ply Distance of the position from the root
+     * @return Score from the side to move's perspective
+     */
+    static int tablebaseScore(int wdl, int dtm, int ply);
+
+    /**
+     * @brief Converts a Syzygy result to a search score
+     *
+     * Cursed wins and blessed losses are draws, since the fifty-move
+     * rule applies.
+     *
+     * @param wdl SyzygyTablebase::WdlScore for the side to move
+     * @return Score from the side to move's perspective
+     */
+    static int syzygyScore(int wdl);
     
     /**
      * @brief Implements the negamax algorithm with alpha-beta pruning
@@ -142,31 +860,195 @@ private:
      * Recursively evaluates positions by simulating moves and calculating
      * the best possible outcome assuming optimal play by both sides.
      * Alpha-beta pruning optimizes the search by skipping branches that
-     * won't affect the final decision.
+     * won't affect the final decision. With principal variation search,
+     * only the first move gets the full window; later moves are tested
+     * with a null window and re-searched if they turn out to be better.
+     * Before searching any move, null-move pruning lets the opponent move
+     * twice; if a reduced search still fails high, the node is cut off.
+     * Moves are ordered, and late quiet moves are searched at reduced depth
+     * or, close to the leaves, skipped altogether, as are captures that lose
+     * too much material by static exchange evaluation. Near the leaves, nodes
+     * whose static evaluation is far above beta or below alpha are pruned
+     * (reverse futility pruning, razoring, futility pruning); the leaves
+     * themselves are resolved by quiescenceSearch().
+     * Repeated positions and positions past the fifty-move limit are draws,
+     * small endings are scored from the endgame tablebase, and with
+     * useSyzygy larger ones from the Syzygy tables right after a capture
+     * or pawn move.
+     * Mates are scored by their distance from the root, windows that can't
+     * be reached by any mate from this ply are cut off at once, and
+     * results are stored in and reused from the transposition table.
+     * Once the search has been stopped (see checkStop()), every node
+     * returns 0 without storing anything.
      *
      * @param gs Current game state
      * @param validMoves List of valid moves to consider
-     * @param depth Current search depth
+     * @param depth Remaining search depth
+     * @param ply Distance from the root (0 at the root)
      * @param alpha Alpha value for pruning
      * @param beta Beta value for pruning
      * @param turnMultiplier 1 for white, -1 for black (for score negation)
+     * @param allowNullMove False right after a null move, so two are never made in a row
      * @return Score of the best move found
      */
     int findMoveNegaMaxAlphaBeta(GameState* gs, const QVector<Move>& validMoves,
-                                int depth, int alpha, int beta, int turnMultiplier);
+                                int depth, int ply, int alpha, int beta, int turnMultiplier,
+                                bool allowNullMove = true);
     
     /**
      * @brief Evaluates the current board position
      *
      * Assigns a score to the current board state by considering:
      * 1. Material value of all pieces
-     * 2. Positional value of pieces based on their location
-     * 3. Game-ending conditions (checkmate, stalemate)
+     * 2. Positional value of pieces based on their location, tapered
+     *    between midgame and endgame by the game phase
+     * 3. Pawn structure and king pawn shields, from the pawn hash table
+     * 4. Material imbalance and endgame knowledge, from the material hash table
+     * 5. Mobility, king-zone attacks and hanging pieces, from the attack maps
+     * 6. Game-ending conditions (checkmate, stalemate)
+     *
+     * When the position has a network attached (see nnueActive()), terms
+     * 1-5 are replaced by the network output, except in endings the
+     * material table recognises.
      *
      * @param gs Current game state to evaluate
-     * @return Score from white's perspective (positive is good for white)
+     * @return Score in centipawns from white's perspective (positive is good for white)
      */
     int scoreBoard(GameState* gs);
+
+    /**
+     * @brief Evaluates a position, using the evaluation cache when possible
+     *
+     * The search calls this instead of scoreBoard(), so positions reached
+     * again through transpositions or re-searches are not evaluated twice.
+     *
+     * @param gs Current game state to evaluate
+     * @return Score in centipawns from white's perspective, within +-MAX_EVAL
+     *         unless the position is checkmate
+     */
+    int evaluate(GameState* gs);
+
+    /**
+     * @brief Checks the stop flag every STOP_CHECK_INTERVAL nodes
+     *
+     * Called on entry to every node. Once the flag has been seen, every
+     * node returns at once and the search unwinds to the root. A search
+     * also stops here once its time budget is used up and an iteration
+     * beyond DEPTH is under way; a ponder search only after its ponder hit.
+     *
+     * @return True if the search must stop
+     */
+    bool checkStop();
+
+    /**
+     * @brief Checks whether a ponder search is still waiting for its predicted move
+     * @return True while pondering and ponderHit() has not been called for the request
+     */
+    bool waitingForPonderHit() const;
+
+    /**
+     * @brief Emits the move of a ponder search that finished before its ponder hit
+     *
+     * Queued onto the AI's thread by ponderHit(); does nothing unless a
+     * move is held for the request and the request was not aborted.
+     *
+     * @param requestId Identifier passed to ponder()
+     */
+    void releaseHeldMove(int requestId);
+
+    /**
+     * @brief Brings the AI's position up to date with the game
+     *
+     * Takes back the moves the game no longer shares, then plays the new
+     * ones, and fills positionMoves with the legal moves of the result.
+     *
+     * @param update Moves played since the last request
+     * @return True if every new move was legal in the AI's position
+     */
+    bool syncPosition(const PositionUpdate& update);
+
+    /**
+     * @brief Shuffles moves so that equal scores don't always pick the same one
+     *
+     * @param moves Moves to shuffle
+     * @return The moves in random order
+     */
+    QVector<Move> shuffleMoves(const QVector<Move>& moves);
+
+    /**
+     * @brief Gets the opponent's expected reply to a move
+     *
+     * Reads the second move of the principal variation from the
+     * transposition table entry of the position after the move.
+     *
+     * @param gs Game state the move is played in (restored before returning)
+     * @param move Move to find the reply to
+     * @return The expected reply, or an empty move if none is known
+     */
+    Move expectedReply(GameState* gs, const Move& move);
+
+    /**
+     * @brief Searches captures until the position is quiet
+     *
+     * Called at the leaves of the main search so that they are not scored
+     * in the middle of an exchange. The side to move may stand pat on the
+     * static evaluation, or try captures and promotions; when in check, all
+     * evasions are searched instead. Captures that lose material by static
+     * exchange evaluation, or cannot bring the score near alpha even with
+     * deltaMargin added, are skipped.
+     *
+     * @param gs Current game state
+     * @param validMoves Legal moves of the current position
+     * @param ply Distance from the root
+     * @param alpha Alpha value for pruning
+     * @param beta Beta value for pruning
+     * @param turnMultiplier 1 for white, -1 for black (for score negation)
+     * @return Score of the position for the side to move
+     */
+    int quiescenceSearch(GameState* gs, const QVector<Move>& validMoves,
+                         int ply, int alpha, int beta, int turnMultiplier);
+
+    /**
+     * @brief Orders moves so that the most promising are searched first
+     *
+     * The transposition table move comes first. Captures and promotions
+     * that don't lose material by static exchange come next, most
+     * valuable victim and then least valuable attacker first. Then come
+     * the killer moves of this ply, then the remaining quiet moves by
+     * history score, and finally the losing captures.
+     * The result lives in orderedMoveStack[ply] until the next call for
+     * the same ply.
+     *
+     * @param gs Current game state
+     * @param moves Moves to order
+     * @param ply Distance from the root, used to look up killer moves
+     * @param hashMove moveID of the transposition table move, searched first (0 for none)
+     * @param tacticalOnly Leave out moves that are neither captures nor promotions
+     * @return The moves in search order
+     */
+    const QVector<Move>& orderMoves(GameState* gs, const QVector<Move>& moves, int ply,
+                                    int hashMove = 0, bool tacticalOnly = false);
+
+    /**
+     * @brief Checks whether a move is a killer move at the given ply
+     *
+     * @param move The move to check
+     * @param ply Distance from the root
+     * @return True if the move is one of the ply's two killer moves
+     */
+    bool isKillerMove(const Move& move, int ply) const;
+
+    /**
+     * @brief Records a quiet move that caused a beta cutoff
+     *
+     * Makes the move the first killer of its ply and raises its history score.
+     *
+     * @param gs Current game state (the side to move made the move)
+     * @param move The quiet move that caused the cutoff
+     * @param depth Remaining depth of the node
+     * @param ply Distance from the root
+     */
+    void updateQuietMoveStats(GameState* gs, const Move& move, int depth, int ply);
     
     /**
      * @brief Validates if a move is in the list of valid moves
@@ -179,16 +1061,82 @@ private:
      */
     bool isValidMove(const Move& move, const QVector<Move>& validMoves);
 
+    /**
+     * @brief Reports a completed iteration
+     *
+     * Builds a SearchInfo only if searchInfoReady() is connected or the
+     * search log is open, so a search nobody watches stays allocation-free.
+     *
+     * @param gs Game state at the root
+     * @param depth Depth of the iteration
+     * @param score Score of the iteration
+     * @param branchingFactor Nodes of the iteration divided by nodes of the previous one
+     */
+    void reportIteration(GameState* gs, int depth, int score, double branchingFactor);
+
+    /**
+     * @brief Reads the principal variation from the transposition table
+     *
+     * Starts with the given root move and follows the stored best moves
+     * while they are legal, stopping at a repeated position.
+     *
+     * @param gs Game state at the root (restored before returning)
+     * @param firstMove Root move the variation starts with
+     * @param maxLength Greatest number of moves to return
+     * @return The principal variation
+     */
+    QVector<Move> principalVariation(GameState* gs, const Move& firstMove, int maxLength);
+
+    /**
+     * @brief Records the lines of a completed MultiPV iteration in analysisLines
+     *
+     * @param gs Game state at the root (restored before returning)
+     * @param lineCount Number of lines; their moves lead rootMoveBuffer, best first
+     * @param depth Depth of the iteration, the greatest length of each variation
+     */
+    void recordAnalysisLines(GameState* gs, int lineCount, int depth);
+
+    /**
+     * @brief Appends a report to the search log as one line of JSON
+     *
+     * @param info The report to write
+     */
+    void writeSearchLog(const SearchInfo& info);
+
 signals:
     /**
      * @brief Signal emitted when the best move has been found
      *
      * This signal is emitted by findBestMove() when the search is complete.
-     * It carries the best move found by the AI.
+     * It carries the best move found by the AI, the reply the AI expects
+     * to it (the move to ponder on), and the identifier of the request,
+     * so that the receiver can ignore results it no longer wants.
+     * Aborted requests don't emit it.
      *
      * @param move The best move found by the AI
+     * @param ponderMove The expected reply, or an empty move if none is known
+     * @param requestId Identifier passed to findBestMove() or ponder()
+     */
+    void findBestMoveFinished(Move move, Move ponderMove, int requestId);
+
+    /**
+     * @brief Signal emitted after every completed search iteration
+     *
+     * Carries the statistics of the search so far, for analysis displays
+     * and performance tracking. Iterations thrown away because the search
+     * was stopped are not reported.
+     *
+     * @param info The report on the iteration
+     */
+    void searchInfoReady(SearchInfo info);
+
+    /**
+     * @brief Signal emitted by analyze() when its search is complete
+     *
+     * @param lines The best moves with their scores and variations, best first
+     * @param requestId Identifier passed to analyze()
      */
-    void findBestMoveFinished(Move move);
+    void analysisFinished(QVector<AnalysisLine> lines, int requestId);
 };
 
 #endif // CHESSAI_H
\ No newline at end of file
@@ -11,6 +11,9 @@
  */
 Q_DECLARE_METATYPE(Move)
 Q_DECLARE_METATYPE(QVector<Move>)
+Q_DECLARE_METATYPE(PositionUpdate)
+Q_DECLARE_METATYPE(SearchInfo)
+Q_DECLARE_METATYPE(QVector<AnalysisLine>)
 
 /**
  * @brief Constructor for the ChessBoard class
@@ -25,6 +28,9 @@ ChessBoard::ChessBoard(QWidget *parent) : QWidget(parent) {
     // Register Move type for thread communication
     qRegisterMetaType<Move>("Move");
     qRegisterMetaType<QVector<Move>>("QVector<Move>");
+    qRegisterMetaType<PositionUpdate>("PositionUpdate");
+    qRegisterMetaType<SearchInfo>("SearchInfo");
+    qRegisterMetaType<QVector<AnalysisLine>>("QVector<AnalysisLine>");
     
     // Set fixed size for the widget
     setFixedSize(BOARD_SIZE + MOVE_LOG_PANEL_WIDTH, BOARD_SIZE);
@@ -42,9 +48,13 @@ ChessBoard::ChessBoard(QWidget *parent) : QWidget(parent) {
     selectedSquare = QPoint(-1, -1);
     gameOver = false;
     aiThinking = false;
+    aiPending = false;
     moveUndone = false;
     humanVsAi = false;
     humanPlaysWhite = true;
+    ponderEnabled = true;
+    aiPondering = false;
+    aiRequestId = 0;
     
     // Initialize mutex for thread safety
     stateMutex = new QMutex();
@@ -69,11 +79,31 @@ ChessBoard::ChessBoard(QWidget *parent) : QWidget(parent) {
 
     // Setup AI
     ai = new ChessAI();
+    if (qEnvironmentVariableIsSet("CHESSGAME_SEARCH_LOG")) {
+        ai->setSearchLogFile(qEnvironmentVariable("CHESSGAME_SEARCH_LOG"));
+    }
+    if (qEnvironmentVariableIsSet("CHESSGAME_SEED")) {
+        ai->setRandomSeed(qEnvironmentVariable("CHESSGAME_SEED").toUInt());
+    }
+    if (qEnvironmentVariableIsSet("CHESSGAME_SYZYGY_PATH")) {
+        ai->setSyzygyPath(qEnvironmentVariable("CHESSGAME_SYZYGY_PATH"));
+    }
+    if (qEnvironmentVariableIsSet("CHESSGAME_SYZYGY_PIECES")) {
+        ai->setSyzygyMaxPieces(qEnvironmentVariable("CHESSGAME_SYZYGY_PIECES").toInt());
+    }
+    if (qEnvironmentVariableIsSet("CHESSGAME_SYZYGY_SEARCH")) {
+        ai->useSyzygy = true;
+    }
     ai->moveToThread(&aiThread);
     
     // Use explicit queued connections for cross-thread signals
     connect(this, &ChessBoard::findAIMove, ai, &ChessAI::findBestMove, Qt::QueuedConnection);
+    connect(this, &ChessBoard::ponderAIMove, ai, &ChessAI::ponder, Qt::QueuedConnection);
+    connect(this, &ChessBoard::skillLevelChanged, ai, &ChessAI::setSkillLevel, Qt::QueuedConnection);
     connect(ai, &ChessAI::findBestMoveFinished, this, &ChessBoard::handleAIMove, Qt::QueuedConnection);
+
+    // Build the small endgame tables on the AI thread before its first search
+    QMetaObject::invokeMethod(ai, &ChessAI::prepareTablebases, Qt::QueuedConnection);
     
     aiThread.start(QThread::HighPriority);
 }
@@ -82,17 +112,21 @@ ChessBoard::ChessBoard(QWidget *parent) : QWidget(parent) {
  * @brief Destructor for the ChessBoard class
  * 
  * Cleans up allocated resources and ensures the AI thread
- * is properly terminated before destruction.
+ * is properly terminated before destruction. A search or endgame
+ * table build in progress is stopped first so that the thread can
+ * finish quickly.
  */
 ChessBoard::~ChessBoard() {
+    // Stop the AI search, any table build and the thread before deleting what they use
+    ai->abortSearch(aiRequestId);
+    ai->stopTablebaseBuild();
+    aiThread.quit();
+    aiThread.wait();
+
     // Clean up
     delete gs;
     delete ai;
     delete stateMutex;
-
-    // Stop the AI thread
-    aiThread.quit();
-    aiThread.wait();
 }
 
 /**
@@ -123,7 +157,7 @@ void ChessBoard::resetGame() {
     QMutexLocker locker(stateMutex);
     
     // Cancel any AI move in progress
-    aiThinking = false;
+    cancelAIMove();
     
     // Create a new game state
     delete gs;
@@ -151,19 +185,7 @@ void ChessBoard::resetGame() {
     
     // If in human vs AI mode and AI goes first, trigger AI move with a delay
     if (humanVsAi && !humanPlaysWhite && gs->whiteToMove) {
-        QTimer::singleShot(500, this, [this]() {
-            QMutexLocker locker(stateMutex);
-            if (!gameOver && !aiThinking) {
-                aiThinking = true;
-                // Create a copy of the current state for the AI to use
-                GameState* stateCopy = new GameState(*gs);
-                QVector<Move> movesCopy = validMoves;
-                
-                // Queue up the AI move calculation
-                emit findAIMove(stateCopy, movesCopy);
-                update(); // Force UI update to show AI is thinking
-            }
-        });
+        scheduleAIMove();
     }
 }
 
@@ -171,6 +193,7 @@ void ChessBoard::resetGame() {
  * @brief Sets the game mode to Human vs AI or Human vs Human
  * 
  * Configures the game mode and triggers an AI move if needed.
+ * Changing the mode or color cancels the AI move in progress.
  * This method is thread-safe.
  * 
  * @param enabled True to enable Human vs AI mode, false for Human vs Human
@@ -178,29 +201,35 @@ void ChessBoard::resetGame() {
  */
 void ChessBoard::setHumanVsAI(bool enabled, bool humanWhite) {
     QMutexLocker locker(stateMutex);
+
+    // The AI may no longer play, or may now play the other side
+    if (enabled != humanVsAi || humanWhite != humanPlaysWhite) {
+        cancelAIMove();
+    }
     
     humanVsAi = enabled;
     humanPlaysWhite = humanWhite;
 
     // If AI's turn, trigger AI move with a delay
     if (humanVsAi && ((gs->whiteToMove && !humanPlaysWhite) || (!gs->whiteToMove && humanPlaysWhite))) {
-        if (!aiThinking && !gameOver) {
-            QTimer::singleShot(500, this, [this]() {
-                QMutexLocker locker(stateMutex);
-                if (!gameOver && !aiThinking) {
-                    aiThinking = true;
-                    // Create a copy of the current state for the AI to use
-                    GameState* stateCopy = new GameState(*gs);
-                    QVector<Move> movesCopy = validMoves;
-                    
-                    emit findAIMove(stateCopy, movesCopy);
-                    update(); // Force UI update
-                }
-            });
+        if (!aiThinking && !aiPending && !gameOver) {
+            scheduleAIMove();
         }
     }
 }
 
+/**
+ * @brief Sets how strongly the AI plays
+ *
+ * The level is queued to the AI thread like a search request, so it
+ * never changes in the middle of a search.
+ *
+ * @param level Level from 1 (weakest) to ChessAI::MAX_SKILL_LEVEL (full strength)
+ */
+void ChessBoard::setSkillLevel(int level) {
+    emit skillLevelChanged(level);
+}
+
 /**
  * @brief Handles painting of the chess board and its elements
  * 
@@ -250,7 +279,7 @@ void ChessBoard::paintEvent(QPaintEvent* event) {
 void ChessBoard::mousePressEvent(QMouseEvent* event) {
     QMutexLocker locker(stateMutex);
     
-    if (event->button() != Qt::LeftButton || gameOver || aiThinking) return;
+    if (event->button() != Qt::LeftButton || gameOver || aiThinking || aiPending) return;
 
     int col = event->pos().x() / SQ_SIZE;
     int row = event->pos().y() / SQ_SIZE;
@@ -296,27 +325,27 @@ void ChessBoard::mousePressEvent(QMouseEvent* event) {
                         playerClicks.clear();
 
                         validMoves = gs->getValidMoves();
-                        gameOver = gs->checkmate || gs->stalemate;
+                        gameOver = gs->checkmate || gs->stalemate || gs->draw;
 
                         animateMove(validMove); 
 
+                        // A ponder search that guessed this move becomes the AI's search
+                        bool ponderHit = aiPondering && !gameOver &&
+                                         validMove.moveID == predictedHumanMove.moveID;
+                        if (ponderHit) {
+                            aiPondering = false;
+                            aiThinking = true;
+                            ai->ponderHit(aiRequestId);
+                        } else if (aiPondering) {
+                            cancelAIMove();
+                        }
+
                         // If it's now AI's turn
-                        if (humanVsAi && !gameOver && 
+                        if (!ponderHit && humanVsAi && !gameOver && 
                            ((gs->whiteToMove && !humanPlaysWhite) ||
                             (!gs->whiteToMove && humanPlaysWhite))) 
                         {
-                            QTimer::singleShot(500, this, [this]() {
-                                QMutexLocker locker(stateMutex);
-                                if (!gameOver && !aiThinking) {
-                                    aiThinking = true;
-                                    // Create a copy of the current state for the AI
-                                    GameState* stateCopy = new GameState(*gs);
-                                    QVector<Move> movesCopy = validMoves;
-                                    
-                                    emit findAIMove(stateCopy, movesCopy);
-                                    update();
-                                }
-                            });
+                            scheduleAIMove();
                         }
                     } else {
                         // Keep the second click as the new first click
@@ -342,20 +371,20 @@ void ChessBoard::mousePressEvent(QMouseEvent* event) {
 void ChessBoard::keyPressEvent(QKeyEvent* event) {
     // Undo move (Z key)
     if (event->key() == Qt::Key_Z) {
+        QMutexLocker locker(stateMutex);
+
+        // While the AI is thinking, or about to, it hasn't moved yet, so only the human move is taken back
+        bool aiWasThinking = aiThinking || aiPending;
+        cancelAIMove();
+
         gs->undoMove();
-        if (humanVsAi) {
+        if (humanVsAi && !aiWasThinking) {
             // Undo both human and AI moves
             gs->undoMove();
         }
         moveMade = true;
         animate = false;
         gameOver = false;
-        if (aiThinking) {
-            // Cancel AI move by setting flag
-            aiThinking = false;
-            // Note: A more robust solution would use a request ID system to ignore pending AI moves
-            // but that would require changes to the signal/slot mechanism
-        }
         moveUndone = true;
         // Recalculate valid moves after undoing
         validMoves = gs->getValidMoves();
@@ -515,8 +544,8 @@ void ChessBoard::drawMoveLog(QPainter& painter) {
 /**
  * @brief Draws the endgame message when the game is over
  * 
- * Displays a message indicating checkmate or stalemate
- * with a shadow effect for better visibility.
+ * Displays a message indicating checkmate, stalemate or a draw
+ * by repetition or the fifty-move rule, with a shadow effect for better visibility.
  * 
  * @param painter The QPainter to use for drawing
  */
@@ -526,6 +555,8 @@ void ChessBoard::drawEndgameText(QPainter& painter) {
         text = gs->whiteToMove ? "Black wins by checkmate!" : "White wins by checkmate!";
     } else if (gs->stalemate) {
         text = "Stalemate";
+    } else if (gs->draw) {
+        text = (gs->halfmoveClock >= 100) ? "Draw by fifty-move rule" : "Draw by repetition";
     }
 
     if (!text.isEmpty()) {
@@ -549,6 +580,129 @@ void ChessBoard::drawEndgameText(QPainter& painter) {
     }
 }
 
+/**
+ * @brief Asks the AI for a move in the current position
+ * 
+ * Sends the moves played since the last request to the AI thread
+ * under a new request identifier. The caller must hold stateMutex.
+ */
+void ChessBoard::requestAIMove() {
+    if (gameOver || aiThinking) {
+        return;
+    }
+    aiThinking = true;
+
+    // Queue up the AI move calculation
+    emit findAIMove(aiPositionUpdate(), ++aiRequestId);
+    update(); // Force UI update to show AI is thinking
+}
+
+/**
+ * @brief Asks the AI for a move after a short delay
+ *
+ * The delay lets the last move's animation play first. Until the request
+ * is sent, aiPending counts as the AI thinking; cancelAIMove() drops the
+ * scheduled request. The caller must hold stateMutex.
+ */
+void ChessBoard::scheduleAIMove() {
+    aiPending = true;
+    int requestId = aiRequestId;
+    QTimer::singleShot(500, this, [this, requestId]() {
+        QMutexLocker locker(stateMutex);
+        // Skip the request if it was cancelled while waiting
+        if (requestId == aiRequestId) {
+            aiPending = false;
+            requestAIMove();
+        }
+    });
+}
+
+/**
+ * @brief Cancels the AI move in progress and any delayed request
+ * 
+ * Aborts every request issued so far and moves to a new identifier,
+ * so that both the running search's result and delayed requests
+ * scheduled before the cancellation are ignored. The caller must hold
+ * stateMutex.
+ */
+void ChessBoard::cancelAIMove() {
+    ai->abortSearch(aiRequestId);
+    aiRequestId++;
+    aiThinking = false;
+    aiPending = false;
+    aiPondering = false;
+}
+
+/**
+ * @brief Starts searching the position after the human's expected move
+ * 
+ * The AI's position is brought up to the one after the expected move.
+ * The caller must hold stateMutex.
+ * 
+ * @param expectedMove The human move predicted by the AI
+ */
+void ChessBoard::startPondering(const Move& expectedMove) {
+    if (!ponderEnabled || !humanVsAi || gameOver || aiThinking || aiPondering) {
+        return;
+    }
+
+    // Only ponder on a move the human can actually make
+    bool isMoveValid = false;
+    for (const Move& validMove : validMoves) {
+        if (expectedMove.moveID != 0 && validMove.moveID == expectedMove.moveID) {
+            isMoveValid = true;
+            predictedHumanMove = validMove;
+            break;
+        }
+    }
+    if (!isMoveValid) {
+        return;
+    }
+
+    // Nothing to search if the expected move ends the game
+    gs->makeMove(predictedHumanMove);
+    bool gameEnds = gs->getValidMoves().isEmpty();
+    gs->undoMove();
+    gs->getValidMoves();  // Restores the checkmate and stalemate flags
+    if (gameEnds) {
+        return;
+    }
+
+    aiPondering = true;
+    emit ponderAIMove(aiPositionUpdate(predictedHumanMove), ++aiRequestId);
+}
+
+/**
+ * @brief Gets the moves that bring the AI's position up to date
+ * 
+ * Compares the game's moves with the ones last sent to the AI; the
+ * moves they share are kept and everything after them is sent again.
+ * The caller must hold stateMutex.
+ * 
+ * @param extraMove Move to play after the game's moves, or an empty move for none
+ * @return PositionUpdate The update to send with the next request
+ */
+PositionUpdate ChessBoard::aiPositionUpdate(const Move& extraMove) {
+    QVector<int> gameMoves;
+    gameMoves.reserve(gs->moveLog.size() + 1);
+    for (const Move& move : gs->moveLog) {
+        gameMoves.append(move.moveID);
+    }
+    if (extraMove.moveID != 0) {
+        gameMoves.append(extraMove.moveID);
+    }
+
+    PositionUpdate update;
+    while (update.keptMoves < aiPositionMoves.size() && update.keptMoves < gameMoves.size() &&
+           aiPositionMoves[update.keptMoves] == gameMoves[update.keptMoves]) {
+        update.keptMoves++;
+    }
+    update.moveIds = gameMoves.mid(update.keptMoves);
+
+    aiPositionMoves = gameMoves;
+    return update;
+}
+
 /**
  * @brief Starts an animation for a chess piece move
  * 
@@ -613,7 +767,7 @@ void ChessBoard::updateAnimation() {
         moveMade = false;
         animate = false;
         moveUndone = false;
-        gameOver = gs->checkmate || gs->stalemate;
+        gameOver = gs->checkmate || gs->stalemate || gs->draw;
     }
 
     update();
@@ -627,10 +781,29 @@ void ChessBoard::updateAnimation() {
  * Handles error cases by selecting a fallback move if needed.
  * This method is thread-safe.
  * 
+ * Moves answering a cancelled or superseded request are ignored.
+ * Once the move is made, the AI starts pondering on the expected reply.
+ * 
  * @param move The move returned by the AI
+ * @param ponderMove The human reply the AI expects, to ponder on
+ * @param requestId Identifier of the request the move answers
  */
-void ChessBoard::handleAIMove(Move move) {
+void ChessBoard::handleAIMove(Move move, Move ponderMove, int requestId) {
     QMutexLocker locker(stateMutex);
+
+    // The position has changed since this move was requested
+    if (requestId != aiRequestId) {
+        qDebug() << "Ignoring stale AI move" << move.toString();
+        return;
+    }
+
+    // After a ponder hit the move can arrive while the human move is still animating
+    if (animationTimer->isActive()) {
+        QTimer::singleShot(animationTimer->interval(), this, [this, move, ponderMove, requestId]() {
+            handleAIMove(move, ponderMove, requestId);
+        });
+        return;
+    }
     
     // Check if we should still process this AI move
     if (aiThinking && !gameOver) {
@@ -660,7 +833,7 @@ void ChessBoard::handleAIMove(Move move) {
             
             // Recalculate valid moves
             validMoves = gs->getValidMoves();
-            gameOver = gs->checkmate || gs->stalemate;
+            gameOver = gs->checkmate || gs->stalemate || gs->draw;
         } else {
             qDebug() << "Warning: AI returned invalid move!";
             
@@ -670,12 +843,17 @@ void ChessBoard::handleAIMove(Move move) {
                 gs->makeMove(safeMove);
                 animateMove(safeMove);
                 validMoves = gs->getValidMoves();
-                gameOver = gs->checkmate || gs->stalemate;
+                gameOver = gs->checkmate || gs->stalemate || gs->draw;
             }
         }
         
         // AI thinking completed
         aiThinking = false;
+
+        // Use the human's thinking time
+        if (moveIsValid) {
+            startPondering(ponderMove);
+        }
         
         // Force update to show AI move immediately
         update();
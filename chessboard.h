@@ -88,7 +88,7 @@ public:
     QVector<QPoint> playerClicks;
     
     /**
-     * @brief Flag indicating if the game is over (checkmate or stalemate)
+     * @brief Flag indicating if the game is over (checkmate, stalemate or draw)
      */
     bool gameOver;
     
@@ -97,6 +97,11 @@ public:
      */
     bool aiThinking;
     
+    /**
+     * @brief Flag indicating if an AI request is scheduled but not sent yet
+     */
+    bool aiPending;
+
     /**
      * @brief Flag indicating if a move was just undone
      */
@@ -112,6 +117,21 @@ public:
      */
     bool humanPlaysWhite;
 
+    /**
+     * @brief Flag indicating if the AI searches on the human's time (default: true)
+     */
+    bool ponderEnabled;
+
+    /**
+     * @brief Flag indicating if the AI is searching the position after predictedHumanMove
+     */
+    bool aiPondering;
+
+    /**
+     * @brief Human move the AI expects, and is pondering on
+     */
+    Move predictedHumanMove;
+
     /**
      * @brief AI engine for computer player
      */
@@ -122,6 +142,28 @@ public:
      */
     QThread aiThread;
 
+    /**
+     * @brief Mutex guarding the game state against concurrent UI callbacks
+     */
+    QMutex* stateMutex;
+
+    /**
+     * @brief Identifier of the latest AI request
+     *
+     * Incremented for every findAIMove() request and whenever pending
+     * requests are cancelled; results and delayed requests carrying an
+     * older identifier are ignored.
+     */
+    int aiRequestId;
+
+    /**
+     * @brief moveIDs of the moves the AI's own position has been sent
+     *
+     * Mirrors the AI's position, so that each request only sends the
+     * moves that differ from it.
+     */
+    QVector<int> aiPositionMoves;
+
     /**
      * @brief Map of piece identifiers to their images
      *
@@ -195,6 +237,15 @@ public:
      */
     void setHumanVsAI(bool enabled, bool humanWhite);
 
+    /**
+     * @brief Sets how strongly the AI plays
+     *
+     * The AI picks the level up from its next search.
+     *
+     * @param level Level from 1 (weakest) to ChessAI::MAX_SKILL_LEVEL (full strength)
+     */
+    void setSkillLevel(int level);
+
 protected:
     /**
      * @brief Handles painting of the chess board and its elements
@@ -272,7 +323,7 @@ private:
     /**
      * @brief Draws the endgame message when the game is over
      *
-     * Displays a message indicating checkmate or stalemate.
+     * Displays a message indicating checkmate, stalemate or a draw.
      *
      * @param painter The QPainter to use for drawing
      */
@@ -299,6 +350,52 @@ private:
      */
     void drawAnimatedMove(QPainter& painter);
 
+    /**
+     * @brief Asks the AI for a move in the current position
+     *
+     * Does nothing if the game is over or the AI is already thinking.
+     * The caller must hold stateMutex.
+     */
+    void requestAIMove();
+
+    /**
+     * @brief Asks the AI for a move after a short delay
+     *
+     * Sets aiPending until the request is sent. The caller must hold stateMutex.
+     */
+    void scheduleAIMove();
+
+    /**
+     * @brief Cancels the AI move in progress and any delayed request
+     *
+     * Stops the AI search within a few milliseconds; its result, if
+     * one is already on the way, is ignored. The caller must hold stateMutex.
+     */
+    void cancelAIMove();
+
+    /**
+     * @brief Starts searching the position after the human's expected move
+     *
+     * Called once the AI's move has been made. Does nothing unless
+     * pondering is enabled and the expected move is legal. If the human
+     * then plays it, the running search is told so and answers at once;
+     * any other move cancels it. The caller must hold stateMutex.
+     *
+     * @param expectedMove The human move predicted by the AI
+     */
+    void startPondering(const Move& expectedMove);
+
+    /**
+     * @brief Gets the moves that bring the AI's position up to date
+     *
+     * The AI's position is assumed to follow the update from now on.
+     * The caller must hold stateMutex.
+     *
+     * @param extraMove Move to play after the game's moves, or an empty move for none
+     * @return The moves the AI's position shares with the game and the ones after them
+     */
+    PositionUpdate aiPositionUpdate(const Move& extraMove = Move());
+
 private slots:
     /**
      * @brief Updates the animation state for each frame
@@ -315,20 +412,37 @@ private slots:
      * applies it to the game state, and updates the UI.
      *
      * @param move The move returned by the AI
+     * @param ponderMove The human reply the AI expects, to ponder on
+     * @param requestId Identifier of the request the move answers
      */
-    void handleAIMove(Move move);
+    void handleAIMove(Move move, Move ponderMove, int requestId);
 
 signals:
     /**
      * @brief Signal to request the AI to find a move
      *
      * Emitted when it's the AI's turn to move. The AI engine
-     * will receive the current game state and valid moves.
+     * will receive the moves played since its last request.
+     *
+     * @param update Moves that bring the AI's position up to the current one
+     * @param requestId Identifier of the request, returned with the AI's move
+     */
+    void findAIMove(PositionUpdate update, int requestId);
+
+    /**
+     * @brief Signal to let the AI search while the human is thinking
+     *
+     * @param update Moves that bring the AI's position up to the one after the human move it expects
+     * @param requestId Identifier of the request, returned with the AI's move on a ponder hit
+     */
+    void ponderAIMove(PositionUpdate update, int requestId);
+
+    /**
+     * @brief Signal to change the AI's skill level between searches
      *
-     * @param gs The current game state
-     * @param validMoves List of valid moves for the current position
+     * @param level Level from 1 to ChessAI::MAX_SKILL_LEVEL
      */
-    void findAIMove(GameState* gs, QVector<Move> validMoves);
+    void skillLevelChanged(int level);
 };
 
 #endif // CHESSBOARD_H
\ No newline at end of file
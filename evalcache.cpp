@@ -0,0 +1,82 @@
+#include "evalcache.h"
+
+/**
+ * @brief Constructor for the EvalCache class
+ *
+ * Allocates all entries up front so that probing never allocates.
+ */
+EvalCache::EvalCache() : entries(SIZE, Entry{0, 0}), probeCount(0), hitCount(0) {
+}
+
+/**
+ * @brief Looks up the evaluation of a position
+ *
+ * @param key Zobrist hash of the position
+ * @param score Receives the cached score on a hit
+ * @return True on a hit, false otherwise
+ */
+bool EvalCache::probe(quint64 key, int& score) {
+    probeCount++;
+    const Entry& entry = entries[static_cast<int>(key & (SIZE - 1))];
+    if (entry.key != key || key == 0) {
+        return false;
+    }
+    hitCount++;
+    score = entry.score;
+    return true;
+}
+
+/**
+ * @brief Stores the evaluation of a position, replacing its slot
+ *
+ * @param key Zobrist hash of the position
+ * @param score Score to cache
+ */
+void EvalCache::store(quint64 key, int score) {
+    Entry& entry = entries[static_cast<int>(key & (SIZE - 1))];
+    entry.key = key;
+    entry.score = score;
+}
+
+/**
+ * @brief Empties the cache and resets the statistics
+ */
+void EvalCache::clear() {
+    entries.fill(Entry{0, 0});
+    resetStatistics();
+}
+
+/**
+ * @brief Resets the probe and hit counters
+ */
+void EvalCache::resetStatistics() {
+    probeCount = 0;
+    hitCount = 0;
+}
+
+/**
+ * @brief Gets the number of probes since the statistics were reset
+ *
+ * @return qint64 Probe count
+ */
+qint64 EvalCache::probes() const {
+    return probeCount;
+}
+
+/**
+ * @brief Gets the number of hits since the statistics were reset
+ *
+ * @return qint64 Hit count
+ */
+qint64 EvalCache::hits() const {
+    return hitCount;
+}
+
+/**
+ * @brief Gets the fraction of probes that hit
+ *
+ * @return double Hit rate between 0 and 1 (0 if nothing was probed)
+ */
+double EvalCache::hitRate() const {
+    return (probeCount > 0) ? static_cast<double>(hitCount) / probeCount : 0.0;
+}
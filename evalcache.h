@@ -0,0 +1,96 @@
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @class EvalCache
+ * @brief Small lossy cache of static evaluations keyed by Zobrist hash
+ *
+ * The same leaf positions are evaluated again and again through
+ * transpositions and re-searches (PVS, LMR and iterative deepening).
+ * The cache is direct-mapped and a store always replaces the old entry,
+ * so it never grows and never needs maintenance.
+ *
+ * @author Group 69 (mittensOS)
+ */
+class EvalCache {
+public:
+    /** @brief Number of entries in the cache (a power of two) */
+    static const int SIZE = 65536;
+
+    /**
+     * @brief Constructor for the EvalCache class
+     */
+    EvalCache();
+
+    /**
+     * @brief Looks up the evaluation of a position
+     *
+     * @param key Zobrist hash of the position
+     * @param score Receives the cached score on a hit
+     * @return True on a hit, false otherwise
+     */
+    bool probe(quint64 key, int& score);
+
+    /**
+     * @brief Stores the evaluation of a position, replacing its slot
+     *
+     * @param key Zobrist hash of the position
+     * @param score Score to cache
+     */
+    void store(quint64 key, int score);
+
+    /**
+     * @brief Empties the cache and resets the statistics
+     */
+    void clear();
+
+    /**
+     * @brief Resets the probe and hit counters
+     */
+    void resetStatistics();
+
+    /**
+     * @brief Gets the number of probes since the statistics were reset
+     * @return Probe count
+     */
+    qint64 probes() const;
+
+    /**
+     * @brief Gets the number of hits since the statistics were reset
+     * @return Hit count
+     */
+    qint64 hits() const;
+
+    /**
+     * @brief Gets the fraction of probes that hit
+     * @return Hit rate between 0 and 1 (0 if nothing was probed)
+     */
+    double hitRate() const;
+
+private:
+    /**
+     * @struct Entry
+     * @brief One cached evaluation
+     */
+    struct Entry {
+        /** @brief Zobrist hash of the position, 0 for an empty slot */
+        quint64 key;
+
+        /** @brief Cached score */
+        int score;
+    };
+
+    /** @brief Cache entries, indexed by the low bits of the hash */
+    QVector<Entry> entries;
+
+    /** @brief Number of probes since the statistics were reset */
+    qint64 probeCount;
+
+    /** @brief Number of hits since the statistics were reset */
+    qint64 hitCount;
+};
+
+#endif // EVALCACHE_H
@@ -0,0 +1,308 @@
+#ifndef EVALTABLES_H
+#define EVALTABLES_H
+
+#include <cstdint>
+
+/**
+ * @file evaltables.h
+ * @brief Compile-time evaluation tables in centipawns
+ *
+ * Pieces are indexed color * 6 + type, with types ordered pawn, knight,
+ * bishop, rook, queen, king and white first. Squares are indexed
+ * row * 8 + col, where row 0 is the eighth rank, matching GameState::board.
+ * All values are signed: positive for white and negative for black, so a
+ * single running total holds the balance of the position.
+ *
+ * @author Group 69 (mittensOS)
+ */
+
+namespace EvalTables {
+
+/** @brief Number of piece types per color */
+constexpr int PIECE_TYPES = 6;
+
+/** @brief Number of pieces, both colors */
+constexpr int PIECES = 2 * PIECE_TYPES;
+
+/** @brief Number of squares on the board */
+constexpr int SQUARES = 64;
+
+/**
+ * @brief Material value of each piece type in centipawns
+ *
+ * Pawn 100, knight 300, bishop 300, rook 500, queen 900. The king is
+ * never captured, so it has no material value.
+ */
+constexpr std::int16_t PIECE_TYPE_VALUES[PIECE_TYPES] = {100, 300, 300, 500, 900, 0};
+
+/**
+ * @brief Midgame positional bonus of each piece type from white's point of view
+ *
+ * Row 0 is the eighth rank.
+ */
+constexpr std::int16_t WHITE_POSITION_MG[PIECE_TYPES][SQUARES] = {
+    {   // Pawns are valuable as they advance
+        80, 80, 80, 80, 80, 80, 80, 80,
+        70, 70, 70, 70, 70, 70, 70, 70,
+        30, 30, 40, 50, 50, 40, 30, 30,
+        25, 25, 30, 45, 45, 30, 25, 25,
+        20, 20, 20, 40, 40, 20, 20, 20,
+        25, 15, 10, 20, 20, 10, 15, 25,
+        25, 30, 30,  0,  0, 30, 30, 25,
+        20, 20, 20, 20, 20, 20, 20, 20
+    },
+    {   // Knights are more valuable in the center
+         0, 10, 20, 20, 20, 20, 10,  0,
+        10, 30, 50, 50, 50, 50, 30, 10,
+        20, 50, 60, 65, 65, 60, 50, 20,
+        20, 55, 65, 70, 70, 65, 55, 20,
+        20, 50, 65, 70, 70, 65, 50, 20,
+        20, 55, 60, 65, 65, 60, 55, 20,
+        10, 30, 50, 55, 55, 50, 30, 10,
+         0, 10, 20, 20, 20, 20, 10,  0
+    },
+    {   // Bishops prefer diagonals and open positions
+         0, 20, 20, 20, 20, 20, 20,  0,
+        20, 40, 40, 40, 40, 40, 40, 20,
+        20, 40, 50, 60, 60, 50, 40, 20,
+        20, 50, 50, 60, 60, 50, 50, 20,
+        20, 40, 60, 60, 60, 60, 40, 20,
+        20, 60, 60, 60, 60, 60, 60, 20,
+        20, 50, 40, 40, 40, 40, 50, 20,
+         0, 20, 20, 20, 20, 20, 20,  0
+    },
+    {   // Rooks prefer open files and the 7th rank
+        25, 25, 25, 25, 25, 25, 25, 25,
+        50, 75, 75, 75, 75, 75, 75, 50,
+         0, 25, 25, 25, 25, 25, 25,  0,
+         0, 25, 25, 25, 25, 25, 25,  0,
+         0, 25, 25, 25, 25, 25, 25,  0,
+         0, 25, 25, 25, 25, 25, 25,  0,
+         0, 25, 25, 25, 25, 25, 25,  0,
+        25, 25, 25, 50, 50, 25, 25, 25
+    },
+    {   // Queens should not be developed too early
+         0, 20, 20, 30, 30, 20, 20,  0,
+        20, 40, 40, 40, 40, 40, 40, 20,
+        20, 40, 50, 50, 50, 50, 40, 20,
+        30, 40, 50, 50, 50, 50, 40, 30,
+        40, 40, 50, 50, 50, 50, 40, 30,
+        20, 50, 50, 50, 50, 50, 40, 20,
+        20, 40, 50, 40, 40, 40, 40, 20,
+         0, 20, 20, 30, 30, 20, 20,  0
+    },
+    {   // Kings stay sheltered behind their pawns
+        -60, -70, -70, -80, -80, -70, -70, -60,
+        -60, -70, -70, -80, -80, -70, -70, -60,
+        -60, -70, -70, -80, -80, -70, -70, -60,
+        -60, -70, -70, -80, -80, -70, -70, -60,
+        -40, -50, -50, -60, -60, -50, -50, -40,
+        -20, -30, -30, -40, -40, -30, -30, -20,
+         10,  10, -10, -20, -20, -10,  10,  10,
+         20,  30,  10,   0,   0,  10,  30,  20
+    }
+};
+
+/**
+ * @brief Endgame positional bonus of each piece type from white's point of view
+ *
+ * Row 0 is the eighth rank. Pawns and kings differ most from the
+ * midgame tables.
+ */
+constexpr std::int16_t WHITE_POSITION_EG[PIECE_TYPES][SQUARES] = {
+    {   // Passed pawns decide endgames, so advancing is worth more
+          0,   0,   0,   0,   0,   0,   0,   0,
+        120, 120, 120, 120, 120, 120, 120, 120,
+         80,  80,  80,  80,  80,  80,  80,  80,
+         50,  50,  50,  50,  50,  50,  50,  50,
+         30,  30,  30,  30,  30,  30,  30,  30,
+         15,  15,  15,  15,  15,  15,  15,  15,
+          5,   5,   5,   5,   5,   5,   5,   5,
+          0,   0,   0,   0,   0,   0,   0,   0
+    },
+    {   // Knights are more valuable in the center
+         0, 10, 20, 20, 20, 20, 10,  0,
+        10, 30, 50, 50, 50, 50, 30, 10,
+        20, 50, 60, 65, 65, 60, 50, 20,
+        20, 55, 65, 70, 70, 65, 55, 20,
+        20, 50, 65, 70, 70, 65, 50, 20,
+        20, 55, 60, 65, 65, 60, 55, 20,
+        10, 30, 50, 55, 55, 50, 30, 10,
+         0, 10, 20, 20, 20, 20, 10,  0
+    },
+    {   // Bishops prefer diagonals and open positions
+         0, 20, 20, 20, 20, 20, 20,  0,
+        20, 40, 40, 40, 40, 40, 40, 20,
+        20, 40, 50, 60, 60, 50, 40, 20,
+        20, 50, 50, 60, 60, 50, 50, 20,
+        20, 40, 60, 60, 60, 60, 40, 20,
+        20, 60, 60, 60, 60, 60, 60, 20,
+        20, 50, 40, 40, 40, 40, 50, 20,
+         0, 20, 20, 20, 20, 20, 20,  0
+    },
+    {   // Rooks prefer open files and the 7th rank
+        25, 25, 25, 25, 25, 25, 25, 25,
+        50, 75, 75, 75, 75, 75, 75, 50,
+         0, 25, 25, 25, 25, 25, 25,  0,
+         0, 25, 25, 25, 25, 25, 25,  0,
+         0, 25, 25, 25, 25, 25, 25,  0,
+         0, 25, 25, 25, 25, 25, 25,  0,
+         0, 25, 25, 25, 25, 25, 25,  0,
+        25, 25, 25, 50, 50, 25, 25, 25
+    },
+    {   // Queens should not be developed too early
+         0, 20, 20, 30, 30, 20, 20,  0,
+        20, 40, 40, 40, 40, 40, 40, 20,
+        20, 40, 50, 50, 50, 50, 40, 20,
+        30, 40, 50, 50, 50, 50, 40, 30,
+        40, 40, 50, 50, 50, 50, 40, 30,
+        20, 50, 50, 50, 50, 50, 40, 20,
+        20, 40, 50, 40, 40, 40, 40, 20,
+         0, 20, 20, 30, 30, 20, 20,  0
+    },
+    {   // Kings become active pieces and head for the center
+        -50, -30, -30, -30, -30, -30, -30, -50,
+        -30, -10,   0,   0,   0,   0, -10, -30,
+        -30,   0,  20,  30,  30,  20,   0, -30,
+        -30,   0,  30,  40,  40,  30,   0, -30,
+        -30,   0,  30,  40,  40,  30,   0, -30,
+        -30,   0,  20,  30,  30,  20,   0, -30,
+        -30, -10,   0,   0,   0,   0, -10, -30,
+        -50, -30, -30, -30, -30, -30, -30, -50
+    }
+};
+
+/**
+ * @brief Game phase weight of each piece type
+ *
+ * Knights and bishops count 1, rooks 2 and queens 4, so the starting
+ * position has TOTAL_PHASE. Pawns and kings don't count.
+ */
+constexpr int PIECE_TYPE_PHASES[PIECE_TYPES] = {0, 1, 1, 2, 4, 0};
+
+/** @brief Game phase of the starting position (pure midgame) */
+constexpr int TOTAL_PHASE = 24;
+
+/**
+ * @brief Packs a midgame and an endgame score into one integer
+ *
+ * The endgame half lives in the upper 16 bits, so packed scores can be
+ * added and subtracted as plain integers.
+ *
+ * @param mg Midgame score
+ * @param eg Endgame score
+ * @return The packed score
+ */
+constexpr int makeScore(int mg, int eg) {
+    return eg * 65536 + mg;
+}
+
+/**
+ * @brief Extracts the midgame half of a packed score
+ *
+ * @param score Packed score
+ * @return The midgame score
+ */
+constexpr int mgValue(int score) {
+    return static_cast<std::int16_t>(static_cast<std::uint16_t>(static_cast<unsigned>(score)));
+}
+
+/**
+ * @brief Extracts the endgame half of a packed score
+ *
+ * @param score Packed score
+ * @return The endgame score
+ */
+constexpr int egValue(int score) {
+    return static_cast<std::int16_t>(static_cast<std::uint16_t>(static_cast<unsigned>(score + 0x8000) >> 16));
+}
+
+/**
+ * @brief Interpolates a packed score between midgame and endgame
+ *
+ * @param score Packed score
+ * @param phase Game phase, TOTAL_PHASE for the midgame down to 0 for a bare endgame
+ * @return The tapered score
+ */
+constexpr int taper(int score, int phase) {
+    return (mgValue(score) * phase + egValue(score) * (TOTAL_PHASE - phase)) / TOTAL_PHASE;
+}
+
+/**
+ * @brief Signed values for every piece, indexed [piece] or [piece][square]
+ */
+struct PieceTables {
+    /** @brief Material value of each piece */
+    std::int16_t material[PIECES];
+
+    /** @brief Packed midgame/endgame positional bonus of each piece on each square */
+    int position[PIECES][SQUARES];
+
+    /** @brief Game phase weight of each piece */
+    int phase[PIECES];
+};
+
+/**
+ * @brief Builds the signed tables for both colors
+ *
+ * Black's entries are the negated white entries of the square mirrored
+ * across the middle of the board (square ^ 56 flips the row).
+ *
+ * @return The tables for all twelve pieces
+ */
+constexpr PieceTables buildPieceTables() {
+    PieceTables tables{};
+    for (int type = 0; type < PIECE_TYPES; type++) {
+        tables.material[type] = PIECE_TYPE_VALUES[type];
+        tables.material[type + PIECE_TYPES] = static_cast<std::int16_t>(-PIECE_TYPE_VALUES[type]);
+        tables.phase[type] = PIECE_TYPE_PHASES[type];
+        tables.phase[type + PIECE_TYPES] = PIECE_TYPE_PHASES[type];
+        for (int square = 0; square < SQUARES; square++) {
+            int mg = WHITE_POSITION_MG[type][square];
+            int eg = WHITE_POSITION_EG[type][square];
+            tables.position[type][square] = makeScore(mg, eg);
+            tables.position[type + PIECE_TYPES][square ^ 56] = makeScore(-mg, -eg);
+        }
+    }
+    return tables;
+}
+
+/** @brief The signed tables, generated at compile time */
+constexpr PieceTables PIECE_TABLES = buildPieceTables();
+
+static_assert(PIECE_TABLES.position[PIECE_TYPES][0] == makeScore(-WHITE_POSITION_MG[0][56], -WHITE_POSITION_EG[0][56]),
+              "black tables must mirror the white ones");
+static_assert(mgValue(makeScore(-37, 12)) == -37 && egValue(makeScore(-37, 12)) == 12 &&
+              egValue(makeScore(5, -80)) == -80, "packed scores must round-trip");
+
+/**
+ * @brief Gets the type index of a piece letter
+ *
+ * @param type Piece letter ('p', 'N', 'B', 'R', 'Q' or 'K')
+ * @return Index 0-5, or -1 for anything else
+ */
+constexpr int pieceTypeIndex(char type) {
+    switch (type) {
+        case 'p': return 0;
+        case 'N': return 1;
+        case 'B': return 2;
+        case 'R': return 3;
+        case 'Q': return 4;
+        case 'K': return 5;
+        default: return -1;
+    }
+}
+
+/**
+ * @brief Gets the unsigned material value of a piece letter
+ *
+ * @param type Piece letter ('p', 'N', 'B', 'R', 'Q' or 'K')
+ * @return Value in centipawns, or 0 for anything else
+ */
+constexpr int pieceTypeValue(char type) {
+    return (pieceTypeIndex(type) >= 0) ? PIECE_TYPE_VALUES[pieceTypeIndex(type)] : 0;
+}
+
+} // namespace EvalTables
+
+#endif // EVALTABLES_H
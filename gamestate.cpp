@@ -1,4 +1,7 @@
 #include "gamestate.h"
+#include "evaltables.h"
+#include <QStringList>
+#include <utility>
 
 /**
  * @brief Static maps for converting between chess notation and board coordinates
@@ -18,12 +21,306 @@ QMap<QString, int> Move::filesToCols = {
 };
 QMap<int, QString> Move::colsToFiles;
 
+namespace {
+
+/** @brief Orthogonal steps as (row, column), in the order the pin scan expects */
+const QPair<int, int> ROOK_DIRECTIONS[4] = {{-1, 0}, {0, -1}, {1, 0}, {0, 1}};
+
+/** @brief Diagonal steps as (row, column), in the order the pin scan expects */
+const QPair<int, int> BISHOP_DIRECTIONS[4] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+
+/** @brief Knight jumps as (row, column) */
+const QPair<int, int> KNIGHT_JUMPS[8] = {
+    {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
+    {1, -2}, {1, 2}, {2, -1}, {2, 1}
+};
+
+/** @brief King steps as (row, column) */
+const QPair<int, int> KING_STEPS[8] = {
+    {-1, -1}, {-1, 0}, {-1, 1},
+    {0, -1}, {0, 1},
+    {1, -1}, {1, 0}, {1, 1}
+};
+
+/**
+ * @brief Random keys used to build Zobrist hashes
+ *
+ * The keys come from a fixed-seed SplitMix64 generator, so the hash of a
+ * position is the same on every run.
+ */
+struct ZobristKeys {
+    /** @brief One key per piece (color * 6 + type) and square */
+    quint64 pieces[12][8][8];
+
+    /** @brief Keys for the wks, bks, wqs and bqs castling rights */
+    quint64 castling[4];
+
+    /** @brief Keys for the file of the en passant square */
+    quint64 enPassantFile[8];
+
+    /** @brief Key toggled when black is to move */
+    quint64 blackToMove;
+
+    ZobristKeys() {
+        quint64 state = 0x9E3779B97F4A7C15ULL;
+        auto next = [&state]() {
+            quint64 z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        };
+
+        for (int piece = 0; piece < 12; piece++) {
+            for (int row = 0; row < 8; row++) {
+                for (int col = 0; col < 8; col++) {
+                    pieces[piece][row][col] = next();
+                }
+            }
+        }
+        for (int i = 0; i < 4; i++) {
+            castling[i] = next();
+        }
+        for (int i = 0; i < 8; i++) {
+            enPassantFile[i] = next();
+        }
+        blackToMove = next();
+    }
+};
+
+const ZobristKeys zobrist;
+
+/**
+ * @brief Cuckoo hash tables of reversible piece moves
+ *
+ * Holds the Zobrist difference (piece on the first square, piece on the
+ * second, side to move) of every knight, bishop, rook, queen and king
+ * move on an empty board, so a single lookup tells whether two positions
+ * are one such move apart. Each key sits in one of two slots given by
+ * two hash functions of the key.
+ */
+struct CuckooTables {
+    /** @brief Number of slots (a power of two, about twice the number of moves) */
+    static const int SIZE = 8192;
+
+    /** @brief Zobrist difference of the move in each slot, 0 for an empty slot */
+    quint64 keys[SIZE];
+
+    /** @brief Squares of the move in each slot, first | second << 6 */
+    quint16 moves[SIZE];
+
+    /** @brief First slot of a key */
+    static int slot1(quint64 key) {
+        return static_cast<int>(key & (SIZE - 1));
+    }
+
+    /** @brief Second slot of a key */
+    static int slot2(quint64 key) {
+        return static_cast<int>((key >> 16) & (SIZE - 1));
+    }
+
+    CuckooTables() : keys{}, moves{} {
+        for (int piece = 0; piece < 12; piece++) {
+            int type = piece % EvalTables::PIECE_TYPES;
+            if (type == 0) {
+                continue;
+            }
+            for (int from = 0; from < 64; from++) {
+                Bitboard targets = 0;
+                const Bitboards::AttackTables& tables = Bitboards::ATTACK_TABLES;
+                if (type == 1) {
+                    targets = tables.knight[from];
+                } else if (type == 5) {
+                    targets = tables.king[from];
+                } else {
+                    for (int direction = 0; direction < 8; direction++) {
+                        bool diagonal = direction >= 4;
+                        if (type == 4 || (type == 2) == diagonal) {
+                            targets |= tables.rays[direction][from];
+                        }
+                    }
+                }
+
+                for (int to = from + 1; to < 64; to++) {
+                    if (!(targets & Bitboards::squareBit(to))) {
+                        continue;
+                    }
+                    quint64 key = zobrist.pieces[piece][from / 8][from % 8] ^
+                                  zobrist.pieces[piece][to / 8][to % 8] ^ zobrist.blackToMove;
+                    quint16 move = static_cast<quint16>(from | (to << 6));
+
+                    // Insert, moving any occupant to its other slot
+                    int i = slot1(key);
+                    while (true) {
+                        std::swap(keys[i], key);
+                        std::swap(moves[i], move);
+                        if (move == 0) {
+                            break;
+                        }
+                        i = (i == slot1(key)) ? slot2(key) : slot1(key);
+                    }
+                }
+            }
+        }
+    }
+};
+
+const CuckooTables cuckoo;
+
+/**
+ * @brief Gets the table index of a piece
+ *
+ * @param piece Two-character piece string (e.g. "wN")
+ * @return color * 6 + type (p, N, B, R, Q, K), or -1 for an empty square
+ */
+int pieceIndex(const QString& piece) {
+    int type = EvalTables::pieceTypeIndex(piece[1].toLatin1());
+    if (type < 0) {
+        return -1;
+    }
+    return (piece[0] == 'w') ? type : type + EvalTables::PIECE_TYPES;
+}
+
+/**
+ * @brief Gets the Zobrist key of a piece on a square
+ *
+ * @param piece Two-character piece string (e.g. "wN"); "--" has no key
+ * @param row Row of the square
+ * @param col Column of the square
+ * @return The key, or 0 for an empty square
+ */
+quint64 pieceKey(const QString& piece, int row, int col) {
+    int index = pieceIndex(piece);
+    return (index >= 0) ? zobrist.pieces[index][row][col] : 0;
+}
+
+/**
+ * @brief Gets the pawn-structure Zobrist key of a piece on a square
+ *
+ * @param piece Two-character piece string
+ * @param row Row of the square
+ * @param col Column of the square
+ * @return The piece's key if it is a pawn, otherwise 0
+ */
+quint64 pawnKeyOf(const QString& piece, int row, int col) {
+    return (piece[1] == 'p') ? pieceKey(piece, row, col) : 0;
+}
+
+/**
+ * @brief Gets the material key increment for one piece
+ *
+ * The material key packs the count of each piece (color * 6 + type) into
+ * four bits, so adding or removing a piece is a single addition.
+ *
+ * @param piece Two-character piece string; "--" counts for nothing
+ * @return 1 shifted into the piece's count field, or 0 for an empty square
+ */
+quint64 materialKeyOf(const QString& piece) {
+    int index = pieceIndex(piece);
+    return (index >= 0) ? (1ULL << (4 * index)) : 0;
+}
+
+/**
+ * @brief Gets the network input feature of a piece on a square
+ *
+ * @param piece Two-character piece string
+ * @param row Row of the square
+ * @param col Column of the square
+ * @return piece * 64 + square in white's encoding, or -1 for an empty square
+ */
+int nnueFeature(const QString& piece, int row, int col) {
+    int index = pieceIndex(piece);
+    return (index >= 0) ? index * 64 + row * 8 + col : -1;
+}
+
+/**
+ * @brief Toggles the squares of the pieces a move removed and added
+ *
+ * Each square flips, so applying the same delta again undoes it.
+ *
+ * @param bitboards Piece bitboards to update
+ * @param delta Features (piece * 64 + square) changed by the move
+ */
+void toggleBitboards(Bitboard* bitboards, const NnueDelta& delta) {
+    for (int i = 0; i < delta.removedCount; i++) {
+        bitboards[delta.removed[i] / 64] ^= Bitboards::squareBit(delta.removed[i] % 64);
+    }
+    for (int i = 0; i < delta.addedCount; i++) {
+        bitboards[delta.added[i] / 64] ^= Bitboards::squareBit(delta.added[i] % 64);
+    }
+}
+
+/**
+ * @brief Gets the combined Zobrist key of a set of castling rights
+ *
+ * @param rights Castling rights to hash
+ * @return XOR of the keys of every right that is still available
+ */
+quint64 castlingKey(const CastleRights& rights) {
+    quint64 key = 0;
+    if (rights.wks) key ^= zobrist.castling[0];
+    if (rights.bks) key ^= zobrist.castling[1];
+    if (rights.wqs) key ^= zobrist.castling[2];
+    if (rights.bqs) key ^= zobrist.castling[3];
+    return key;
+}
+
+/**
+ * @brief Gets the Zobrist key of an en passant square
+ *
+ * @param square En passant square (row, col), or (-1, -1) for none
+ * @return The key of the square's file, or 0 if there is none
+ */
+quint64 enPassantKey(const QPair<int, int>& square) {
+    return (square.second >= 0) ? zobrist.enPassantFile[square.second] : 0;
+}
+
+/**
+ * @brief Gets the signed material value of a piece
+ *
+ * @param piece Two-character piece string; "--" is worth nothing
+ * @return Value in centipawns, positive for white and negative for black
+ */
+int pieceMaterial(const QString& piece) {
+    int index = pieceIndex(piece);
+    return (index >= 0) ? EvalTables::PIECE_TABLES.material[index] : 0;
+}
+
+/**
+ * @brief Gets the signed positional bonus of a piece on a square
+ *
+ * @param piece Two-character piece string; "--" is worth nothing
+ * @param row Row of the square
+ * @param col Column of the square
+ * @return Packed midgame/endgame bonus in centipawns, positive for white and negative for black
+ */
+int piecePosition(const QString& piece, int row, int col) {
+    int index = pieceIndex(piece);
+    return (index >= 0) ? EvalTables::PIECE_TABLES.position[index][row * 8 + col] : 0;
+}
+
+/**
+ * @brief Gets the game phase weight of a piece
+ *
+ * @param piece Two-character piece string; "--" has no weight
+ * @return 1 for minor pieces, 2 for rooks, 4 for queens, otherwise 0
+ */
+int piecePhase(const QString& piece) {
+    int index = pieceIndex(piece);
+    return (index >= 0) ? EvalTables::PIECE_TABLES.phase[index] : 0;
+}
+
+} // namespace
+
+const QString GameState::EMPTY_SQUARE = QStringLiteral("--");
+const QString GameState::WHITE_QUEEN = QStringLiteral("wQ");
+const QString GameState::BLACK_QUEEN = QStringLiteral("bQ");
+
 /**
  * @brief Constructor for GameState class
  * 
  * Initializes the chess board with the standard starting position,
- * sets up move functions for each piece type, initializes game state variables,
- * and creates the reverse mappings for chess notation conversion.
+ * initializes game state variables, and creates the reverse mappings
+ * for chess notation conversion.
  */
 GameState::GameState() {
     // Initialize board with starting position
@@ -38,16 +335,6 @@ GameState::GameState() {
         {{"wR"}, {"wN"}, {"wB"}, {"wQ"}, {"wK"}, {"wB"}, {"wN"}, {"wR"}}
     };
 
-    // Initialize move function map
-    moveFunctions = {
-        {'p', [this](int row, int col, QVector<Move>& moves) { this->getPawnMoves(row, col, moves); }},
-        {'R', [this](int row, int col, QVector<Move>& moves) { this->getRookMoves(row, col, moves); }},
-        {'N', [this](int row, int col, QVector<Move>& moves) { this->getKnightMoves(row, col, moves); }},
-        {'B', [this](int row, int col, QVector<Move>& moves) { this->getBishopMoves(row, col, moves); }},
-        {'Q', [this](int row, int col, QVector<Move>& moves) { this->getQueenMoves(row, col, moves); }},
-        {'K', [this](int row, int col, QVector<Move>& moves) { this->getKingMoves(row, col, moves); }}
-    };
-
     // Initialize game state variables
     whiteToMove = true;
     moveLog = QVector<Move>();
@@ -62,6 +349,26 @@ GameState::GameState() {
     enPassantPossibleLog.push_back(enPassantPossible);
     castlingRights = CastleRights(true, true, true, true);
     castlingRightsLog.push_back(castlingRights);
+    halfmoveClock = 0;
+    halfmoveClockLog.push_back(halfmoveClock);
+    draw = false;
+    zobristKey = computeZobristKey();
+    zobristKeyLog.push_back(zobristKey);
+    pawnKey = computePawnKey();
+    pawnKeyLog.push_back(pawnKey);
+    materialKey = computeMaterialKey();
+    materialKeyLog.push_back(materialKey);
+    materialScore = computeMaterialScore();
+    materialScoreLog.push_back(materialScore);
+    positionScore = computePositionScore();
+    positionScoreLog.push_back(positionScore);
+    gamePhase = computeGamePhase();
+    gamePhaseLog.push_back(gamePhase);
+    for (int piece = 0; piece < EvalTables::PIECES; piece++) {
+        pieceBitboards[piece] = computePieceBitboard(piece);
+    }
+    attackCacheValid = false;
+    network = nullptr;
 
     // Initialize reverse mappings for Move class
     for (auto it = Move::ranksToRows.begin(); it != Move::ranksToRows.end(); ++it) {
@@ -73,6 +380,141 @@ GameState::GameState() {
     }
 }
 
+/**
+ * @brief Sets up the position described by a FEN string
+ *
+ * Parses the piece placement, side to move, castling, en passant and
+ * halfmove clock fields.
+ * The board is only modified once the whole record has been validated.
+ *
+ * @param fen Position in Forsyth-Edwards Notation
+ * @return True if the FEN was parsed, false if it was malformed
+ */
+bool GameState::loadFen(const QString& fen) {
+    QStringList fields = fen.trimmed().split(' ', Qt::SkipEmptyParts);
+    if (fields.size() < 4) {
+        return false;
+    }
+
+    // Piece placement, from rank 8 down to rank 1
+    QVector<QVector<QString>> newBoard(8, QVector<QString>(8, "--"));
+    QPair<int, int> newWhiteKing(-1, -1);
+    QPair<int, int> newBlackKing(-1, -1);
+    QStringList ranks = fields[0].split('/');
+    if (ranks.size() != 8) {
+        return false;
+    }
+
+    for (int row = 0; row < 8; row++) {
+        int col = 0;
+        for (QChar c : ranks[row]) {
+            if (c.isDigit()) {
+                col += c.digitValue();
+                continue;
+            }
+            if (col > 7) {
+                return false;
+            }
+
+            QChar color = c.isUpper() ? 'w' : 'b';
+            QChar type = c.toUpper();
+            if (type == 'P') {
+                type = 'p';
+            } else if (type != 'K' && type != 'Q' && type != 'R' && type != 'B' && type != 'N') {
+                return false;
+            }
+
+            newBoard[row][col] = QString(color) + type;
+            if (type == 'K') {
+                if (color == 'w') {
+                    newWhiteKing = qMakePair(row, col);
+                } else {
+                    newBlackKing = qMakePair(row, col);
+                }
+            }
+            col++;
+        }
+        if (col != 8) {
+            return false;
+        }
+    }
+
+    if (newWhiteKing.first < 0 || newBlackKing.first < 0) {
+        return false;
+    }
+
+    // Side to move
+    if (fields[1] != "w" && fields[1] != "b") {
+        return false;
+    }
+
+    // Castling rights
+    CastleRights newCastlingRights(fields[2].contains('K'), fields[2].contains('k'),
+                                   fields[2].contains('Q'), fields[2].contains('q'));
+
+    // En passant target square
+    QPair<int, int> newEnPassant(-1, -1);
+    if (fields[3] != "-") {
+        if (fields[3].size() != 2 || !Move::filesToCols.contains(fields[3].left(1)) ||
+            !Move::ranksToRows.contains(fields[3].mid(1, 1))) {
+            return false;
+        }
+        newEnPassant = qMakePair(Move::ranksToRows[fields[3].mid(1, 1)],
+                                 Move::filesToCols[fields[3].left(1)]);
+    }
+
+    // Halfmove clock (optional, defaults to 0)
+    int newHalfmoveClock = 0;
+    if (fields.size() > 4) {
+        bool ok = false;
+        newHalfmoveClock = fields[4].toInt(&ok);
+        if (!ok || newHalfmoveClock < 0) {
+            return false;
+        }
+    }
+
+    // Everything parsed, so commit the new position
+    board = newBoard;
+    whiteToMove = (fields[1] == "w");
+    whiteKingLocation = newWhiteKing;
+    blackKingLocation = newBlackKing;
+    moveLog.clear();
+    checkmate = false;
+    stalemate = false;
+    draw = false;
+    inCheck = false;
+    pins.clear();
+    checks.clear();
+    enPassantPossible = newEnPassant;
+    enPassantPossibleLog = {enPassantPossible};
+    castlingRights = newCastlingRights;
+    castlingRightsLog = {castlingRights};
+    halfmoveClock = newHalfmoveClock;
+    halfmoveClockLog = {halfmoveClock};
+    zobristKey = computeZobristKey();
+    zobristKeyLog = {zobristKey};
+    pawnKey = computePawnKey();
+    pawnKeyLog = {pawnKey};
+    materialKey = computeMaterialKey();
+    materialKeyLog = {materialKey};
+    materialScore = computeMaterialScore();
+    materialScoreLog = {materialScore};
+    positionScore = computePositionScore();
+    positionScoreLog = {positionScore};
+    gamePhase = computeGamePhase();
+    gamePhaseLog = {gamePhase};
+    for (int piece = 0; piece < EvalTables::PIECES; piece++) {
+        pieceBitboards[piece] = computePieceBitboard(piece);
+    }
+    attackCacheValid = false;
+    nnueDeltaLog.clear();
+    if (network) {
+        network->refresh(accumulator, *this);
+    }
+
+    return true;
+}
+
 /**
  * @brief Makes a move on the chess board
  * 
@@ -82,8 +524,23 @@ GameState::GameState() {
  * @param move The move to make
  */
 void GameState::makeMove(const Move& move) {
+    // Remove the moving piece and any captured piece from the hash
+    quint64 key = zobristKey ^ pieceKey(move.pieceMoved, move.startRow, move.startCol);
+    int position = positionScore - piecePosition(move.pieceMoved, move.startRow, move.startCol);
+    int captureRow = move.isEnpassantMove ? move.startRow : move.endRow;
+    key ^= pieceKey(move.pieceCaptured, captureRow, move.endCol);
+    quint64 pawns = pawnKey ^ pawnKeyOf(move.pieceMoved, move.startRow, move.startCol)
+                            ^ pawnKeyOf(move.pieceCaptured, captureRow, move.endCol);
+    position -= piecePosition(move.pieceCaptured, captureRow, move.endCol);
+    int material = materialScore - pieceMaterial(move.pieceCaptured);
+    quint64 materialCounts = materialKey - materialKeyOf(move.pieceCaptured);
+    int phase = gamePhase - piecePhase(move.pieceCaptured);
+    NnueDelta delta;
+    delta.remove(nnueFeature(move.pieceMoved, move.startRow, move.startCol));
+    delta.remove(nnueFeature(move.pieceCaptured, captureRow, move.endCol));
+
     // Clear the starting square
-    board[move.startRow][move.startCol] = "--";
+    board[move.startRow][move.startCol] = EMPTY_SQUARE;
     // Place the piece on the destination square
     board[move.endRow][move.endCol] = move.pieceMoved;
     // Add the move to the log
@@ -92,47 +549,102 @@ void GameState::makeMove(const Move& move) {
     whiteToMove = !whiteToMove;
 
     // Update king location if the king moved
-    if (move.pieceMoved == "wK") {
+    if (move.pieceMoved == QLatin1String("wK")) {
         whiteKingLocation = qMakePair(move.endRow, move.endCol);
-    } else if (move.pieceMoved == "bK") {
+    } else if (move.pieceMoved == QLatin1String("bK")) {
         blackKingLocation = qMakePair(move.endRow, move.endCol);
     }
 
     // Handle pawn promotion
     if (move.isPawnPromotion) {
-        board[move.endRow][move.endCol] = QString(move.pieceMoved[0]) + "Q";
+        board[move.endRow][move.endCol] = (move.pieceMoved[0] == 'w') ? WHITE_QUEEN : BLACK_QUEEN;
+        material += pieceMaterial(board[move.endRow][move.endCol]) - pieceMaterial(move.pieceMoved);
+        phase += piecePhase(board[move.endRow][move.endCol]);
+        materialCounts += materialKeyOf(board[move.endRow][move.endCol]) - materialKeyOf(move.pieceMoved);
     }
+    key ^= pieceKey(board[move.endRow][move.endCol], move.endRow, move.endCol);
+    pawns ^= pawnKeyOf(board[move.endRow][move.endCol], move.endRow, move.endCol);
+    position += piecePosition(board[move.endRow][move.endCol], move.endRow, move.endCol);
+    delta.add(nnueFeature(board[move.endRow][move.endCol], move.endRow, move.endCol));
 
     // Handle en passant capture
     if (move.isEnpassantMove) {
-        board[move.startRow][move.endCol] = "--";
+        board[move.startRow][move.endCol] = EMPTY_SQUARE;
     }
 
     // Update en passant possibility
+    key ^= enPassantKey(enPassantPossible);
     if (move.pieceMoved[1] == 'p' && qAbs(move.startRow - move.endRow) == 2) {
         enPassantPossible = qMakePair((move.startRow + move.endRow) / 2, move.startCol);
     } else {
         enPassantPossible = qMakePair(-1, -1);
     }
+    key ^= enPassantKey(enPassantPossible);
 
     // Handle castle move - move the rook
     if (move.isCastleMove) {
         if (move.endCol - move.startCol == 2) {  // King side castle
             board[move.endRow][move.endCol - 1] = board[move.endRow][move.endCol + 1];
-            board[move.endRow][move.endCol + 1] = "--";
+            board[move.endRow][move.endCol + 1] = EMPTY_SQUARE;
+            key ^= pieceKey(board[move.endRow][move.endCol - 1], move.endRow, move.endCol + 1);
+            key ^= pieceKey(board[move.endRow][move.endCol - 1], move.endRow, move.endCol - 1);
+            position += piecePosition(board[move.endRow][move.endCol - 1], move.endRow, move.endCol - 1)
+                      - piecePosition(board[move.endRow][move.endCol - 1], move.endRow, move.endCol + 1);
+            delta.remove(nnueFeature(board[move.endRow][move.endCol - 1], move.endRow, move.endCol + 1));
+            delta.add(nnueFeature(board[move.endRow][move.endCol - 1], move.endRow, move.endCol - 1));
         } else {  // Queen side castle
             board[move.endRow][move.endCol + 1] = board[move.endRow][move.endCol - 2];
-            board[move.endRow][move.endCol - 2] = "--";
+            board[move.endRow][move.endCol - 2] = EMPTY_SQUARE;
+            key ^= pieceKey(board[move.endRow][move.endCol + 1], move.endRow, move.endCol - 2);
+            key ^= pieceKey(board[move.endRow][move.endCol + 1], move.endRow, move.endCol + 1);
+            position += piecePosition(board[move.endRow][move.endCol + 1], move.endRow, move.endCol + 1)
+                      - piecePosition(board[move.endRow][move.endCol + 1], move.endRow, move.endCol - 2);
+            delta.remove(nnueFeature(board[move.endRow][move.endCol + 1], move.endRow, move.endCol - 2));
+            delta.add(nnueFeature(board[move.endRow][move.endCol + 1], move.endRow, move.endCol + 1));
         }
     }
 
     // Update en passant log
     enPassantPossibleLog.push_back(enPassantPossible);
 
+    // Captures and pawn moves can't be undone, so the clock restarts
+    if (move.isCapture || move.pieceMoved[1] == 'p') {
+        halfmoveClock = 0;
+    } else {
+        halfmoveClock++;
+    }
+    halfmoveClockLog.push_back(halfmoveClock);
+
     // Update castling rights
+    key ^= castlingKey(castlingRights);
     updateCastleRights(move);
+    key ^= castlingKey(castlingRights);
     castlingRightsLog.push_back(CastleRights(castlingRights.wks, castlingRights.bks,
                                          castlingRights.wqs, castlingRights.bqs));
+
+    // Update the hash for the new side to move
+    zobristKey = key ^ zobrist.blackToMove;
+    zobristKeyLog.push_back(zobristKey);
+    pawnKey = pawns;
+    pawnKeyLog.push_back(pawnKey);
+    materialKey = materialCounts;
+    materialKeyLog.push_back(materialKey);
+
+    // Update the evaluation totals
+    materialScore = material;
+    materialScoreLog.push_back(materialScore);
+    positionScore = position;
+    positionScoreLog.push_back(positionScore);
+    gamePhase = phase;
+    gamePhaseLog.push_back(gamePhase);
+
+    // Update the piece bitboards and the network accumulator
+    toggleBitboards(pieceBitboards, delta);
+    attackCacheValid = false;
+    if (network) {
+        network->update(accumulator, delta);
+    }
+    nnueDeltaLog.push_back(delta);
 }
 
 /**
@@ -157,15 +669,15 @@ void GameState::undoMove() {
     whiteToMove = !whiteToMove;
 
     // Update king location if the king moved
-    if (move.pieceMoved == "wK") {
+    if (move.pieceMoved == QLatin1String("wK")) {
         whiteKingLocation = qMakePair(move.startRow, move.startCol);
-    } else if (move.pieceMoved == "bK") {
+    } else if (move.pieceMoved == QLatin1String("bK")) {
         blackKingLocation = qMakePair(move.startRow, move.startCol);
     }
 
     // Handle en passant move
     if (move.isEnpassantMove) {
-        board[move.endRow][move.endCol] = "--";
+        board[move.endRow][move.endCol] = EMPTY_SQUARE;
         board[move.startRow][move.endCol] = move.pieceCaptured;
     }
 
@@ -177,20 +689,93 @@ void GameState::undoMove() {
     castlingRightsLog.pop_back();
     castlingRights = castlingRightsLog.back();
 
+    // Restore the halfmove clock
+    halfmoveClockLog.pop_back();
+    halfmoveClock = halfmoveClockLog.back();
+
+    // Restore the hash
+    zobristKeyLog.pop_back();
+    zobristKey = zobristKeyLog.back();
+    pawnKeyLog.pop_back();
+    pawnKey = pawnKeyLog.back();
+    materialKeyLog.pop_back();
+    materialKey = materialKeyLog.back();
+
+    // Restore the evaluation totals
+    materialScoreLog.pop_back();
+    materialScore = materialScoreLog.back();
+    positionScoreLog.pop_back();
+    positionScore = positionScoreLog.back();
+    gamePhaseLog.pop_back();
+    gamePhase = gamePhaseLog.back();
+
+    // Restore the piece bitboards and the network accumulator
+    toggleBitboards(pieceBitboards, nnueDeltaLog.back());
+    attackCacheValid = false;
+    if (network) {
+        network->revert(accumulator, nnueDeltaLog.back());
+    }
+    nnueDeltaLog.pop_back();
+
     // Handle castle move - move the rook back
     if (move.isCastleMove) {
         if (move.endCol - move.startCol == 2) {  // King side castle
             board[move.endRow][move.endCol + 1] = board[move.endRow][move.endCol - 1];
-            board[move.endRow][move.endCol - 1] = "--";
+            board[move.endRow][move.endCol - 1] = EMPTY_SQUARE;
         } else {  // Queen side castle
             board[move.endRow][move.endCol - 2] = board[move.endRow][move.endCol + 1];
-            board[move.endRow][move.endCol + 1] = "--";
+            board[move.endRow][move.endCol + 1] = EMPTY_SQUARE;
         }
     }
 
-    // Reset checkmate and stalemate flags
+    // Reset checkmate, stalemate and draw flags
     checkmate = false;
     stalemate = false;
+    draw = false;
+}
+
+/**
+ * @brief Passes the turn without moving a piece
+ *
+ * Flips the side to move and clears the en passant square, pushing log
+ * entries so that undoNullMove() can restore the position. Castling rights
+ * are unchanged but logged so both logs stay in step with the hash log.
+ * The halfmove clock restarts, so repetition checks stop at the null move.
+ */
+void GameState::makeNullMove() {
+    zobristKey ^= enPassantKey(enPassantPossible) ^ zobrist.blackToMove;
+    whiteToMove = !whiteToMove;
+    enPassantPossible = qMakePair(-1, -1);
+    halfmoveClock = 0;
+
+    enPassantPossibleLog.push_back(enPassantPossible);
+    castlingRightsLog.push_back(castlingRights);
+    halfmoveClockLog.push_back(halfmoveClock);
+    zobristKeyLog.push_back(zobristKey);
+}
+
+/**
+ * @brief Undoes a null move made with makeNullMove()
+ *
+ * Pops the log entries pushed by makeNullMove() and restores the side to
+ * move, en passant square, castling rights, halfmove clock and hash.
+ */
+void GameState::undoNullMove() {
+    whiteToMove = !whiteToMove;
+
+    enPassantPossibleLog.pop_back();
+    enPassantPossible = enPassantPossibleLog.back();
+    castlingRightsLog.pop_back();
+    castlingRights = castlingRightsLog.back();
+    halfmoveClockLog.pop_back();
+    halfmoveClock = halfmoveClockLog.back();
+    zobristKeyLog.pop_back();
+    zobristKey = zobristKeyLog.back();
+
+    // Reset checkmate, stalemate and draw flags
+    checkmate = false;
+    stalemate = false;
+    draw = false;
 }
 
 /**
@@ -203,13 +788,13 @@ void GameState::undoMove() {
  */
 void GameState::updateCastleRights(const Move& move) {
     // If a rook is captured
-    if (move.pieceCaptured == "wR") {
+    if (move.pieceCaptured == QLatin1String("wR")) {
         if (move.endCol == 0) {
             castlingRights.wqs = false;
         } else if (move.endCol == 7) {
             castlingRights.wks = false;
         }
-    } else if (move.pieceCaptured == "bR") {
+    } else if (move.pieceCaptured == QLatin1String("bR")) {
         if (move.endCol == 0) {
             castlingRights.bqs = false;
         } else if (move.endCol == 7) {
@@ -218,16 +803,16 @@ void GameState::updateCastleRights(const Move& move) {
     }
 
     // If the king moves
-    if (move.pieceMoved == "wK") {
+    if (move.pieceMoved == QLatin1String("wK")) {
         castlingRights.wqs = false;
         castlingRights.wks = false;
-    } else if (move.pieceMoved == "bK") {
+    } else if (move.pieceMoved == QLatin1String("bK")) {
         castlingRights.bqs = false;
         castlingRights.bks = false;
     }
 
     // If a rook moves
-    else if (move.pieceMoved == "wR") {
+    else if (move.pieceMoved == QLatin1String("wR")) {
         if (move.startRow == 7) {
             if (move.startCol == 0) {
                 castlingRights.wqs = false;
@@ -235,7 +820,7 @@ void GameState::updateCastleRights(const Move& move) {
                 castlingRights.wks = false;
             }
         }
-    } else if (move.pieceMoved == "bR") {
+    } else if (move.pieceMoved == QLatin1String("bR")) {
         if (move.startRow == 0) {
             if (move.startCol == 0) {
                 castlingRights.bqs = false;
@@ -255,18 +840,30 @@ void GameState::updateCastleRights(const Move& move) {
  * @return A vector of all valid moves
  */
 QVector<Move> GameState::getValidMoves()
+{
+    QVector<Move> moves;
+    getValidMoves(moves);
+    return moves;
+}
+
+/**
+ * @brief Gets all valid moves for the current position into a caller-owned list
+ * 
+ * Same as getValidMoves(), but fills the given list, which is emptied
+ * first and keeps its capacity.
+ * 
+ * @param moves Receives the valid moves
+ */
+void GameState::getValidMoves(QVector<Move>& moves)
 {
     // Save current castling rights so we can restore them later
     CastleRights tempCastleRights = castlingRights;
 
     // First, determine pins/checks so we know if the king is in check
-    PinsAndChecksInfo pinCheckInfo = checkForPinsAndChecks();
-    inCheck = pinCheckInfo.inCheck;
-    pins = pinCheckInfo.pins;
-    checks = pinCheckInfo.checks;
+    inCheck = collectPinsAndChecks(pins, checks);
 
     // We'll build our final list of moves here
-    QVector<Move> moves;
+    moves.resize(0);
 
     // Get the current king position
     int kingRow = whiteToMove ? whiteKingLocation.first : blackKingLocation.first;
@@ -277,52 +874,31 @@ QVector<Move> GameState::getValidMoves()
         // Single check
         if (checks.size() == 1) {
             // Generate all possible moves
-            moves = getAllPossibleMoves();
+            getAllPossibleMoves(moves);
 
             // Now figure out which moves can block/capture the checking piece
             // to resolve the single check
-            PinInfo check = checks[0];
-            int checkRow = check.row;
-            int checkCol = check.col;
-            QString pieceChecking = board[checkRow][checkCol];
-
-            // Collect squares that block or capture the checker
-            QVector<QPair<int, int>> validSquares;
-
-            // Knight cannot be blocked, so we must capture it directly
-            if (pieceChecking[1] == 'N') {
-                validSquares.push_back(qMakePair(checkRow, checkCol));
-            } 
-            else {
-                // Add the ray from king to checker (including checker square)
-                for (int i = 1; i < 8; i++) {
-                    QPair<int, int> square(kingRow + check.dirRow * i,
-                                           kingCol + check.dirCol * i);
-                    validSquares.push_back(square);
-                    if (square.first == checkRow && square.second == checkCol) {
-                        break;  // stop once we reach the checking piece
-                    }
-                }
+            const PinInfo& check = checks[0];
+            int checkSquare = check.row * 8 + check.col;
+
+            // Squares that block or capture the checker; a knight can't be blocked
+            Bitboard validSquares = Bitboards::squareBit(checkSquare);
+            if (board[check.row][check.col][1] != 'N') {
+                validSquares |= Bitboards::between(kingRow * 8 + kingCol, checkSquare);
             }
 
-            // Remove any moves that do not capture/block the checking piece
-            for (int i = moves.size() - 1; i >= 0; i--) {
-                // If this isn't a king move, it must block or capture
-                if (moves[i].pieceMoved[1] != 'K') {
-                    bool resolvesCheck = false;
-                    for (const auto &sq : validSquares) {
-                        if (moves[i].endRow == sq.first && 
-                            moves[i].endCol == sq.second)
-                        {
-                            resolvesCheck = true;
-                            break;
-                        }
-                    }
-                    if (!resolvesCheck) {
-                        moves.removeAt(i);
+            // Keep king moves and the moves that capture/block the checking piece
+            int kept = 0;
+            for (int i = 0; i < moves.size(); i++) {
+                if (moves[i].pieceMoved[1] == 'K' ||
+                    (validSquares & Bitboards::squareBit(moves[i].endRow * 8 + moves[i].endCol))) {
+                    if (kept != i) {
+                        moves[kept] = moves[i];
                     }
+                    kept++;
                 }
             }
+            moves.resize(kept);
         }
         // Double check: only the king can move
         else {
@@ -343,7 +919,7 @@ QVector<Move> GameState::getValidMoves()
     // 2) If we are NOT in check, generate all possible moves normally
     else {
         // All moves
-        moves = getAllPossibleMoves();
+        getAllPossibleMoves(moves);
 
         // Also add potential castling moves
         if (whiteToMove) {
@@ -362,16 +938,17 @@ QVector<Move> GameState::getValidMoves()
             checkmate = false;
             stalemate = true;
         }
+        draw = false;
     } 
     else {
         checkmate = false;
         stalemate = false;
+        // Fifty moves without a capture or pawn move, or a third occurrence
+        draw = halfmoveClock >= 100 || repetitionCount() >= 2;
     }
 
     // 4) Restore castling rights to what they were before generating moves
     castlingRights = tempCastleRights;
-
-    return moves;
 }
 
 /**
@@ -390,24 +967,15 @@ bool GameState::isInCheck() {
 /**
  * @brief Checks if a square is under attack by opponent pieces
  * 
+ * Reads the attackers from the piece bitboards.
+ * 
  * @param row Row of the square to check
  * @param col Column of the square to check
  * @return True if the square is under attack, false otherwise
  */
 bool GameState::squareUnderAttack(int row, int col) {
-    // Switch to opponent's turn temporarily
-    whiteToMove = !whiteToMove;
-    QVector<Move> opponentMoves = getAllPossibleMoves();
-    whiteToMove = !whiteToMove;
-
-    // Check if any opponent move attacks the square
-    for (const Move& move : opponentMoves) {
-        if (move.endRow == row && move.endCol == col) {
-            return true;
-        }
-    }
-
-    return false;
+    Bitboard occupied = colorPieces(0) | colorPieces(1);
+    return (attackersTo(row * 8 + col, occupied) & colorPieces(whiteToMove ? 1 : 0)) != 0;
 }
 
 /**
@@ -420,20 +988,51 @@ bool GameState::squareUnderAttack(int row, int col) {
  */
 QVector<Move> GameState::getAllPossibleMoves() {
     QVector<Move> moves;
+    getAllPossibleMoves(moves);
+    return moves;
+}
 
+/**
+ * @brief Appends all possible moves, without considering check, to a list
+ * 
+ * @param moves The vector to add the moves to
+ */
+void GameState::getAllPossibleMoves(QVector<Move>& moves) {
     for (int row = 0; row < 8; row++) {
         for (int col = 0; col < 8; col++) {
             QChar turn = board[row][col][0];
             if ((turn == 'w' && whiteToMove) || (turn == 'b' && !whiteToMove)) {
-                QChar piece = board[row][col][1];
-                if (moveFunctions.contains(piece)) {
-                    moveFunctions[piece](row, col, moves);
+                switch (board[row][col][1].toLatin1()) {
+                    case 'p': getPawnMoves(row, col, moves); break;
+                    case 'R': getRookMoves(row, col, moves); break;
+                    case 'N': getKnightMoves(row, col, moves); break;
+                    case 'B': getBishopMoves(row, col, moves); break;
+                    case 'Q': getQueenMoves(row, col, moves); break;
+                    case 'K': getKingMoves(row, col, moves); break;
                 }
             }
         }
     }
-    
-    return moves;
+}
+
+/**
+ * @brief Reserves room in the logs for a number of further moves
+ * 
+ * @param plies Number of moves (or null moves) to make room for
+ */
+void GameState::reserveHistory(int plies) {
+    int size = zobristKeyLog.size() + plies;
+    moveLog.reserve(size);
+    enPassantPossibleLog.reserve(size);
+    castlingRightsLog.reserve(size);
+    halfmoveClockLog.reserve(size);
+    zobristKeyLog.reserve(size);
+    pawnKeyLog.reserve(size);
+    materialKeyLog.reserve(size);
+    materialScoreLog.reserve(size);
+    positionScoreLog.reserve(size);
+    gamePhaseLog.reserve(size);
+    nnueDeltaLog.reserve(size);
 }
 
 /**
@@ -445,25 +1044,36 @@ QVector<Move> GameState::getAllPossibleMoves() {
  * @return A struct containing information about pins and checks
  */
 PinsAndChecksInfo GameState::checkForPinsAndChecks() {
-    QVector<PinInfo> pins;
-    QVector<PinInfo> checks;
+    PinsAndChecksInfo info;
+    info.inCheck = collectPinsAndChecks(info.pins, info.checks);
+    return info;
+}
+
+/**
+ * @brief Finds the pins on and checks against the side to move's king
+ * 
+ * Looks along the eight lines from the king for an enemy slider, pawn or
+ * king with at most one friendly piece in between, then at the knight
+ * squares.
+ * 
+ * @param pinList Receives the pinned pieces and their pin directions
+ * @param checkList Receives the checking pieces and their directions
+ * @return True if the king is in check
+ */
+bool GameState::collectPinsAndChecks(QVector<PinInfo>& pinList, QVector<PinInfo>& checkList) {
+    pinList.resize(0);
+    checkList.resize(0);
     bool inCheck = false;
 
     // Get king position and set team colors
-    QString enemyColor = (whiteToMove) ? "b" : "w";
-    QString teamColor = (whiteToMove) ? "w" : "b";
+    QChar enemyColor = (whiteToMove) ? 'b' : 'w';
+    QChar teamColor = (whiteToMove) ? 'w' : 'b';
     int startRow = (whiteToMove) ? whiteKingLocation.first : blackKingLocation.first;
     int startCol = (whiteToMove) ? whiteKingLocation.second : blackKingLocation.second;
 
-    // Direction vectors for checks and pins
-    QVector<QPair<int, int>> directions = {
-        {-1, 0}, {0, -1}, {1, 0}, {0, 1},  // Rook directions
-        {-1, -1}, {-1, 1}, {1, -1}, {1, 1}  // Bishop directions
-    };
-
-    // Check each direction
-    for (int j = 0; j < directions.size(); j++) {
-        auto d = directions[j];
+    // Check each direction: rook directions first, then bishop directions
+    for (int j = 0; j < 8; j++) {
+        const QPair<int, int>& d = (j < 4) ? ROOK_DIRECTIONS[j] : BISHOP_DIRECTIONS[j - 4];
         PinInfo possiblePin;
         possiblePin.row = -1;
         possiblePin.col = -1;
@@ -476,17 +1086,17 @@ PinsAndChecksInfo GameState::checkForPinsAndChecks() {
 
             // Check if square is on the board
             if (endRow >= 0 && endRow <= 7 && endCol >= 0 && endCol <= 7) {
-                QString endPiece = board[endRow][endCol];
+                const QString& endPiece = board[endRow][endCol];
 
                 // Check if piece is a potential pin
-                if (endPiece[0] == teamColor[0] && endPiece[1] != 'K') {
+                if (endPiece[0] == teamColor && endPiece[1] != 'K') {
                     if (possiblePin.row == -1) {
                         possiblePin.row = endRow;
                         possiblePin.col = endCol;
                     } else {
                         break;  // Second allied piece, no pin or check
                     }
-                } else if (endPiece[0] == enemyColor[0]) {
+                } else if (endPiece[0] == enemyColor) {
                     QChar pieceType = endPiece[1];
 
                     // Check if piece type can attack the king
@@ -502,8 +1112,8 @@ PinsAndChecksInfo GameState::checkForPinsAndChecks() {
                     }
                     // Pawn checks (only directly adjacent diagonals)
                     else if (i == 1 && pieceType == 'p') {
-                        if ((enemyColor == "w" && j >= 6 && j <= 7) ||
-                            (enemyColor == "b" && j >= 4 && j <= 5)) {
+                        if ((enemyColor == 'w' && j >= 6 && j <= 7) ||
+                            (enemyColor == 'b' && j >= 4 && j <= 5)) {
                             canCheck = true;
                         }
                     }
@@ -519,10 +1129,10 @@ PinsAndChecksInfo GameState::checkForPinsAndChecks() {
                     if (canCheck) {
                         if (possiblePin.row == -1) {  // No piece blocking, so check
                             inCheck = true;
-                            checks.push_back(PinInfo(endRow, endCol, d.first, d.second));
+                            checkList.push_back(PinInfo(endRow, endCol, d.first, d.second));
                             break;
                         } else {  // Piece in the way, so pin
-                            pins.push_back(possiblePin);
+                            pinList.push_back(possiblePin);
                             break;
                         }
                     } else {  // Enemy piece that doesn't give check
@@ -536,25 +1146,466 @@ PinsAndChecksInfo GameState::checkForPinsAndChecks() {
     }
     
     // Knight checks (cannot be pins)
-    QVector<QPair<int, int>> knightMoves = {
-        {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
-        {1, -2}, {1, 2}, {2, -1}, {2, 1}
-    };
-
-    for (const auto& move : knightMoves) {
+    for (const auto& move : KNIGHT_JUMPS) {
         int endRow = startRow + move.first;
         int endCol = startCol + move.second;
 
         if (endRow >= 0 && endRow <= 7 && endCol >= 0 && endCol <= 7) {
-            QString endPiece = board[endRow][endCol];
-            if (endPiece[0] == enemyColor[0] && endPiece[1] == 'N') {
+            const QString& endPiece = board[endRow][endCol];
+            if (endPiece[0] == enemyColor && endPiece[1] == 'N') {
                 inCheck = true;
-                checks.push_back(PinInfo(endRow, endCol, move.first, move.second));
+                checkList.push_back(PinInfo(endRow, endCol, move.first, move.second));
             }
         }
     }
 
-    return PinsAndChecksInfo(inCheck, pins, checks);
+    return inCheck;
+}
+
+/**
+ * @brief Checks whether a side has any pieces besides pawns and its king
+ *
+ * @param white True to check white's pieces, false for black's
+ * @return True if the side has a knight, bishop, rook or queen
+ */
+bool GameState::hasNonPawnMaterial(bool white) const {
+    QChar color = white ? 'w' : 'b';
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            const QString& piece = board[row][col];
+            if (piece[0] == color && piece[1] != 'p' && piece[1] != 'K') {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Checks whether the current position occurred before
+ *
+ * Walks the hash log back two plies at a time (same side to move),
+ * stopping at the last capture, pawn move or null move, and stops at the
+ * first match.
+ *
+ * @return bool True if the Zobrist hash matches an earlier position
+ */
+bool GameState::isRepetition() const {
+    int current = zobristKeyLog.size() - 1;
+    int limit = qMin(halfmoveClock, current);
+    for (int distance = 4; distance <= limit; distance += 2) {
+        if (zobristKeyLog[current - distance] == zobristKey) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Counts earlier occurrences of the current position
+ *
+ * @return int Number of earlier positions since the last irreversible move with the same hash
+ */
+int GameState::repetitionCount() const {
+    int current = zobristKeyLog.size() - 1;
+    int limit = qMin(halfmoveClock, current);
+    int count = 0;
+    for (int distance = 4; distance <= limit; distance += 2) {
+        if (zobristKeyLog[current - distance] == zobristKey) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Checks whether the side to move can repeat a position of the search
+ *
+ * For each earlier position an odd number of plies back (the opponent was
+ * to move there, so one move of ours can reach it), the difference of the
+ * two hashes is looked up in the cuckoo tables. A hit names a piece move
+ * between two squares; it is only playable if the squares between them
+ * are empty and the piece belongs to the side to move.
+ *
+ * @param ply Distance of the current position from the search root
+ * @return bool True if a move to an earlier search position exists
+ */
+bool GameState::hasUpcomingRepetition(int ply) const {
+    int current = zobristKeyLog.size() - 1;
+    int limit = qMin(halfmoveClock, current);
+    if (limit < 3) {
+        return false;
+    }
+
+    Bitboard occupied = colorPieces(0) | colorPieces(1);
+    for (int distance = 3; distance <= limit && distance < ply; distance += 2) {
+        quint64 moveKey = zobristKey ^ zobristKeyLog[current - distance];
+        int slot = CuckooTables::slot1(moveKey);
+        if (cuckoo.keys[slot] != moveKey) {
+            slot = CuckooTables::slot2(moveKey);
+            if (cuckoo.keys[slot] != moveKey) {
+                continue;
+            }
+        }
+
+        int from = cuckoo.moves[slot] & 63;
+        int to = cuckoo.moves[slot] >> 6;
+        if (Bitboards::between(from, to) & occupied) {
+            continue;
+        }
+
+        // The piece is on one of the two squares and must be ours to move
+        const QString& piece = (board[from / 8][from % 8] != EMPTY_SQUARE) ? board[from / 8][from % 8] : board[to / 8][to % 8];
+        if ((piece[0] == 'w') == whiteToMove) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Gets every piece of either color that attacks a square
+ *
+ * Pawn attacks are found from the target square: a white pawn attacks it
+ * from where a black pawn on it would attack, and vice versa.
+ *
+ * @param square Target square (row * 8 + col)
+ * @param occupied Squares treated as occupied
+ * @return Bitboard The squares of the attacking pieces
+ */
+Bitboard GameState::attackersTo(int square, Bitboard occupied) const {
+    const Bitboard* white = pieceBitboards;
+    const Bitboard* black = pieceBitboards + EvalTables::PIECE_TYPES;
+    const Bitboards::AttackTables& tables = Bitboards::ATTACK_TABLES;
+
+    return (tables.pawn[1][square] & white[0])
+         | (tables.pawn[0][square] & black[0])
+         | (tables.knight[square] & (white[1] | black[1]))
+         | (Bitboards::bishopAttacks(square, occupied) & (white[2] | black[2] | white[4] | black[4]))
+         | (Bitboards::rookAttacks(square, occupied) & (white[3] | black[3] | white[4] | black[4]))
+         | (tables.king[square] & (white[5] | black[5]));
+}
+
+/**
+ * @brief Finds a side's least valuable piece among a set of attackers
+ *
+ * @param attackers Attacking pieces of both colors
+ * @param color 0 for white, 1 for black
+ * @param type Receives the piece type index of the attacker found
+ * @return Bitboard The attacker's square bit, or 0 if the side has none
+ */
+Bitboard GameState::leastValuableAttacker(Bitboard attackers, int color, int& type) const {
+    for (type = 0; type < EvalTables::PIECE_TYPES; type++) {
+        Bitboard pieces = attackers & pieceBitboards[color * EvalTables::PIECE_TYPES + type];
+        if (pieces) {
+            return pieces & (~pieces + 1);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Sets up the exchange on a move's destination square
+ *
+ * The moving piece leaves its square and the captured piece, including
+ * an en passant victim, is taken off the board. A promotion gains the
+ * difference between a queen and a pawn, and leaves a queen on the
+ * square to be captured.
+ *
+ * @param move The move starting the exchange
+ * @param occupied Receives the occupancy after the move
+ * @param gain Receives the material won by the move itself
+ * @param pieceValue Receives the value of the piece left on the square
+ */
+void GameState::seeInitialise(const Move& move, Bitboard& occupied, int& gain, int& pieceValue) const {
+    int from = move.startRow * 8 + move.startCol;
+    int to = move.endRow * 8 + move.endCol;
+
+    occupied = (colorPieces(0) | colorPieces(1)) & ~Bitboards::squareBit(from) & ~Bitboards::squareBit(to);
+    if (move.isEnpassantMove) {
+        occupied ^= Bitboards::squareBit(move.startRow * 8 + move.endCol);
+    }
+
+    gain = move.isCapture ? EvalTables::pieceTypeValue(move.pieceCaptured[1].toLatin1()) : 0;
+    pieceValue = EvalTables::pieceTypeValue(move.pieceMoved[1].toLatin1());
+    if (move.isPawnPromotion) {
+        gain += EvalTables::pieceTypeValue('Q') - pieceValue;
+        pieceValue = EvalTables::pieceTypeValue('Q');
+    }
+}
+
+/**
+ * @brief Static exchange evaluation of a move
+ *
+ * Builds the swap list: after the move, the sides take turns capturing on
+ * the destination square with their least valuable attacker, and removing
+ * each capturer from the occupancy uncovers any slider behind it. A king
+ * only captures if the square is no longer defended. The list is then
+ * folded back from the end, letting either side stop when recapturing
+ * would lose.
+ *
+ * @param move Move to evaluate
+ * @return int Material gained by the side making the move, in centipawns
+ */
+int GameState::see(const Move& move) const {
+    int to = move.endRow * 8 + move.endCol;
+    int color = (move.pieceMoved[0] == 'w') ? 0 : 1;
+
+    Bitboard occupied;
+    int gain[32];
+    int pieceValue;
+    seeInitialise(move, occupied, gain[0], pieceValue);
+
+    Bitboard attackers = attackersTo(to, occupied) & occupied;
+    int depth = 0;
+    while (depth < 31) {
+        color = 1 - color;
+        int type;
+        Bitboard attacker = leastValuableAttacker(attackers, color, type);
+        if (!attacker) {
+            break;
+        }
+        // The king can't capture into a defended square
+        if (type == 5 && (attackers & colorPieces(1 - color) & occupied)) {
+            break;
+        }
+
+        depth++;
+        gain[depth] = pieceValue - gain[depth - 1];
+        pieceValue = EvalTables::PIECE_TYPE_VALUES[type];
+
+        // Remove the capturer and add any slider it was hiding
+        occupied ^= attacker;
+        attackers = attackersTo(to, occupied) & occupied;
+    }
+
+    while (depth > 0) {
+        gain[depth - 1] = -qMax(-gain[depth - 1], gain[depth]);
+        depth--;
+    }
+    return gain[0];
+}
+
+/**
+ * @brief Checks whether a move's static exchange value reaches a threshold
+ *
+ * Keeps a running balance instead of a swap list. swap is what the side
+ * that just captured stands to lose beyond its goal; as soon as the next
+ * capturer's value is not enough to make up for it, that side stops and
+ * the result is known. A king capture ends the exchange, and is undone if
+ * the square is still defended.
+ *
+ * @param move Move to evaluate
+ * @param threshold Material balance to test against, in centipawns
+ * @return bool True if the exchange gains at least threshold
+ */
+bool GameState::seeGe(const Move& move, int threshold) const {
+    int to = move.endRow * 8 + move.endCol;
+    int color = (move.pieceMoved[0] == 'w') ? 0 : 1;
+
+    Bitboard occupied;
+    int gain;
+    int pieceValue;
+    seeInitialise(move, occupied, gain, pieceValue);
+
+    // Even without a recapture the move falls short
+    int swap = gain - threshold;
+    if (swap < 0) {
+        return false;
+    }
+
+    // Even losing the moved piece, the move reaches the threshold
+    swap = pieceValue - swap;
+    if (swap <= 0) {
+        return true;
+    }
+
+    Bitboard attackers = attackersTo(to, occupied) & occupied;
+    bool result = true;
+    while (true) {
+        color = 1 - color;
+        int type;
+        Bitboard attacker = leastValuableAttacker(attackers, color, type);
+        if (!attacker) {
+            break;
+        }
+        result = !result;
+
+        // The king can't capture into a defended square
+        if (type == 5) {
+            return (attackers & colorPieces(1 - color) & occupied) ? !result : result;
+        }
+
+        swap = EvalTables::PIECE_TYPE_VALUES[type] - swap;
+        if (swap < (result ? 1 : 0)) {
+            break;
+        }
+
+        // Remove the capturer and add any slider it was hiding
+        occupied ^= attacker;
+        attackers = attackersTo(to, occupied) & occupied;
+    }
+    return result;
+}
+
+/**
+ * @brief Computes the Zobrist hash of the current position from scratch
+ *
+ * XORs together the keys of every piece on its square, the side to move,
+ * each available castling right and the en passant file.
+ *
+ * @return The hash of the current position
+ */
+quint64 GameState::computeZobristKey() const {
+    quint64 key = 0;
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            key ^= pieceKey(board[row][col], row, col);
+        }
+    }
+    if (!whiteToMove) {
+        key ^= zobrist.blackToMove;
+    }
+    key ^= castlingKey(castlingRights);
+    key ^= enPassantKey(enPassantPossible);
+    return key;
+}
+
+/**
+ * @brief Computes the pawn-structure hash of the current position from scratch
+ *
+ * @return XOR of the keys of every pawn on its square
+ */
+quint64 GameState::computePawnKey() const {
+    quint64 key = 0;
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            key ^= pawnKeyOf(board[row][col], row, col);
+        }
+    }
+    return key;
+}
+
+/**
+ * @brief Computes the material key of the current position from scratch
+ *
+ * @return The piece counts packed four bits per piece
+ */
+quint64 GameState::computeMaterialKey() const {
+    quint64 key = 0;
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            key += materialKeyOf(board[row][col]);
+        }
+    }
+    return key;
+}
+
+/**
+ * @brief Selects the network whose accumulator makeMove() keeps up to date
+ *
+ * The accumulator is rebuilt from the board when a new network is set.
+ *
+ * @param net Network to use, or nullptr to stop maintaining the accumulator
+ */
+void GameState::setNetwork(const NnueNetwork* net) {
+    if (net == network) {
+        return;
+    }
+    network = net;
+    if (network) {
+        network->refresh(accumulator, *this);
+    }
+}
+
+/**
+ * @brief Computes the material balance of the current position from scratch
+ *
+ * @return Sum of the signed piece values on the board, in centipawns
+ */
+int GameState::computeMaterialScore() const {
+    int score = 0;
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            score += pieceMaterial(board[row][col]);
+        }
+    }
+    return score;
+}
+
+/**
+ * @brief Computes the piece-square balance of the current position from scratch
+ *
+ * @return Sum of the signed packed midgame/endgame bonuses on the board
+ */
+int GameState::computePositionScore() const {
+    int score = 0;
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            score += piecePosition(board[row][col], row, col);
+        }
+    }
+    return score;
+}
+
+/**
+ * @brief Computes the game phase of the current position from scratch
+ *
+ * @return Sum of the phase weights of the pieces on the board
+ */
+int GameState::computeGamePhase() const {
+    int phase = 0;
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            phase += piecePhase(board[row][col]);
+        }
+    }
+    return phase;
+}
+
+/**
+ * @brief Computes the squares of one piece from scratch
+ *
+ * @param piece Piece index (color * 6 + type)
+ * @return Bitboard The squares holding that piece
+ */
+Bitboard GameState::computePieceBitboard(int piece) const {
+    Bitboard bitboard = 0;
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            if (pieceIndex(board[row][col]) == piece) {
+                bitboard |= Bitboards::squareBit(row * 8 + col);
+            }
+        }
+    }
+    return bitboard;
+}
+
+/**
+ * @brief Gets the squares occupied by one color
+ *
+ * @param color 0 for white, 1 for black
+ * @return Bitboard The squares of all of that color's pieces
+ */
+Bitboard GameState::colorPieces(int color) const {
+    const Bitboard* pieces = pieceBitboards + color * EvalTables::PIECE_TYPES;
+    return pieces[0] | pieces[1] | pieces[2] | pieces[3] | pieces[4] | pieces[5];
+}
+
+/**
+ * @brief Gets the attack maps of the current position
+ *
+ * makeMove() and undoMove() mark the cached maps stale; a null move keeps
+ * them, since attacks don't depend on the side to move.
+ *
+ * @return const AttackMaps& Squares attacked by each piece and color
+ */
+const AttackMaps& GameState::attackMaps() {
+    if (!attackCacheValid) {
+        attackCache.build(*this);
+        attackCacheValid = true;
+    }
+    return attackCache;
 }
 
 /**
@@ -584,17 +1635,17 @@ void GameState::getPawnMoves(int row, int col, QVector<Move>& moves) {
     // Determine move direction and start row based on color
     int moveAmount = (whiteToMove) ? -1 : 1;
     int startRow = (whiteToMove) ? 6 : 1;
-    QString enemyColor = (whiteToMove) ? "b" : "w";
+    QChar enemyColor = (whiteToMove) ? 'b' : 'w';
     QPair<int, int> kingPos = (whiteToMove) ? whiteKingLocation : blackKingLocation;
 
     // Forward move
     if (row + moveAmount >= 0 && row + moveAmount <= 7) {
-        if (board[row + moveAmount][col] == "--") {
+        if (board[row + moveAmount][col] == EMPTY_SQUARE) {
             if (!piecePinned || pinDirection == qMakePair(moveAmount, 0)) {
                 moves.push_back(Move(qMakePair(row, col), qMakePair(row + moveAmount, col), board));
 
                 // Two square pawn advance
-                if (row == startRow && board[row + 2 * moveAmount][col] == "--") {
+                if (row == startRow && board[row + 2 * moveAmount][col] == EMPTY_SQUARE) {
                     moves.push_back(Move(qMakePair(row, col), qMakePair(row + 2 * moveAmount, col), board));
                 }
             }
@@ -603,7 +1654,7 @@ void GameState::getPawnMoves(int row, int col, QVector<Move>& moves) {
         // Captures to the left
         if (col - 1 >= 0) {
             if (!piecePinned || pinDirection == qMakePair(moveAmount, -1)) {
-                if (board[row + moveAmount][col - 1][0] == enemyColor[0]) {
+                if (board[row + moveAmount][col - 1][0] == enemyColor) {
                     moves.push_back(Move(qMakePair(row, col), qMakePair(row + moveAmount, col - 1), board));
                 }
 
@@ -617,18 +1668,18 @@ void GameState::getPawnMoves(int row, int col, QVector<Move>& moves) {
                         if (kingPos.second < col) { // King is left of the pawn
                             // Check between king and pawn
                             for (int i = kingPos.second + 1; i < col - 1; i++) {
-                                if (board[row][i] != "--") {
+                                if (board[row][i] != EMPTY_SQUARE) {
                                     blockingPiece = true;
                                     break;
                                 }
                             }
                             // Check outside of pawn
                             for (int i = col + 1; i < 8; i++) {
-                                QString square = board[row][i];
-                                if (square[0] == enemyColor[0] && (square[1] == 'R' || square[1] == 'Q')) {
+                                const QString& square = board[row][i];
+                                if (square[0] == enemyColor && (square[1] == 'R' || square[1] == 'Q')) {
                                     attackingPiece = true;
                                     break;
-                                } else if (square != "--") {
+                                } else if (square != EMPTY_SQUARE) {
                                     blockingPiece = true;
                                     break;
                                 }
@@ -636,18 +1687,18 @@ void GameState::getPawnMoves(int row, int col, QVector<Move>& moves) {
                         } else { // King is right of the pawn
                             // Check between king and pawn
                             for (int i = kingPos.second - 1; i > col; i--) {
-                                if (board[row][i] != "--") {
+                                if (board[row][i] != EMPTY_SQUARE) {
                                     blockingPiece = true;
                                     break;
                                 }
                             }
                             // Check outside of pawn
                             for (int i = col - 2; i >= 0; i--) {
-                                QString square = board[row][i];
-                                if (square[0] == enemyColor[0] && (square[1] == 'R' || square[1] == 'Q')) {
+                                const QString& square = board[row][i];
+                                if (square[0] == enemyColor && (square[1] == 'R' || square[1] == 'Q')) {
                                     attackingPiece = true;
                                     break;
-                                } else if (square != "--") {
+                                } else if (square != EMPTY_SQUARE) {
                                     blockingPiece = true;
                                     break;
                                 }
@@ -665,7 +1716,7 @@ void GameState::getPawnMoves(int row, int col, QVector<Move>& moves) {
         // Captures to the right
         if (col + 1 <= 7) {
             if (!piecePinned || pinDirection == qMakePair(moveAmount, 1)) {
-                if (board[row + moveAmount][col + 1][0] == enemyColor[0]) {
+                if (board[row + moveAmount][col + 1][0] == enemyColor) {
                     moves.push_back(Move(qMakePair(row, col), qMakePair(row + moveAmount, col + 1), board));
                 }
 
@@ -679,18 +1730,18 @@ void GameState::getPawnMoves(int row, int col, QVector<Move>& moves) {
                         if (kingPos.second < col) { // King is left of the pawn
                             // Check between king and pawn
                             for (int i = kingPos.second + 1; i < col; i++) {
-                                if (board[row][i] != "--") {
+                                if (board[row][i] != EMPTY_SQUARE) {
                                     blockingPiece = true;
                                     break;
                                 }
                             }
                             // Check outside of pawn
                             for (int i = col + 2; i < 8; i++) {
-                                QString square = board[row][i];
-                                if (square[0] == enemyColor[0] && (square[1] == 'R' || square[1] == 'Q')) {
+                                const QString& square = board[row][i];
+                                if (square[0] == enemyColor && (square[1] == 'R' || square[1] == 'Q')) {
                                     attackingPiece = true;
                                     break;
-                                } else if (square != "--") {
+                                } else if (square != EMPTY_SQUARE) {
                                     blockingPiece = true;
                                     break;
                                 }
@@ -698,18 +1749,18 @@ void GameState::getPawnMoves(int row, int col, QVector<Move>& moves) {
                         } else { // King is right of the pawn
                             // Check between king and pawn
                             for (int i = kingPos.second - 1; i > col + 1; i--) {
-                                if (board[row][i] != "--") {
+                                if (board[row][i] != EMPTY_SQUARE) {
                                     blockingPiece = true;
                                     break;
                                 }
                             }
                             // Check outside of pawn
                             for (int i = col - 1; i >= 0; i--) {
-                                QString square = board[row][i];
-                                if (square[0] == enemyColor[0] && (square[1] == 'R' || square[1] == 'Q')) {
+                                const QString& square = board[row][i];
+                                if (square[0] == enemyColor && (square[1] == 'R' || square[1] == 'Q')) {
                                     attackingPiece = true;
                                     break;
-                                } else if (square != "--") {
+                                } else if (square != EMPTY_SQUARE) {
                                     blockingPiece = true;
                                     break;
                                 }
@@ -754,10 +1805,9 @@ void GameState::getRookMoves(int row, int col, QVector<Move>& moves) {
     }
 
     // Rook move directions (up, left, down, right)
-    QVector<QPair<int, int>> directions = {{-1, 0}, {0, -1}, {1, 0}, {0, 1}};
-    QString enemyColor = (whiteToMove) ? "b" : "w";
+    QChar enemyColor = (whiteToMove) ? 'b' : 'w';
 
-    for (const auto& d : directions) {
+    for (const auto& d : ROOK_DIRECTIONS) {
         for (int i = 1; i < 8; i++) {
             int endRow = row + d.first * i;
             int endCol = col + d.second * i;
@@ -769,10 +1819,10 @@ void GameState::getRookMoves(int row, int col, QVector<Move>& moves) {
                     pinDirection == d ||
                     pinDirection == qMakePair(-d.first, -d.second)) {
 
-                    QString endPiece = board[endRow][endCol];
-                    if (endPiece == "--") {  // Empty square
+                    const QString& endPiece = board[endRow][endCol];
+                    if (endPiece == EMPTY_SQUARE) {  // Empty square
                         moves.push_back(Move(qMakePair(row, col), qMakePair(endRow, endCol), board));
-                    } else if (endPiece[0] == enemyColor[0]) {  // Capture
+                    } else if (endPiece[0] == enemyColor) {  // Capture
                         moves.push_back(Move(qMakePair(row, col), qMakePair(endRow, endCol), board));
                         break;  // Can't move past a piece
                     } else {  // Friendly piece
@@ -811,10 +1861,9 @@ void GameState::getBishopMoves(int row, int col, QVector<Move>& moves) {
     }
 
     // Bishop move directions (diagonals)
-    QVector<QPair<int, int>> directions = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
-    QString enemyColor = (whiteToMove) ? "b" : "w";
+    QChar enemyColor = (whiteToMove) ? 'b' : 'w';
 
-    for (const auto& d : directions) {
+    for (const auto& d : BISHOP_DIRECTIONS) {
         for (int i = 1; i < 8; i++) {
             int endRow = row + d.first * i;
             int endCol = col + d.second * i;
@@ -826,10 +1875,10 @@ void GameState::getBishopMoves(int row, int col, QVector<Move>& moves) {
                     pinDirection == d ||
                     pinDirection == qMakePair(-d.first, -d.second)) {
 
-                    QString endPiece = board[endRow][endCol];
-                    if (endPiece == "--") {  // Empty square
+                    const QString& endPiece = board[endRow][endCol];
+                    if (endPiece == EMPTY_SQUARE) {  // Empty square
                         moves.push_back(Move(qMakePair(row, col), qMakePair(endRow, endCol), board));
-                    } else if (endPiece[0] == enemyColor[0]) {  // Capture
+                    } else if (endPiece[0] == enemyColor) {  // Capture
                         moves.push_back(Move(qMakePair(row, col), qMakePair(endRow, endCol), board));
                         break;  // Can't move past a piece
                     } else {  // Friendly piece
@@ -866,22 +1915,17 @@ void GameState::getKnightMoves(int row, int col, QVector<Move>& moves) {
     }
     
     // Knight move patterns (L shapes)
-    QVector<QPair<int, int>> knightMoves = {
-        {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
-        {1, -2}, {1, 2}, {2, -1}, {2, 1}
-    };
-    
-    QString teamColor = (whiteToMove) ? "w" : "b";
+    QChar teamColor = (whiteToMove) ? 'w' : 'b';
     
-    for (const auto& m : knightMoves) {
+    for (const auto& m : KNIGHT_JUMPS) {
         int endRow = row + m.first;
         int endCol = col + m.second;
         
         // Check if square is on the board
         if (endRow >= 0 && endRow <= 7 && endCol >= 0 && endCol <= 7) {
             if (!piecePinned) {  // Pinned knights can't move
-                QString endPiece = board[endRow][endCol];
-                if (endPiece[0] != teamColor[0]) {  // Not a friendly piece
+                const QString& endPiece = board[endRow][endCol];
+                if (endPiece[0] != teamColor) {  // Not a friendly piece
                     moves.push_back(Move(qMakePair(row, col), qMakePair(endRow, endCol), board));
                 }
             }
@@ -908,52 +1952,30 @@ void GameState::getQueenMoves(int row, int col, QVector<Move>& moves) {
  * @brief Generates all valid king moves from a position
  * 
  * Handles king moves to all eight adjacent squares.
- * Ensures moves don't put the king in check.
+ * Ensures moves don't put the king in check: the target square must not
+ * be attacked once the king has left its square, so sliders see through it.
  * 
  * @param row The king's current row
  * @param col The king's current column
  * @param moves The vector to add valid moves to
  */
 void GameState::getKingMoves(int row, int col, QVector<Move>& moves) {
-    // King move patterns (all adjacent squares)
-    QVector<QPair<int, int>> kingMoves = {
-        {-1, -1}, {-1, 0}, {-1, 1},
-        {0, -1}, {0, 1},
-        {1, -1}, {1, 0}, {1, 1}
-    };
-
-    QString teamColor = (whiteToMove) ? "w" : "b";
+    QChar teamColor = (whiteToMove) ? 'w' : 'b';
+    Bitboard enemies = colorPieces(whiteToMove ? 1 : 0);
+    Bitboard occupied = (colorPieces(0) | colorPieces(1)) & ~Bitboards::squareBit(row * 8 + col);
 
-    for (const auto& m : kingMoves) {
+    for (const auto& m : KING_STEPS) {
         int endRow = row + m.first;
         int endCol = col + m.second;
 
         // Check if square is on the board
         if (endRow >= 0 && endRow <= 7 && endCol >= 0 && endCol <= 7) {
-            QString endPiece = board[endRow][endCol];
-            if (endPiece[0] != teamColor[0]) {  // Not a friendly piece
-                // Temporarily move king to check if the move is safe
-                if (whiteToMove) {
-                    whiteKingLocation = qMakePair(endRow, endCol);
-                } else {
-                    blackKingLocation = qMakePair(endRow, endCol);
-                }
-
-                // Get in-check status after the move
-                PinsAndChecksInfo pinCheckTuple = checkForPinsAndChecks();
-                bool inCheck = pinCheckTuple.inCheck;
-
+            const QString& endPiece = board[endRow][endCol];
+            if (endPiece[0] != teamColor) {  // Not a friendly piece
                 // If the move doesn't put king in check, it's valid
-                if (!inCheck) {
+                if (!(attackersTo(endRow * 8 + endCol, occupied) & enemies)) {
                     moves.push_back(Move(qMakePair(row, col), qMakePair(endRow, endCol), board));
                 }
-
-                // Restore king position
-                if (whiteToMove) {
-                    whiteKingLocation = qMakePair(row, col);
-                } else {
-                    blackKingLocation = qMakePair(row, col);
-                }
             }
         }
     }
@@ -1001,7 +2023,7 @@ void GameState::getKingsideCastleMoves(int row, int col, QVector<Move>& moves) {
     }
 
     // Check if squares between king and rook are empty
-    if (board[row][col + 1] == "--" && board[row][col + 2] == "--") {
+    if (board[row][col + 1] == EMPTY_SQUARE && board[row][col + 2] == EMPTY_SQUARE) {
         // Check if squares king moves through are not under attack
         if (!squareUnderAttack(row, col + 1) && !squareUnderAttack(row, col + 2)) {
             moves.push_back(Move(qMakePair(row, col), qMakePair(row, col + 2), board, false, true));
@@ -1024,7 +2046,7 @@ void GameState::getQueensideCastleMoves(int row, int col, QVector<Move>& moves)
     }
 
     // Check if squares between king and rook are empty
-    if (board[row][col - 1] == "--" && board[row][col - 2] == "--" && board[row][col - 3] == "--") {
+    if (board[row][col - 1] == EMPTY_SQUARE && board[row][col - 2] == EMPTY_SQUARE && board[row][col - 3] == EMPTY_SQUARE) {
         // Check if squares king moves through are not under attack
         if (!squareUnderAttack(row, col - 1) && !squareUnderAttack(row, col - 2)) {
             moves.push_back(Move(qMakePair(row, col), qMakePair(row, col - 2), board, false, true));
@@ -1054,19 +2076,20 @@ Move::Move(QPair<int, int> startSq, QPair<int, int> endSq, const QVector<QVector
     pieceCaptured = board[endRow][endCol];
 
     // Pawn promotion
-    isPawnPromotion = (pieceMoved == "wp" && endRow == 0) || (pieceMoved == "bp" && endRow == 7);
+    isPawnPromotion = (pieceMoved == QLatin1String("wp") && endRow == 0) || (pieceMoved == QLatin1String("bp") && endRow == 7);
 
     // En passant
     this->isEnpassantMove = isEnpassantMove;
     if (isEnpassantMove) {
-        pieceCaptured = (pieceMoved == "wp") ? "bp" : "wp";
+        // The captured pawn stands beside the moving one
+        pieceCaptured = board[startRow][endCol];
     }
 
     // Castling
     this->isCastleMove = isCastleMove;
 
     // Capture flag
-    isCapture = (pieceCaptured != "--");
+    isCapture = (pieceCaptured != GameState::EMPTY_SQUARE);
 
     // Unique move ID for comparison
     moveID = startRow * 1000 + startCol * 100 + endRow * 10 + endCol;
@@ -5,7 +5,9 @@
 #include <QVector>
 #include <QPair>
 #include <QMap>
-#include <functional>
+#include "nnue.h"
+#include "bitboard.h"
+#include "attackmaps.h"
 
 // Forward declaration
 class Move;
@@ -127,6 +129,27 @@ public:
      */
     GameState();
 
+    /**
+     * @brief Sets up the position described by a FEN string
+     *
+     * Replaces the board, side to move, castling rights, en passant
+     * square and halfmove clock with those given in the FEN record, and
+     * clears the move log. The fullmove counter is accepted but ignored.
+     *
+     * @param fen Position in Forsyth-Edwards Notation
+     * @return True if the FEN was parsed, false if it was malformed
+     */
+    bool loadFen(const QString& fen);
+
+    /** @brief Contents of an empty square, shared so that clearing a square copies instead of converting "--" */
+    static const QString EMPTY_SQUARE;
+
+    /** @brief White queen, shared by promotions */
+    static const QString WHITE_QUEEN;
+
+    /** @brief Black queen, shared by promotions */
+    static const QString BLACK_QUEEN;
+
     /**
      * @brief 8×8 board representation
      *
@@ -153,6 +176,14 @@ public:
     
     /** @brief Flag indicating if the current position is stalemate */
     bool stalemate;
+
+    /**
+     * @brief Flag indicating if the game is drawn by threefold repetition or the fifty-move rule
+     *
+     * Set by getValidMoves() when the side to move has a legal move; a
+     * checkmate on the hundredth halfmove still counts as checkmate.
+     */
+    bool draw;
     
     /** @brief Flag indicating if the current player is in check */
     bool inCheck;
@@ -175,11 +206,92 @@ public:
     /** @brief History of castling rights for all game positions */
     QVector<CastleRights> castlingRightsLog;
 
+    /**
+     * @brief Halfmoves since the last capture or pawn move
+     *
+     * Positions further back can never repeat, so repetition checks stop
+     * there. A null move also restarts the count, so the search never
+     * counts a repetition across one.
+     */
+    int halfmoveClock;
+
+    /** @brief History of halfmove clocks for all game positions */
+    QVector<int> halfmoveClockLog;
+
+    /** @brief Zobrist hash of the current position (pieces, side, castling, en passant) */
+    quint64 zobristKey;
+    
+    /** @brief History of Zobrist hashes for all game positions */
+    QVector<quint64> zobristKeyLog;
+
+    /** @brief Zobrist hash of the pawns alone, used to index the pawn hash table */
+    quint64 pawnKey;
+    
+    /** @brief History of pawn hashes for all game positions */
+    QVector<quint64> pawnKeyLog;
+
+    /**
+     * @brief Count of every piece, four bits per piece (color * 6 + type)
+     *
+     * Positions with the same material share a key, which indexes the
+     * material hash table.
+     */
+    quint64 materialKey;
+    
+    /** @brief History of material keys for all game positions */
+    QVector<quint64> materialKeyLog;
+
+    /** @brief Material balance in centipawns (white minus black), kept up to date by makeMove() */
+    int materialScore;
+    
+    /** @brief History of material balances for all game positions */
+    QVector<int> materialScoreLog;
+    
+    /**
+     * @brief Piece-square balance (white minus black) as a packed midgame/endgame score
+     *
+     * See EvalTables::makeScore(); the two halves are blended by gamePhase.
+     */
+    int positionScore;
+    
+    /** @brief History of piece-square balances for all game positions */
+    QVector<int> positionScoreLog;
+
+    /**
+     * @brief Game phase from non-pawn material
+     *
+     * EvalTables::TOTAL_PHASE with all pieces on the board, falling to 0
+     * as knights, bishops, rooks and queens are traded. Promotions can
+     * push it above the total.
+     */
+    int gamePhase;
+    
+    /** @brief History of game phases for all game positions */
+    QVector<int> gamePhaseLog;
+
+    /** @brief Network whose accumulator is maintained, or nullptr */
+    const NnueNetwork* network;
+
+    /** @brief First-layer activations of network for the current position */
+    NnueAccumulator accumulator;
+
+    /** @brief Network input changes of every move, so undoMove() can revert them */
+    QVector<NnueDelta> nnueDeltaLog;
+
+    /**
+     * @brief Squares of each piece (color * 6 + type), kept up to date by makeMove()
+     *
+     * Mirrors board for the attack maps and exchange evaluation, which work
+     * on whole sets of squares at once.
+     */
+    Bitboard pieceBitboards[12];
+
     /**
      * @brief Makes a move on the board
      *
      * Updates the board position, handles special moves (castling, en passant, promotion),
-     * updates game state variables, and logs the move.
+     * updates game state variables, and logs the move. The Zobrist hash and the
+     * material and piece-square totals are updated incrementally.
      *
      * @param move The move to make
      */
@@ -193,6 +305,23 @@ public:
      */
     void undoMove();
     
+    /**
+     * @brief Passes the turn without moving a piece
+     *
+     * Flips the side to move, clears the en passant square and updates the
+     * hash, pushing the same log entries as makeMove() so the position can
+     * be restored with undoNullMove(). The move log is left untouched.
+     * Only used by the search; never call it while in check.
+     */
+    void makeNullMove();
+    
+    /**
+     * @brief Undoes a null move made with makeNullMove()
+     *
+     * Restores the side to move, en passant square, castling rights and hash.
+     */
+    void undoNullMove();
+    
     /**
      * @brief Updates castling rights after a move
      *
@@ -212,6 +341,17 @@ public:
      * @return A vector of all valid moves
      */
     QVector<Move> getValidMoves();
+
+    /**
+     * @brief Gets all valid moves for the current position into a caller-owned list
+     *
+     * Same as getValidMoves(), but the list is cleared and refilled
+     * without giving up its capacity, so a search that keeps one list
+     * per ply generates moves without allocating.
+     *
+     * @param moves Receives the valid moves
+     */
+    void getValidMoves(QVector<Move>& moves);
     
     /**
      * @brief Gets all possible moves without considering check
@@ -223,6 +363,23 @@ public:
      */
     QVector<Move> getAllPossibleMoves();
 
+    /**
+     * @brief Appends all possible moves, without considering check, to a list
+     *
+     * @param moves The vector to add the moves to
+     */
+    void getAllPossibleMoves(QVector<Move>& moves);
+
+    /**
+     * @brief Reserves room in the logs for a number of further moves
+     *
+     * The search calls this before it starts, so that making moves
+     * inside the tree never has to grow the logs.
+     *
+     * @param plies Number of moves (or null moves) to make room for
+     */
+    void reserveHistory(int plies);
+
     /**
      * @brief Checks if the current player is in check
      *
@@ -249,7 +406,211 @@ public:
      */
     PinsAndChecksInfo checkForPinsAndChecks();
 
+    /**
+     * @brief Checks whether a side has any pieces besides pawns and its king
+     *
+     * Positions without such material are prone to zugzwang, so the search
+     * does not try null moves in them.
+     *
+     * @param white True to check white's pieces, false for black's
+     * @return True if the side has a knight, bishop, rook or queen
+     */
+    bool hasNonPawnMaterial(bool white) const;
+
+    /**
+     * @brief Checks whether the current position occurred before
+     *
+     * Only positions since the last irreversible move, with the same side
+     * to move, are compared. The search treats a single repetition as a
+     * draw, since the side that could avoid it would have done so.
+     *
+     * @return True if the Zobrist hash matches an earlier position
+     */
+    bool isRepetition() const;
+
+    /**
+     * @brief Counts earlier occurrences of the current position
+     *
+     * @return Number of earlier positions since the last irreversible move with the same hash
+     */
+    int repetitionCount() const;
+
+    /**
+     * @brief Checks whether the side to move can repeat a position of the search
+     *
+     * Looks for a single reversible move that returns to a position seen
+     * an odd number of plies ago, using cuckoo hash tables of the Zobrist
+     * differences of every piece move on an empty board. Only positions
+     * inside the current search (fewer than ply plies back) count, so the
+     * result is a draw the side to move can claim, not a game-history
+     * repetition.
+     *
+     * @param ply Distance of the current position from the search root
+     * @return True if a move to an earlier search position exists
+     */
+    bool hasUpcomingRepetition(int ply) const;
+
+    /**
+     * @brief Gets every piece of either color that attacks a square
+     *
+     * Sliders are blocked by the given occupancy rather than the board, so
+     * pieces removed from occupied reveal the sliders behind them (x-rays).
+     *
+     * @param square Target square (row * 8 + col)
+     * @param occupied Squares treated as occupied
+     * @return The squares of the attacking pieces
+     */
+    Bitboard attackersTo(int square, Bitboard occupied) const;
+
+    /**
+     * @brief Static exchange evaluation of a move
+     *
+     * Plays out the sequence of captures on the move's destination square,
+     * each side recapturing with its least valuable attacker and free to
+     * stop when continuing would lose material. Promotion to a queen and
+     * en passant are taken into account for the move itself; pins are not.
+     *
+     * @param move Move to evaluate (a capture, promotion or quiet move)
+     * @return Material gained by the side making the move, in centipawns
+     */
+    int see(const Move& move) const;
+
+    /**
+     * @brief Checks whether a move's static exchange value reaches a threshold
+     *
+     * Gives the same answer as see(move) >= threshold, but stops as soon as
+     * the outcome is certain.
+     *
+     * @param move Move to evaluate
+     * @param threshold Material balance to test against, in centipawns
+     * @return True if the exchange gains at least threshold
+     */
+    bool seeGe(const Move& move, int threshold) const;
+
+    /**
+     * @brief Computes the Zobrist hash of the current position from scratch
+     *
+     * makeMove() and undoMove() keep zobristKey up to date incrementally;
+     * this is used to initialise it and to verify it.
+     *
+     * @return The hash of the board, side to move, castling rights and en passant square
+     */
+    quint64 computeZobristKey() const;
+
+    /**
+     * @brief Computes the pawn-structure hash from scratch
+     *
+     * makeMove() and undoMove() keep pawnKey up to date incrementally;
+     * this is used to initialise it and to verify it.
+     *
+     * @return The hash of the pawns on the board
+     */
+    quint64 computePawnKey() const;
+
+    /**
+     * @brief Computes the material key from scratch
+     *
+     * makeMove() and undoMove() keep materialKey up to date incrementally;
+     * this is used to initialise it and to verify it.
+     *
+     * @return The piece counts packed four bits per piece
+     */
+    quint64 computeMaterialKey() const;
+
+    /**
+     * @brief Computes the material balance from scratch
+     *
+     * makeMove() and undoMove() keep materialScore up to date incrementally;
+     * this is used to initialise it and to verify it.
+     *
+     * @return White's material minus black's, in centipawns
+     */
+    int computeMaterialScore() const;
+
+    /**
+     * @brief Computes the piece-square balance from scratch
+     *
+     * makeMove() and undoMove() keep positionScore up to date incrementally;
+     * this is used to initialise it and to verify it.
+     *
+     * @return White's packed midgame/endgame positional bonus minus black's
+     */
+    int computePositionScore() const;
+
+    /**
+     * @brief Computes the game phase from scratch
+     *
+     * makeMove() and undoMove() keep gamePhase up to date incrementally;
+     * this is used to initialise it and to verify it.
+     *
+     * @return Sum of the phase weights of the knights, bishops, rooks and queens
+     */
+    int computeGamePhase() const;
+
+    /**
+     * @brief Computes the squares of one piece from scratch
+     *
+     * makeMove() and undoMove() keep pieceBitboards up to date incrementally;
+     * this is used to initialise them and to verify them.
+     *
+     * @param piece Piece index (color * 6 + type)
+     * @return The squares holding that piece
+     */
+    Bitboard computePieceBitboard(int piece) const;
+
+    /**
+     * @brief Gets the squares occupied by one color
+     *
+     * @param color 0 for white, 1 for black
+     * @return The squares of all of that color's pieces
+     */
+    Bitboard colorPieces(int color) const;
+
+    /**
+     * @brief Gets the attack maps of the current position
+     *
+     * The maps are built on the first call after the position changes and
+     * reused until the next move, so the evaluation and the search share
+     * a single build per node.
+     *
+     * @return Squares attacked by each piece and color, with derived terms
+     */
+    const AttackMaps& attackMaps();
+
+    /**
+     * @brief Selects the network whose accumulator makeMove() keeps up to date
+     *
+     * @param net Network to use, or nullptr to stop maintaining the accumulator
+     */
+    void setNetwork(const NnueNetwork* net);
+
 private:
+    /** @brief Attack maps returned by attackMaps() */
+    AttackMaps attackCache;
+
+    /** @brief Whether attackCache describes the current position */
+    bool attackCacheValid;
+
+    /**
+     * @brief Finds a side's least valuable piece among a set of attackers
+     *
+     * @param attackers Attacking pieces of both colors
+     * @param color 0 for white, 1 for black
+     * @param type Receives the piece type index of the attacker found
+     * @return The attacker's square bit, or 0 if the side has none
+     */
+    Bitboard leastValuableAttacker(Bitboard attackers, int color, int& type) const;
+
+    /**
+     * @brief Sets up the exchange on a move's destination square
+     *
+     * @param move The move starting the exchange
+     * @param occupied Receives the occupancy after the move
+     * @param gain Receives the material won by the move itself
+     * @param pieceValue Receives the value of the piece left on the square
+     */
+    void seeInitialise(const Move& move, Bitboard& occupied, int& gain, int& pieceValue) const;
+
     /**
      * @brief Generates all valid pawn moves from a position
      *
@@ -356,12 +717,16 @@ private:
     void getQueensideCastleMoves(int row, int col, QVector<Move>& moves);
 
     /**
-     * @brief Map of move functions for each piece type
+     * @brief Finds the pins on and checks against the side to move's king
+     *
+     * Shared by checkForPinsAndChecks() and getValidMoves(); the lists are
+     * cleared first but keep their capacity.
      *
-     * Uses the piece character as key (e.g., 'p', 'R', 'N')
-     * and maps to the corresponding move generation function.
+     * @param pinList Receives the pinned pieces and their pin directions
+     * @param checkList Receives the checking pieces and their directions
+     * @return True if the king is in check
      */
-    QMap<QChar, std::function<void(int, int, QVector<Move>&)>> moveFunctions;
+    bool collectPinsAndChecks(QVector<PinInfo>& pinList, QVector<PinInfo>& checkList);
 };
 
 /**
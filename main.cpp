@@ -12,6 +12,8 @@
 #include "mainwindow.h"
 #include <QApplication>
 #include "gamestate.h"
+#include "chessai.h"
+#include "bench.h"
 
 /**
  * @brief Main application entry point
@@ -20,11 +22,64 @@
  * type for cross-thread communication, sets up application metadata,
  * and launches the main window.
  * 
+ * Running "ChessGame bench [depth]" searches the benchmark positions to a
+ * fixed depth and prints the total node count and nodes per second,
+ * without opening a window. "ChessGame pvscompare [depth]" prints a node-count
+ * comparison of plain alpha-beta and principal variation search on the
+ * benchmark positions. "ChessGame nnuecheck
+ * [weights]" checks the neural network kernels against the scalar
+ * reference code, using random weights if no file is given.
+ * "ChessGame alloccheck [depth]" checks that the search makes no heap
+ * allocations, in builds with MITTENS_ALLOC_CHECK defined.
+ * "ChessGame multipv [depth] [lines]" compares a MultiPV search with one
+ * search per line. "ChessGame tbgen [pieces] [directory]"
+ * builds the endgame tables into the directory the AI maps them from.
+ * "ChessGame syzygy [path] [fen]" probes a position, or a few endings,
+ * in the Syzygy tables; without a FEN it also checks them against the
+ * endgame tablebase. If CHESSGAME_SEARCH_LOG is set, the AI appends a line of
+ * JSON per completed search iteration to the file it names. If
+ * CHESSGAME_SEED is set, the AI's random choices follow that seed.
+ * CHESSGAME_SYZYGY_PATH gives the directories of the Syzygy tables, and
+ * CHESSGAME_SYZYGY_PIECES the most pieces of a position probed in them;
+ * the search only uses them if CHESSGAME_SYZYGY_SEARCH is set.
+ * 
  * @param argc Command line argument count
  * @param argv Command line argument values
  * @return Application exit code
  */
 int main(int argc, char *argv[]) {
+    // Command-line benchmarks and checks (no GUI)
+    if (argc > 1 && qstrcmp(argv[1], "bench") == 0) {
+        int depth = (argc > 2) ? QString(argv[2]).toInt() : ChessAI::DEPTH + 2;
+        return Bench::run(depth);
+    }
+    if (argc > 1 && qstrcmp(argv[1], "pvscompare") == 0) {
+        int depth = (argc > 2) ? QString(argv[2]).toInt() : ChessAI::DEPTH;
+        return Bench::comparePvsNodeCounts(depth);
+    }
+    if (argc > 1 && qstrcmp(argv[1], "nnuecheck") == 0) {
+        return Bench::verifyNnue((argc > 2) ? QString(argv[2]) : QString());
+    }
+    if (argc > 1 && qstrcmp(argv[1], "alloccheck") == 0) {
+        int depth = (argc > 2) ? QString(argv[2]).toInt() : ChessAI::DEPTH + 1;
+        return Bench::checkSearchAllocations(depth);
+    }
+    if (argc > 1 && qstrcmp(argv[1], "multipv") == 0) {
+        int depth = (argc > 2) ? QString(argv[2]).toInt() : ChessAI::DEPTH + 2;
+        int lineCount = (argc > 3) ? QString(argv[3]).toInt() : 3;
+        return Bench::compareMultiPv(depth, lineCount);
+    }
+    if (argc > 1 && qstrcmp(argv[1], "tbgen") == 0) {
+        int pieces = (argc > 2) ? QString(argv[2]).toInt() : EndgameTablebase::MAX_PIECES;
+        QString directory = (argc > 3) ? QString(argv[3]) : QString(ChessAI::TABLEBASE_DIR);
+        return Bench::generateTablebases(pieces, directory);
+    }
+    if (argc > 1 && qstrcmp(argv[1], "syzygy") == 0) {
+        QString path = (argc > 2) ? QString(argv[2]) : qEnvironmentVariable("CHESSGAME_SYZYGY_PATH");
+        QString fen = (argc > 3) ? QString(argv[3]) : QString();
+        return Bench::probeSyzygy(path, fen);
+    }
+
     // Create Qt application
     QApplication app(argc, argv);
     
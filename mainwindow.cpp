@@ -50,6 +50,7 @@ MainWindow::~MainWindow() {
  * - The chess board
  * - Game mode selection (Human vs Human, Human vs AI)
  * - Color choice for AI games (Play as White/Black)
+ * - AI skill level, full strength by default
  * - Connects signals and slots for UI interaction
  */
 void MainWindow::setupUI() {
@@ -80,12 +81,24 @@ void MainWindow::setupUI() {
     colorChoice->addButton(playBlackRadio, 1);
     playWhiteRadio->setChecked(true);
 
+    // Create skill level choice, from the weakest level to full strength
+    skillLevelLabel = new QLabel("AI level:", this);
+    skillLevelBox = new QComboBox(this);
+    for (int level = 1; level < ChessAI::MAX_SKILL_LEVEL; level++) {
+        skillLevelBox->addItem(QString::number(level));
+    }
+    skillLevelBox->addItem(QString("%1 (full strength)").arg(ChessAI::MAX_SKILL_LEVEL));
+    skillLevelBox->setCurrentIndex(ChessAI::MAX_SKILL_LEVEL - 1);
+
     // Add radio buttons to control layout
     controlLayout->addWidget(humanVsHumanRadio);
     controlLayout->addWidget(humanVsAiRadio);
     controlLayout->addSpacing(20);
     controlLayout->addWidget(playWhiteRadio);
     controlLayout->addWidget(playBlackRadio);
+    controlLayout->addSpacing(20);
+    controlLayout->addWidget(skillLevelLabel);
+    controlLayout->addWidget(skillLevelBox);
     controlLayout->addStretch();
 
     // Add control layout to main layout
@@ -99,6 +112,8 @@ void MainWindow::setupUI() {
         this, &MainWindow::onGameModeChanged);
     connect(colorChoice, &QButtonGroup::idClicked,
         this, &MainWindow::onColorChoiceChanged);
+    connect(skillLevelBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+        this, &MainWindow::onSkillLevelChanged);
     
     // Disable color choice initially (for Human vs Human mode)
     playWhiteRadio->setEnabled(false);
@@ -179,6 +194,15 @@ void MainWindow::onColorChoiceChanged(int id) {
     }
 }
 
+/**
+ * @brief Handles changes to the AI skill level
+ *
+ * @param index Index of the selected entry (0: level 1)
+ */
+void MainWindow::onSkillLevelChanged(int index) {
+    chessBoard->setSkillLevel(index + 1);
+}
+
 /**
  * @brief Starts a new chess game
  *
@@ -20,6 +20,7 @@
 #include <QLabel>
 #include <QButtonGroup>
 #include <QRadioButton>
+#include <QComboBox>
 #include "chessboard.h"
 
 /**
@@ -31,6 +32,7 @@
  * - Menu system with game controls
  * - Game mode selection (Human vs Human, Human vs AI)
  * - Color selection for AI games
+ * - AI skill level selection
  *
  * @author Group 69 (mittensOS)
  */
@@ -84,6 +86,12 @@ private:
     
     /** @brief Radio button for playing as black */
     QRadioButton* playBlackRadio;
+
+    /** @brief Label of the AI skill level choice */
+    QLabel* skillLevelLabel;
+
+    /** @brief Choice of the AI skill level */
+    QComboBox* skillLevelBox;
     
     // Menu Actions
     /** @brief Action for starting a new game */
@@ -143,6 +151,13 @@ private slots:
      * @param id ID of the selected radio button (0: Play as White, 1: Play as Black)
      */
     void onColorChoiceChanged(int id);
+
+    /**
+     * @brief Handles changes to the AI skill level
+     *
+     * @param index Index of the selected entry (0: level 1)
+     */
+    void onSkillLevelChanged(int index);
     
     /**
      * @brief Starts a new chess game
@@ -0,0 +1,217 @@
+#include "material.h"
+#include "evaltables.h"
+
+namespace {
+
+/** @brief Bonus for owning both bishops */
+const int BISHOP_PAIR = EvalTables::makeScore(30, 50);
+
+/** @brief Change in a knight's value for each own pawn above five */
+const int KNIGHT_PAWN_ADJUSTMENT = EvalTables::makeScore(6, 6);
+
+/** @brief Change in a rook's value for each own pawn above five */
+const int ROOK_PAWN_ADJUSTMENT = EvalTables::makeScore(-12, -12);
+
+/** @brief Scale factor when neither side can be expected to win */
+const int DRAWISH_SCALE = 16;
+
+/** @brief Scale factor for opposite-coloured bishop endings */
+const int OPPOSITE_BISHOPS_SCALE = 32;
+
+/** @brief Bonus for a won ending against a bare king, on top of the material */
+const int KNOWN_WIN = 1000;
+
+/**
+ * @brief Gets the non-pawn material of one side from a material key
+ *
+ * @param key Material key
+ * @param color 0 for white, 1 for black
+ * @return Knight, bishop, rook and queen material in centipawns
+ */
+int nonPawnMaterial(quint64 key, int color) {
+    int material = 0;
+    for (int type = 1; type <= 4; type++) {
+        material += MaterialHashTable::pieceCount(key, color, type) * EvalTables::PIECE_TYPE_VALUES[type];
+    }
+    return material;
+}
+
+/**
+ * @brief Evaluates a position that is drawn whatever the pieces do
+ *
+ * @param gs Position to evaluate
+ * @return Always 0
+ */
+int evaluateDraw(const GameState& gs) {
+    Q_UNUSED(gs);
+    return 0;
+}
+
+/**
+ * @brief Evaluates mating material against a bare king
+ *
+ * The winning side is helped by driving the defending king to the edge of
+ * the board and bringing its own king closer.
+ *
+ * @param gs Position to evaluate
+ * @return Score in centipawns from white's perspective
+ */
+int evaluateKXK(const GameState& gs) {
+    bool whiteStrong = gs.materialScore > 0;
+    QPair<int, int> strongKing = whiteStrong ? gs.whiteKingLocation : gs.blackKingLocation;
+    QPair<int, int> weakKing = whiteStrong ? gs.blackKingLocation : gs.whiteKingLocation;
+
+    // 1 in the centre up to 7 on the edge
+    int edgeDistance = qMax(qAbs(2 * weakKing.first - 7), qAbs(2 * weakKing.second - 7));
+    int kingDistance = qAbs(strongKing.first - weakKing.first) + qAbs(strongKing.second - weakKing.second);
+
+    int score = KNOWN_WIN + qAbs(gs.materialScore) + 15 * edgeDistance + 10 * (14 - kingDistance);
+    return whiteStrong ? score : -score;
+}
+
+/**
+ * @brief Scales down endings with one bishop each on opposite colours
+ *
+ * @param gs Position to evaluate
+ * @return OPPOSITE_BISHOPS_SCALE if the bishops are on opposite colours,
+ *         otherwise MaterialEntry::NORMAL_SCALE
+ */
+int scaleOppositeBishops(const GameState& gs) {
+    int squareColor[2] = {-1, -1};
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            const QString& piece = gs.board[row][col];
+            if (piece[1] == 'B') {
+                squareColor[piece[0] == 'w' ? 0 : 1] = (row + col) % 2;
+            }
+        }
+    }
+    bool opposite = squareColor[0] >= 0 && squareColor[1] >= 0 && squareColor[0] != squareColor[1];
+    return opposite ? OPPOSITE_BISHOPS_SCALE : MaterialEntry::NORMAL_SCALE;
+}
+
+} // namespace
+
+/**
+ * @brief Constructor for the MaterialHashTable class
+ *
+ * Allocates all entries up front so that probing never allocates.
+ */
+MaterialHashTable::MaterialHashTable() : entries(SIZE) {
+}
+
+/**
+ * @brief Gets the material entry of a position
+ *
+ * @param gs Position to look up
+ * @return The entry for the position's material
+ */
+const MaterialEntry& MaterialHashTable::probe(const GameState& gs) {
+    int index = static_cast<int>((gs.materialKey * 0x9E3779B97F4A7C15ULL) >> 32) & (SIZE - 1);
+    MaterialEntry& entry = entries[index];
+    if (!entry.used || entry.key != gs.materialKey) {
+        entry = MaterialEntry();
+        entry.key = gs.materialKey;
+        entry.used = true;
+        analyse(gs.materialKey, entry);
+    }
+    return entry;
+}
+
+/**
+ * @brief Empties the table
+ */
+void MaterialHashTable::clear() {
+    entries.fill(MaterialEntry());
+}
+
+/**
+ * @brief Gets the count of one piece from a material key
+ *
+ * @param key Material key
+ * @param color 0 for white, 1 for black
+ * @param type Piece type index (pawn, knight, bishop, rook, queen, king)
+ * @return Number of such pieces
+ */
+int MaterialHashTable::pieceCount(quint64 key, int color, int type) {
+    return static_cast<int>((key >> (4 * (color * EvalTables::PIECE_TYPES + type))) & 15);
+}
+
+/**
+ * @brief Analyses a material configuration from its key
+ *
+ * Fills in:
+ * - the imbalance: bishop pair, and knights gaining and rooks losing
+ *   value as their own pawns increase
+ * - the game phase from the non-pawn pieces
+ * - an endgame evaluator for dead draws (no pawns and at most a minor
+ *   piece or two knights against a bare king) and for mating material
+ *   against a bare king
+ * - scale factors for a pawnless side that is up by no more than a minor
+ *   piece, and a scale function for opposite-coloured bishops
+ *
+ * @param key Material key
+ * @param entry Entry to fill in
+ */
+void MaterialHashTable::analyse(quint64 key, MaterialEntry& entry) {
+    int pawns[2], knights[2], bishops[2], rooks[2], queens[2], material[2];
+    for (int color = 0; color < 2; color++) {
+        pawns[color] = pieceCount(key, color, 0);
+        knights[color] = pieceCount(key, color, 1);
+        bishops[color] = pieceCount(key, color, 2);
+        rooks[color] = pieceCount(key, color, 3);
+        queens[color] = pieceCount(key, color, 4);
+        material[color] = nonPawnMaterial(key, color);
+    }
+
+    // Imbalance and phase
+    int score[2] = {0, 0};
+    int phase = 0;
+    for (int color = 0; color < 2; color++) {
+        if (bishops[color] >= 2) {
+            score[color] += BISHOP_PAIR;
+        }
+        score[color] += KNIGHT_PAWN_ADJUSTMENT * knights[color] * (pawns[color] - 5);
+        score[color] += ROOK_PAWN_ADJUSTMENT * rooks[color] * (pawns[color] - 5);
+        phase += (knights[color] + bishops[color]) * EvalTables::PIECE_TYPE_PHASES[1]
+               + rooks[color] * EvalTables::PIECE_TYPE_PHASES[3]
+               + queens[color] * EvalTables::PIECE_TYPE_PHASES[4];
+    }
+    entry.imbalance = score[0] - score[1];
+    entry.gamePhase = qMin(phase, EvalTables::TOTAL_PHASE);
+
+    // Specialised endings without pawns
+    if (pawns[0] == 0 && pawns[1] == 0) {
+        for (int color = 0; color < 2; color++) {
+            int other = 1 - color;
+            bool otherBare = material[other] == 0;
+            bool minorOnly = material[color] <= EvalTables::PIECE_TYPE_VALUES[2];
+            bool twoKnights = knights[color] == 2 && material[color] == 2 * EvalTables::PIECE_TYPE_VALUES[1];
+            bool canMate = queens[color] > 0 || rooks[color] > 0 || bishops[color] >= 2 ||
+                           (bishops[color] > 0 && knights[color] > 0);
+
+            if (otherBare && (minorOnly || twoKnights)) {
+                entry.evaluator = evaluateDraw;
+                return;
+            }
+            if (otherBare && canMate) {
+                entry.evaluator = evaluateKXK;
+                return;
+            }
+        }
+    }
+
+    // A side without pawns needs more than a minor piece's advantage to win
+    for (int color = 0; color < 2; color++) {
+        int other = 1 - color;
+        if (pawns[color] == 0 && material[color] - material[other] <= EvalTables::PIECE_TYPE_VALUES[2]) {
+            entry.scaleFactor[color] = (material[color] <= EvalTables::PIECE_TYPE_VALUES[2]) ? 0 : DRAWISH_SCALE;
+        }
+    }
+
+    // One bishop each and nothing else besides pawns
+    if (bishops[0] == 1 && bishops[1] == 1 &&
+        material[0] == EvalTables::PIECE_TYPE_VALUES[2] && material[1] == EvalTables::PIECE_TYPE_VALUES[2]) {
+        entry.scaleFunction = scaleOppositeBishops;
+    }
+}
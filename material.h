@@ -0,0 +1,129 @@
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <QVector>
+#include "gamestate.h"
+
+struct MaterialEntry;
+
+/**
+ * @brief Specialised evaluation for a recognised endgame
+ *
+ * Replaces the normal evaluation entirely.
+ *
+ * @param gs Position to evaluate
+ * @return Score in centipawns from white's perspective
+ */
+typedef int (*EndgameEvaluator)(const GameState& gs);
+
+/**
+ * @brief Position-dependent endgame scale factor
+ *
+ * @param gs Position to evaluate
+ * @return Scale factor from 0 (dead draw) to MaterialEntry::NORMAL_SCALE
+ */
+typedef int (*ScaleFunction)(const GameState& gs);
+
+/**
+ * @struct MaterialEntry
+ * @brief Cached knowledge about one material configuration
+ *
+ * Everything here depends only on the piece counts, so an entry can be
+ * reused by every position with the same GameState::materialKey.
+ */
+struct MaterialEntry {
+    /** @brief Scale factor that leaves the endgame score unchanged */
+    static const int NORMAL_SCALE = 64;
+
+    /** @brief Material key this entry describes */
+    quint64 key;
+
+    /** @brief False until the entry has been filled */
+    bool used;
+
+    /** @brief Packed midgame/endgame imbalance score, white minus black (bishop pair etc.) */
+    int imbalance;
+
+    /** @brief Game phase of the material, capped at EvalTables::TOTAL_PHASE */
+    int gamePhase;
+
+    /**
+     * @brief Endgame scale factor for each color when it is the stronger side
+     *
+     * Indexed with white as 0. Applied to the endgame half of the score,
+     * so drawish material such as a lone minor piece is pulled towards 0.
+     */
+    int scaleFactor[2];
+
+    /** @brief Evaluation that replaces the normal one, or nullptr */
+    EndgameEvaluator evaluator;
+
+    /** @brief Extra position-dependent scaling (e.g. opposite-coloured bishops), or nullptr */
+    ScaleFunction scaleFunction;
+
+    /** @brief Default constructor for an empty entry */
+    MaterialEntry()
+        : key(0), used(false), imbalance(0), gamePhase(0),
+          scaleFactor{NORMAL_SCALE, NORMAL_SCALE}, evaluator(nullptr), scaleFunction(nullptr) {}
+};
+
+/**
+ * @class MaterialHashTable
+ * @brief Fixed-size cache of material configurations
+ *
+ * Looks up the imbalance, phase and endgame knowledge for a position's
+ * piece counts, so drawn or specialised endgames are recognised with one
+ * probe instead of counting pieces at every node.
+ *
+ * @author Group 69 (mittensOS)
+ */
+class MaterialHashTable {
+public:
+    /** @brief Number of entries in the table (a power of two) */
+    static const int SIZE = 8192;
+
+    /**
+     * @brief Constructor for the MaterialHashTable class
+     */
+    MaterialHashTable();
+
+    /**
+     * @brief Gets the material entry of a position
+     *
+     * Returns the cached entry for the position's material key, analysing
+     * and storing it first on a miss.
+     *
+     * @param gs Position to look up
+     * @return The entry for the position's material
+     */
+    const MaterialEntry& probe(const GameState& gs);
+
+    /**
+     * @brief Empties the table
+     */
+    void clear();
+
+    /**
+     * @brief Gets the count of one piece from a material key
+     *
+     * @param key Material key
+     * @param color 0 for white, 1 for black
+     * @param type Piece type index (pawn, knight, bishop, rook, queen, king)
+     * @return Number of such pieces
+     */
+    static int pieceCount(quint64 key, int color, int type);
+
+private:
+    /** @brief Table entries, indexed by a multiplicative hash of the material key */
+    QVector<MaterialEntry> entries;
+
+    /**
+     * @brief Analyses a material configuration from its key
+     *
+     * @param key Material key
+     * @param entry Entry to fill in (the key is set by the caller)
+     */
+    static void analyse(quint64 key, MaterialEntry& entry);
+};
+
+#endif // MATERIAL_H
@@ -28,8 +28,16 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # Use this to ensure forward compatibility with future Qt versions
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
-# C++11 standard is required
-CONFIG += c++11
+# C++17 standard is required (compile-time evaluation tables)
+CONFIG += c++17
+
+# The neural network kernels use SSE2 on x86-64 by default.
+# Uncomment to build them for AVX2 (the program then needs an AVX2 CPU)
+#QMAKE_CXXFLAGS += -mavx2
+
+# Uncomment to count heap allocations for "ChessGame alloccheck".
+# This wraps malloc and replaces operator new and delete, so leave it off for normal builds
+#DEFINES += MITTENS_ALLOC_CHECK
 
 # Source files included in the project
 SOURCES += \
@@ -37,14 +45,34 @@ SOURCES += \
         mainwindow.cpp \
         chessboard.cpp \
         gamestate.cpp \
-        chessai.cpp
+        chessai.cpp \
+        pawnhash.cpp \
+        material.cpp \
+        evalcache.cpp \
+        transposition.cpp \
+        nnue.cpp \
+        attackmaps.cpp \
+        tablebase.cpp \
+        syzygy.cpp \
+        bench.cpp
 
 # Header files included in the project
 HEADERS += \
         mainwindow.h \
         chessboard.h \
         gamestate.h \
-        chessai.h
+        chessai.h \
+        evaltables.h \
+        pawnhash.h \
+        material.h \
+        evalcache.h \
+        transposition.h \
+        nnue.h \
+        bitboard.h \
+        attackmaps.h \
+        tablebase.h \
+        syzygy.h \
+        bench.h
 
 # Resource files (images, etc.)
 RESOURCES += \
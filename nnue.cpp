@@ -0,0 +1,396 @@
+#include "nnue.h"
+#include "gamestate.h"
+#include "evaltables.h"
+#include <QFile>
+#include <QByteArray>
+#include <QtEndian>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NNUE_USE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NNUE_USE_SSE2
+#endif
+
+namespace {
+
+/** @brief Magic bytes at the start of a weight file */
+const char FILE_MAGIC[4] = {'M', 'N', 'U', 'E'};
+
+/**
+ * @brief Adds a weight row to an accumulator half (scalar)
+ *
+ * @param values Accumulator half
+ * @param row Weight row of one feature
+ */
+void addRowScalar(std::int16_t* values, const std::int16_t* row) {
+    for (int i = 0; i < NNUE_HIDDEN; i++) {
+        values[i] = static_cast<std::int16_t>(values[i] + row[i]);
+    }
+}
+
+/**
+ * @brief Dot product of a clipped accumulator half with output weights (scalar)
+ *
+ * @param values Accumulator half
+ * @param weights Output weights for that half
+ * @return Sum of clamp(value, 0, QA) * weight
+ */
+std::int32_t clippedDotScalar(const std::int16_t* values, const std::int16_t* weights) {
+    std::int32_t sum = 0;
+    for (int i = 0; i < NNUE_HIDDEN; i++) {
+        int activation = qBound(0, static_cast<int>(values[i]), NnueNetwork::QA);
+        sum += activation * weights[i];
+    }
+    return sum;
+}
+
+#if defined(NNUE_USE_AVX2)
+
+void addRow(std::int16_t* values, const std::int16_t* row) {
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), _mm256_add_epi16(v, w));
+    }
+}
+
+void subRow(std::int16_t* values, const std::int16_t* row) {
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), _mm256_sub_epi16(v, w));
+    }
+}
+
+std::int32_t clippedDot(const std::int16_t* values, const std::int16_t* weights) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ceiling = _mm256_set1_epi16(NnueNetwork::QA);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        v = _mm256_min_epi16(_mm256_max_epi16(v, zero), ceiling);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, w));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+}
+
+#elif defined(NNUE_USE_SSE2)
+
+void addRow(std::int16_t* values, const std::int16_t* row) {
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_add_epi16(v, w));
+    }
+}
+
+void subRow(std::int16_t* values, const std::int16_t* row) {
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_sub_epi16(v, w));
+    }
+}
+
+std::int32_t clippedDot(const std::int16_t* values, const std::int16_t* weights) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ceiling = _mm_set1_epi16(NnueNetwork::QA);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+        v = _mm_min_epi16(_mm_max_epi16(v, zero), ceiling);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(v, w));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+#else
+
+void addRow(std::int16_t* values, const std::int16_t* row) {
+    addRowScalar(values, row);
+}
+
+void subRow(std::int16_t* values, const std::int16_t* row) {
+    for (int i = 0; i < NNUE_HIDDEN; i++) {
+        values[i] = static_cast<std::int16_t>(values[i] - row[i]);
+    }
+}
+
+std::int32_t clippedDot(const std::int16_t* values, const std::int16_t* weights) {
+    return clippedDotScalar(values, weights);
+}
+
+#endif
+
+/**
+ * @brief Collects the features of every piece on the board
+ *
+ * @param gs Position to read
+ * @param features Receives up to 32 features in white's encoding
+ * @return Number of features written
+ */
+int boardFeatures(const GameState& gs, int* features) {
+    int count = 0;
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            const QString& piece = gs.board[row][col];
+            int type = EvalTables::pieceTypeIndex(piece[1].toLatin1());
+            if (type >= 0 && count < 64) {
+                int index = (piece[0] == 'w') ? type : type + EvalTables::PIECE_TYPES;
+                features[count++] = index * 64 + row * 8 + col;
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+/**
+ * @brief Constructor for the NnueNetwork class (no weights loaded)
+ */
+NnueNetwork::NnueNetwork() {
+}
+
+/**
+ * @brief Destructor for the NnueNetwork class
+ */
+NnueNetwork::~NnueNetwork() {
+}
+
+/**
+ * @brief Loads weights from a binary file
+ *
+ * The whole file is read and checked against the expected size before
+ * any weights are replaced, so a bad file leaves the network unchanged.
+ *
+ * @param path Path of the weight file
+ * @return bool True if the file was read and has the expected layout
+ */
+bool NnueNetwork::load(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray data = file.readAll();
+    file.close();
+
+    const int headerSize = 16;
+    const int expectedSize = headerSize + 2 * (INPUTS * HIDDEN + HIDDEN + 2 * HIDDEN) + 4;
+    if (data.size() != expectedSize || std::memcmp(data.constData(), FILE_MAGIC, 4) != 0) {
+        return false;
+    }
+
+    const char* p = data.constData() + 4;
+    quint32 version = qFromLittleEndian<quint32>(p);
+    quint32 inputs = qFromLittleEndian<quint32>(p + 4);
+    quint32 hidden = qFromLittleEndian<quint32>(p + 8);
+    if (version != FILE_VERSION || inputs != INPUTS || hidden != HIDDEN) {
+        return false;
+    }
+    p += 12;
+
+    std::unique_ptr<Weights> loaded(new Weights);
+    for (int feature = 0; feature < INPUTS; feature++) {
+        for (int i = 0; i < HIDDEN; i++, p += 2) {
+            loaded->featureWeights[feature][i] = qFromLittleEndian<qint16>(p);
+        }
+    }
+    for (int i = 0; i < HIDDEN; i++, p += 2) {
+        loaded->featureBias[i] = qFromLittleEndian<qint16>(p);
+    }
+    for (int i = 0; i < 2 * HIDDEN; i++, p += 2) {
+        loaded->outputWeights[i] = qFromLittleEndian<qint16>(p);
+    }
+    loaded->outputBias = qFromLittleEndian<qint32>(p);
+
+    weights = std::move(loaded);
+    return true;
+}
+
+/**
+ * @brief Fills the network with small pseudo-random weights
+ *
+ * @param seed Seed of the generator
+ */
+void NnueNetwork::initRandom(quint64 seed) {
+    quint64 state = seed;
+    auto next = [&state](int range) {
+        quint64 z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        return static_cast<int>(z % (2 * range + 1)) - range;
+    };
+
+    weights.reset(new Weights);
+    for (int feature = 0; feature < INPUTS; feature++) {
+        for (int i = 0; i < HIDDEN; i++) {
+            weights->featureWeights[feature][i] = static_cast<std::int16_t>(next(64));
+        }
+    }
+    for (int i = 0; i < HIDDEN; i++) {
+        weights->featureBias[i] = static_cast<std::int16_t>(next(64));
+    }
+    for (int i = 0; i < 2 * HIDDEN; i++) {
+        weights->outputWeights[i] = static_cast<std::int16_t>(next(64));
+    }
+    weights->outputBias = next(QA * QB);
+}
+
+/**
+ * @brief Checks whether the network has weights
+ *
+ * @return bool True after a successful load() or initRandom()
+ */
+bool NnueNetwork::isLoaded() const {
+    return weights != nullptr;
+}
+
+/**
+ * @brief Gets the feature index of a piece on a square from one perspective
+ *
+ * From black's perspective the colours are swapped and the board is
+ * mirrored vertically (square ^ 56), so both halves see "their" pieces
+ * moving up the board.
+ *
+ * @param feature Feature in white's encoding (piece * 64 + square)
+ * @param perspective 0 for white, 1 for black
+ * @return int Feature index for that perspective
+ */
+int NnueNetwork::perspectiveFeature(int feature, int perspective) {
+    if (perspective == 0) {
+        return feature;
+    }
+    int piece = feature / 64;
+    int square = feature % 64;
+    int swapped = (piece + EvalTables::PIECE_TYPES) % EvalTables::PIECES;
+    return swapped * 64 + (square ^ 56);
+}
+
+/**
+ * @brief Recomputes an accumulator from the pieces on the board
+ *
+ * @param accumulator Accumulator to fill
+ * @param gs Position to read
+ */
+void NnueNetwork::refresh(NnueAccumulator& accumulator, const GameState& gs) const {
+    int features[64];
+    int count = boardFeatures(gs, features);
+    for (int perspective = 0; perspective < 2; perspective++) {
+        std::memcpy(accumulator.values[perspective], weights->featureBias, sizeof(weights->featureBias));
+        for (int i = 0; i < count; i++) {
+            addRow(accumulator.values[perspective],
+                   weights->featureWeights[perspectiveFeature(features[i], perspective)]);
+        }
+    }
+}
+
+/**
+ * @brief Applies the feature changes of a move to an accumulator
+ *
+ * @param accumulator Accumulator to update
+ * @param delta Features removed and added by the move
+ */
+void NnueNetwork::update(NnueAccumulator& accumulator, const NnueDelta& delta) const {
+    for (int perspective = 0; perspective < 2; perspective++) {
+        for (int i = 0; i < delta.removedCount; i++) {
+            subRow(accumulator.values[perspective],
+                   weights->featureWeights[perspectiveFeature(delta.removed[i], perspective)]);
+        }
+        for (int i = 0; i < delta.addedCount; i++) {
+            addRow(accumulator.values[perspective],
+                   weights->featureWeights[perspectiveFeature(delta.added[i], perspective)]);
+        }
+    }
+}
+
+/**
+ * @brief Reverts the feature changes of a move in an accumulator
+ *
+ * @param accumulator Accumulator to update
+ * @param delta Features removed and added by the move being undone
+ */
+void NnueNetwork::revert(NnueAccumulator& accumulator, const NnueDelta& delta) const {
+    for (int perspective = 0; perspective < 2; perspective++) {
+        for (int i = 0; i < delta.addedCount; i++) {
+            subRow(accumulator.values[perspective],
+                   weights->featureWeights[perspectiveFeature(delta.added[i], perspective)]);
+        }
+        for (int i = 0; i < delta.removedCount; i++) {
+            addRow(accumulator.values[perspective],
+                   weights->featureWeights[perspectiveFeature(delta.removed[i], perspective)]);
+        }
+    }
+}
+
+/**
+ * @brief Evaluates an accumulator
+ *
+ * @param accumulator Accumulator of the position
+ * @param whiteToMove Side to move
+ * @return int Score in centipawns from the side to move's perspective
+ */
+int NnueNetwork::evaluate(const NnueAccumulator& accumulator, bool whiteToMove) const {
+    int us = whiteToMove ? 0 : 1;
+    std::int32_t sum = clippedDot(accumulator.values[us], weights->outputWeights)
+                     + clippedDot(accumulator.values[1 - us], weights->outputWeights + HIDDEN);
+    return static_cast<int>((static_cast<qint64>(sum) + weights->outputBias) * SCALE / (QA * QB));
+}
+
+/**
+ * @brief Recomputes an accumulator with the scalar reference code
+ *
+ * @param accumulator Accumulator to fill
+ * @param gs Position to read
+ */
+void NnueNetwork::refreshReference(NnueAccumulator& accumulator, const GameState& gs) const {
+    int features[64];
+    int count = boardFeatures(gs, features);
+    for (int perspective = 0; perspective < 2; perspective++) {
+        std::memcpy(accumulator.values[perspective], weights->featureBias, sizeof(weights->featureBias));
+        for (int i = 0; i < count; i++) {
+            addRowScalar(accumulator.values[perspective],
+                         weights->featureWeights[perspectiveFeature(features[i], perspective)]);
+        }
+    }
+}
+
+/**
+ * @brief Evaluates an accumulator with the scalar reference code
+ *
+ * @param accumulator Accumulator of the position
+ * @param whiteToMove Side to move
+ * @return int Score in centipawns from the side to move's perspective
+ */
+int NnueNetwork::evaluateReference(const NnueAccumulator& accumulator, bool whiteToMove) const {
+    int us = whiteToMove ? 0 : 1;
+    std::int32_t sum = clippedDotScalar(accumulator.values[us], weights->outputWeights)
+                     + clippedDotScalar(accumulator.values[1 - us], weights->outputWeights + HIDDEN);
+    return static_cast<int>((static_cast<qint64>(sum) + weights->outputBias) * SCALE / (QA * QB));
+}
+
+/**
+ * @brief Gets the name of the kernels compiled into this build
+ *
+ * @return const char* "AVX2", "SSE2" or "scalar"
+ */
+const char* NnueNetwork::kernelName() {
+#if defined(NNUE_USE_AVX2)
+    return "AVX2";
+#elif defined(NNUE_USE_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
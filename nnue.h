@@ -0,0 +1,235 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <QString>
+#include <cstdint>
+#include <memory>
+
+class GameState;
+
+/** @brief Width of one accumulator half (neurons per perspective) */
+constexpr int NNUE_HIDDEN = 256;
+
+/**
+ * @struct NnueAccumulator
+ * @brief First-layer activations of the network for both perspectives
+ *
+ * values[0] is computed from white's point of view and values[1] from
+ * black's. GameState keeps one up to date through makeMove()/undoMove().
+ */
+struct NnueAccumulator {
+    /** @brief Pre-activation sums, indexed [perspective][neuron] */
+    alignas(32) std::int16_t values[2][NNUE_HIDDEN];
+};
+
+/**
+ * @struct NnueDelta
+ * @brief Input features switched off and on by one move
+ *
+ * Features are stored in white's encoding (piece * 64 + square); the
+ * black perspective is derived from them. A move removes at most three
+ * features (mover, captured piece, castling rook) and adds at most two
+ * (mover or promoted piece, castling rook). GameState also replays the
+ * delta on its piece bitboards, since a feature is a piece on a square.
+ */
+struct NnueDelta {
+    /** @brief Features removed by the move */
+    int removed[3];
+
+    /** @brief Features added by the move */
+    int added[2];
+
+    /** @brief Number of entries used in removed */
+    int removedCount;
+
+    /** @brief Number of entries used in added */
+    int addedCount;
+
+    /** @brief Default constructor for an empty delta */
+    NnueDelta() : removed{0, 0, 0}, added{0, 0}, removedCount(0), addedCount(0) {}
+
+    /**
+     * @brief Records a feature switched off
+     * @param feature Feature index, or -1 for none
+     */
+    void remove(int feature) {
+        if (feature >= 0) {
+            removed[removedCount++] = feature;
+        }
+    }
+
+    /**
+     * @brief Records a feature switched on
+     * @param feature Feature index, or -1 for none
+     */
+    void add(int feature) {
+        if (feature >= 0) {
+            added[addedCount++] = feature;
+        }
+    }
+};
+
+/**
+ * @class NnueNetwork
+ * @brief Efficiently updatable neural network evaluator
+ *
+ * A 768 -> 2x256 -> 1 network. Each of the 768 inputs is one of the twelve
+ * pieces on one of the 64 squares. The first layer is kept incrementally in
+ * an NnueAccumulator, so a move only adds and subtracts a few weight rows.
+ * The output layer takes the clipped accumulators of the side to move and
+ * of the opponent.
+ *
+ * All arithmetic is 16-bit integer. The kernels use AVX2 or SSE2 when the
+ * compiler targets them and plain C++ otherwise. The *Reference() methods
+ * always use the plain C++ path, so the SIMD output can be checked
+ * against them.
+ *
+ * Weight file layout (little-endian):
+ * - magic "MNUE", uint32 version (1), uint32 inputs (768), uint32 hidden (256)
+ * - int16 feature weights [768][256], int16 feature biases [256]
+ * - int16 output weights [512] (side to move first), int32 output bias
+ *
+ * @author Group 69 (mittensOS)
+ */
+class NnueNetwork {
+public:
+    /** @brief Number of input features: 12 pieces on 64 squares */
+    static const int INPUTS = 768;
+
+    /** @brief Neurons per perspective */
+    static const int HIDDEN = NNUE_HIDDEN;
+
+    /** @brief Quantisation of the first layer (activations are clipped to 0..QA) */
+    static const int QA = 255;
+
+    /** @brief Quantisation of the output weights */
+    static const int QB = 64;
+
+    /** @brief Network output scale to centipawns */
+    static const int SCALE = 400;
+
+    /** @brief Version number written in weight files */
+    static const quint32 FILE_VERSION = 1;
+
+    /**
+     * @brief Constructor for the NnueNetwork class (no weights loaded)
+     */
+    NnueNetwork();
+
+    /**
+     * @brief Destructor for the NnueNetwork class
+     */
+    ~NnueNetwork();
+
+    /**
+     * @brief Loads weights from a binary file
+     *
+     * @param path Path of the weight file
+     * @return True if the file was read and has the expected layout
+     */
+    bool load(const QString& path);
+
+    /**
+     * @brief Fills the network with small pseudo-random weights
+     *
+     * Only useful for testing the kernels without a trained network.
+     *
+     * @param seed Seed of the generator
+     */
+    void initRandom(quint64 seed);
+
+    /**
+     * @brief Checks whether the network has weights
+     * @return True after a successful load() or initRandom()
+     */
+    bool isLoaded() const;
+
+    /**
+     * @brief Gets the feature index of a piece on a square from one perspective
+     *
+     * @param feature Feature in white's encoding (piece * 64 + square)
+     * @param perspective 0 for white, 1 for black (colours swapped, board mirrored)
+     * @return Feature index for that perspective
+     */
+    static int perspectiveFeature(int feature, int perspective);
+
+    /**
+     * @brief Recomputes an accumulator from the pieces on the board
+     *
+     * @param accumulator Accumulator to fill
+     * @param gs Position to read
+     */
+    void refresh(NnueAccumulator& accumulator, const GameState& gs) const;
+
+    /**
+     * @brief Applies the feature changes of a move to an accumulator
+     *
+     * @param accumulator Accumulator to update
+     * @param delta Features removed and added by the move
+     */
+    void update(NnueAccumulator& accumulator, const NnueDelta& delta) const;
+
+    /**
+     * @brief Reverts the feature changes of a move in an accumulator
+     *
+     * @param accumulator Accumulator to update
+     * @param delta Features removed and added by the move being undone
+     */
+    void revert(NnueAccumulator& accumulator, const NnueDelta& delta) const;
+
+    /**
+     * @brief Evaluates an accumulator
+     *
+     * @param accumulator Accumulator of the position
+     * @param whiteToMove Side to move
+     * @return Score in centipawns from the side to move's perspective
+     */
+    int evaluate(const NnueAccumulator& accumulator, bool whiteToMove) const;
+
+    /**
+     * @brief Recomputes an accumulator with the scalar reference code
+     *
+     * @param accumulator Accumulator to fill
+     * @param gs Position to read
+     */
+    void refreshReference(NnueAccumulator& accumulator, const GameState& gs) const;
+
+    /**
+     * @brief Evaluates an accumulator with the scalar reference code
+     *
+     * @param accumulator Accumulator of the position
+     * @param whiteToMove Side to move
+     * @return Score in centipawns from the side to move's perspective
+     */
+    int evaluateReference(const NnueAccumulator& accumulator, bool whiteToMove) const;
+
+    /**
+     * @brief Gets the name of the kernels compiled into this build
+     * @return "AVX2", "SSE2" or "scalar"
+     */
+    static const char* kernelName();
+
+private:
+    /**
+     * @struct Weights
+     * @brief Quantised network parameters
+     */
+    struct Weights {
+        /** @brief First-layer weights, one row per input feature */
+        alignas(32) std::int16_t featureWeights[INPUTS][HIDDEN];
+
+        /** @brief First-layer biases */
+        alignas(32) std::int16_t featureBias[HIDDEN];
+
+        /** @brief Output weights: side to move first, then the opponent */
+        alignas(32) std::int16_t outputWeights[2 * HIDDEN];
+
+        /** @brief Output bias (scaled by QA * QB) */
+        std::int32_t outputBias;
+    };
+
+    /** @brief Network parameters, or nullptr before loading */
+    std::unique_ptr<Weights> weights;
+};
+
+#endif // NNUE_H
@@ -0,0 +1,180 @@
+#include "pawnhash.h"
+#include "evaltables.h"
+
+namespace {
+
+/** @brief Penalty for each extra pawn on a file */
+const int DOUBLED_PAWN = EvalTables::makeScore(-10, -20);
+
+/** @brief Penalty for a pawn with no friendly pawns on the adjacent files */
+const int ISOLATED_PAWN = EvalTables::makeScore(-15, -20);
+
+/** @brief Penalty for a pawn that can't be supported and whose advance is covered */
+const int BACKWARD_PAWN = EvalTables::makeScore(-10, -15);
+
+/** @brief Bonus for a passed pawn by relative rank (0 is the first rank) */
+const int PASSED_PAWN[8] = {
+    EvalTables::makeScore(0, 0),
+    EvalTables::makeScore(5, 10),
+    EvalTables::makeScore(10, 20),
+    EvalTables::makeScore(15, 35),
+    EvalTables::makeScore(25, 60),
+    EvalTables::makeScore(40, 100),
+    EvalTables::makeScore(60, 150),
+    EvalTables::makeScore(0, 0)
+};
+
+/** @brief Bonus for a shield pawn one rank in front of the king */
+const int SHIELD_PAWN_NEAR = EvalTables::makeScore(10, 0);
+
+/** @brief Bonus for a shield pawn two ranks in front of the king */
+const int SHIELD_PAWN_FAR = EvalTables::makeScore(5, 0);
+
+/** @brief Penalty for a file next to the king with no shield pawn */
+const int SHIELD_PAWN_MISSING = EvalTables::makeScore(-15, 0);
+
+} // namespace
+
+/**
+ * @brief Constructor for the PawnHashTable class
+ *
+ * Allocates all entries up front so that probing never allocates.
+ */
+PawnHashTable::PawnHashTable() : entries(SIZE) {
+}
+
+/**
+ * @brief Gets the pawn-structure evaluation of a position
+ *
+ * @param gs Position to look up
+ * @return The entry for the position's pawns
+ */
+const PawnEntry& PawnHashTable::probe(const GameState& gs) {
+    PawnEntry& entry = entries[static_cast<int>(gs.pawnKey & (SIZE - 1))];
+    if (!entry.used || entry.key != gs.pawnKey) {
+        entry.key = gs.pawnKey;
+        entry.used = true;
+        evaluate(gs, entry);
+    }
+    return entry;
+}
+
+/**
+ * @brief Empties the table
+ */
+void PawnHashTable::clear() {
+    entries.fill(PawnEntry());
+}
+
+/**
+ * @brief Evaluates the pawn structure of a position from scratch
+ *
+ * White pawns move towards row 0 and black pawns towards row 7. A pawn is:
+ * - passed if no enemy pawn on its own or an adjacent file is in front of it
+ * - isolated if no friendly pawn is on an adjacent file
+ * - backward if every friendly pawn on an adjacent file is in front of it
+ *   and an enemy pawn covers the square it would advance to
+ * - doubled for every pawn beyond the first on its file
+ *
+ * The shield score of each king file counts the friendly pawns on that
+ * file and its neighbours one or two ranks in front of the back rank.
+ *
+ * @param gs Position to evaluate
+ * @param entry Entry to fill in
+ */
+void PawnHashTable::evaluate(const GameState& gs, PawnEntry& entry) {
+    // pawnOnSquare[color][row][col], plus per-file counts
+    bool pawnOnSquare[2][8][8] = {};
+    int pawnsOnFile[2][8] = {};
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            const QString& piece = gs.board[row][col];
+            if (piece[1] == 'p') {
+                int color = (piece[0] == 'w') ? 0 : 1;
+                pawnOnSquare[color][row][col] = true;
+                pawnsOnFile[color][col]++;
+            }
+        }
+    }
+
+    int score[2] = {0, 0};
+    entry.passedPawns[0] = 0;
+    entry.passedPawns[1] = 0;
+
+    for (int color = 0; color < 2; color++) {
+        int enemy = 1 - color;
+        int forward = (color == 0) ? -1 : 1;
+
+        for (int col = 0; col < 8; col++) {
+            if (pawnsOnFile[color][col] > 1) {
+                score[color] += DOUBLED_PAWN * (pawnsOnFile[color][col] - 1);
+            }
+        }
+
+        for (int row = 0; row < 8; row++) {
+            for (int col = 0; col < 8; col++) {
+                if (!pawnOnSquare[color][row][col]) {
+                    continue;
+                }
+
+                bool passed = true;
+                bool hasNeighbour = false;
+                bool supportable = false;
+                for (int file = qMax(col - 1, 0); file <= qMin(col + 1, 7); file++) {
+                    for (int r = 0; r < 8; r++) {
+                        bool ahead = (r - row) * forward > 0;
+                        if (pawnOnSquare[enemy][r][file] && ahead) {
+                            passed = false;
+                        }
+                        if (file != col && pawnOnSquare[color][r][file]) {
+                            hasNeighbour = true;
+                            if (!ahead) {
+                                supportable = true;
+                            }
+                        }
+                    }
+                }
+
+                if (passed) {
+                    int relativeRank = (color == 0) ? 7 - row : row;
+                    score[color] += PASSED_PAWN[relativeRank];
+                    entry.passedPawns[color] |= 1ULL << (row * 8 + col);
+                }
+
+                if (!hasNeighbour) {
+                    score[color] += ISOLATED_PAWN;
+                } else if (!supportable) {
+                    // Enemy pawns that would capture on the stop square
+                    int attackRow = row + 2 * forward;
+                    bool stopCovered = false;
+                    if (attackRow >= 0 && attackRow < 8) {
+                        stopCovered = (col > 0 && pawnOnSquare[enemy][attackRow][col - 1]) ||
+                                      (col < 7 && pawnOnSquare[enemy][attackRow][col + 1]);
+                    }
+                    if (stopCovered) {
+                        score[color] += BACKWARD_PAWN;
+                    }
+                }
+            }
+        }
+
+        // Pawn shield for a king on each file of its back rank
+        int nearRow = (color == 0) ? 6 : 1;
+        int farRow = (color == 0) ? 5 : 2;
+        for (int kingFile = 0; kingFile < 8; kingFile++) {
+            int shelter = 0;
+            for (int file = qMax(kingFile - 1, 0); file <= qMin(kingFile + 1, 7); file++) {
+                if (pawnOnSquare[color][nearRow][file]) {
+                    shelter += SHIELD_PAWN_NEAR;
+                } else if (pawnOnSquare[color][farRow][file]) {
+                    shelter += SHIELD_PAWN_FAR;
+                } else {
+                    shelter += SHIELD_PAWN_MISSING;
+                }
+            }
+            entry.shelter[color][kingFile] = shelter;
+        }
+    }
+
+    entry.score = score[0] - score[1];
+}
@@ -0,0 +1,94 @@
+#ifndef PAWNHASH_H
+#define PAWNHASH_H
+
+#include <QVector>
+#include "gamestate.h"
+
+/**
+ * @struct PawnEntry
+ * @brief Cached evaluation of one pawn structure
+ *
+ * Everything here depends only on the pawns, so an entry can be reused by
+ * every position with the same GameState::pawnKey.
+ */
+struct PawnEntry {
+    /** @brief Pawn hash of the structure this entry describes */
+    quint64 key;
+
+    /** @brief False until the entry has been filled */
+    bool used;
+
+    /**
+     * @brief Packed midgame/endgame structure score, white minus black
+     *
+     * Covers passed, isolated, doubled and backward pawns.
+     */
+    int score;
+
+    /**
+     * @brief Packed pawn shield score for a king on each file
+     *
+     * Indexed [color][file] with white as color 0; positive is good for
+     * the king's side. Only meaningful while the king is on its first two
+     * ranks.
+     */
+    int shelter[2][8];
+
+    /** @brief Squares (row * 8 + col) of the passed pawns of each color */
+    quint64 passedPawns[2];
+
+    /** @brief Default constructor for an empty entry */
+    PawnEntry() : key(0), used(false), score(0), shelter{}, passedPawns{0, 0} {}
+};
+
+/**
+ * @class PawnHashTable
+ * @brief Fixed-size cache of pawn-structure evaluations
+ *
+ * Pawn structure rarely changes between sibling nodes, so the expensive
+ * structure terms are computed once per pawn hash and looked up after that.
+ * The table is direct-mapped: a new structure replaces whatever was in its
+ * slot.
+ *
+ * @author Group 69 (mittensOS)
+ */
+class PawnHashTable {
+public:
+    /** @brief Number of entries in the table (a power of two) */
+    static const int SIZE = 16384;
+
+    /**
+     * @brief Constructor for the PawnHashTable class
+     */
+    PawnHashTable();
+
+    /**
+     * @brief Gets the pawn-structure evaluation of a position
+     *
+     * Returns the cached entry for the position's pawn hash, evaluating and
+     * storing it first on a miss.
+     *
+     * @param gs Position to look up
+     * @return The entry for the position's pawns
+     */
+    const PawnEntry& probe(const GameState& gs);
+
+    /**
+     * @brief Empties the table
+     */
+    void clear();
+
+private:
+    /** @brief Table entries, indexed by the low bits of the pawn hash */
+    QVector<PawnEntry> entries;
+
+    /**
+     * @brief Evaluates the pawn structure of a position from scratch
+     *
+     * @param gs Position to evaluate
+     * @param entry Entry to fill in (the key is set by the caller)
+     */
+    static void evaluate(const GameState& gs, PawnEntry& entry);
+};
+
+#endif // PAWNHASH_H
@@ -0,0 +1,1352 @@
+#include "syzygy.h"
+#include "bitboard.h"
+#include "evaltables.h"
+#include "gamestate.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <memory>
+
+// Squares in this file are numbered as in the Syzygy files: a1 = 0, h1 = 7,
+// h8 = 63, which is the GameState square (row * 8 + col) with the rank
+// flipped. Pieces are coded as in the files: 1 (pawn) to 6 (king) for
+// white, plus 8 for black.
+
+/**
+ * @struct SyzygyPairs
+ * @brief Decoder of one compressed value stream of a table
+ *
+ * A table holds one stream per side to move stored (WDL tables of
+ * unequal material store both) and per file of the leading pawn (tables
+ * with pawns are split by file a to d). Values are stored in blocks of
+ * Huffman-coded symbols; each symbol expands, by recursive pairing, into
+ * a run of values.
+ */
+struct SyzygyPairs {
+    /** @brief Stream flags (see PairsFlag) */
+    int flags;
+
+    /** @brief Bytes per block */
+    quint64 blockSize;
+
+    /** @brief Values between entries of the sparse index */
+    quint64 span;
+
+    /** @brief Number of blocks */
+    int blockCount;
+
+    /** @brief Longest symbol in bits */
+    int maxSymbolLength;
+
+    /** @brief Shortest symbol in bits; for a single-value stream, the value */
+    int minSymbolLength;
+
+    /** @brief Lowest symbol of each length, little-endian 16-bit */
+    const uchar* lowestSymbols;
+
+    /** @brief Pair each symbol expands into, 12 bits per side */
+    const uchar* symbolTree;
+
+    /** @brief Values per block minus one, little-endian 16-bit */
+    const uchar* blockLengths;
+
+    /** @brief Number of block lengths stored, padded beyond blockCount */
+    int blockLengthCount;
+
+    /** @brief Block and offset of every span-th value, 6 bytes each */
+    const uchar* sparseIndex;
+
+    /** @brief Number of sparse index entries */
+    quint64 sparseIndexCount;
+
+    /** @brief First block */
+    const uchar* blocks;
+
+    /** @brief Lowest code of each symbol length, left-aligned in 64 bits */
+    QVector<quint64> base;
+
+    /** @brief Number of values each symbol expands into, minus one */
+    QVector<quint8> symbolLength;
+
+    /** @brief Pieces in encoding order */
+    int pieces[SyzygyTablebase::MAX_PIECES];
+
+    /** @brief Multiplier of each group's index */
+    quint64 groupIndex[SyzygyTablebase::MAX_PIECES + 1];
+
+    /** @brief Pieces per group, zero-terminated */
+    int groupLength[SyzygyTablebase::MAX_PIECES + 1];
+
+    /** @brief Start of the DTZ value map of wins, losses, cursed wins and blessed losses */
+    int mapIndex[4];
+};
+
+/**
+ * @struct SyzygyTable
+ * @brief One WDL or DTZ file, mapped on first use
+ */
+struct SyzygyTable {
+    /** @brief True for a DTZ table */
+    bool dtz;
+
+    /** @brief Path of the file */
+    QString path;
+
+    /** @brief Whether mapping the file has been tried */
+    bool opened;
+
+    /** @brief Whether the file is mapped and its header parsed */
+    bool ready;
+
+    /** @brief Mapped file, kept open while mapped */
+    std::unique_ptr<QFile> file;
+
+    /** @brief DTZ value maps */
+    const uchar* map;
+
+    /** @brief Value streams by side to move and leading pawn file */
+    SyzygyPairs pairs[2][4];
+
+    /**
+     * @brief Constructor for a table that is not mapped yet
+     *
+     * @param isDtz True for a DTZ table
+     */
+    explicit SyzygyTable(bool isDtz) : dtz(isDtz), opened(false), ready(false), map(nullptr) {}
+
+    /**
+     * @brief Gets a value stream
+     *
+     * @param side Side to move as stored (ignored by DTZ tables, which store one)
+     * @param file File of the leading pawn (0 for tables without pawns)
+     * @return The stream
+     */
+    SyzygyPairs* get(int side, int file) {
+        return &pairs[dtz ? 0 : side][file];
+    }
+};
+
+/**
+ * @struct SyzygyEntry
+ * @brief Material signature with its WDL and DTZ tables
+ */
+struct SyzygyEntry {
+    /** @brief Material key with the first side of the name as white */
+    quint64 key;
+
+    /** @brief Material key with the first side of the name as black */
+    quint64 key2;
+
+    /** @brief Pieces, kings included */
+    int pieceCount;
+
+    /** @brief Whether there are pawns */
+    bool hasPawns;
+
+    /** @brief Whether some piece other than a king is the only one of its kind */
+    bool hasUniquePieces;
+
+    /** @brief Pawns of the leading color, then of the other color */
+    int pawnCount[2];
+
+    /** @brief Win/draw/loss table */
+    SyzygyTable wdl;
+
+    /** @brief Distance-to-zero table */
+    SyzygyTable dtz;
+
+    /**
+     * @brief Constructor for a signature without mapped tables
+     */
+    SyzygyEntry() : wdl(false), dtz(true) {}
+};
+
+namespace {
+
+/** @brief First bytes of a WDL file */
+const uchar WDL_MAGIC[4] = {0x71, 0xE8, 0x23, 0x5D};
+
+/** @brief First bytes of a DTZ file */
+const uchar DTZ_MAGIC[4] = {0xD7, 0x66, 0x0C, 0xA5};
+
+/**
+ * @enum PairsFlag
+ * @brief Flags of a value stream; all but SingleValue only apply to DTZ tables
+ */
+enum PairsFlag {
+    SideToMove = 1,
+    Mapped = 2,
+    WinPlies = 4,
+    LossPlies = 8,
+    Wide = 16,
+    SingleValue = 128
+};
+
+/** @brief Piece letters by type, as in file names */
+const char PIECE_LETTERS[EvalTables::PIECE_TYPES] = {'P', 'N', 'B', 'R', 'Q', 'K'};
+
+/**
+ * @struct SyzygyIndexTables
+ * @brief Tables that turn piece squares into a position index
+ *
+ * Positions without pawns are mirrored so the leading piece is in the
+ * a1-d1-d4 triangle; positions with pawns so the leading pawn is on
+ * files a to d.
+ */
+struct SyzygyIndexTables {
+    /** @brief Pawn squares a2-h7 ordered from the edge files and low ranks inwards */
+    int mapPawns[64];
+
+    /** @brief Squares below the a1-h8 diagonal, numbered 0 to 27 */
+    int mapB1H1H7[64];
+
+    /** @brief Squares of the a1-d1-d4 triangle, numbered 0 to 9, diagonal last */
+    int mapA1D1D4[64];
+
+    /** @brief The 462 legal placements of two kings with the first in the triangle */
+    int mapKK[10][64];
+
+    /** @brief Ways to choose k of n squares */
+    quint64 binomial[SyzygyTablebase::MAX_PIECES][64];
+
+    /** @brief Index of the leading pawn group, by pawn count and leading square */
+    quint64 leadPawnIndex[SyzygyTablebase::MAX_PIECES][64];
+
+    /** @brief Number of leading pawn placements, by pawn count and file */
+    quint64 leadPawnsSize[SyzygyTablebase::MAX_PIECES][4];
+
+    /**
+     * @brief Constructor that fills the tables
+     */
+    SyzygyIndexTables();
+};
+
+/**
+ * @brief Gets the rank of a square
+ *
+ * @param square Square, a1 = 0
+ * @return Rank from 0 to 7
+ */
+int rankOf(int square) {
+    return square >> 3;
+}
+
+/**
+ * @brief Gets the file of a square
+ *
+ * @param square Square, a1 = 0
+ * @return File from 0 to 7
+ */
+int fileOf(int square) {
+    return square & 7;
+}
+
+/**
+ * @brief Gets how far a square is above the a1-h8 diagonal
+ *
+ * @param square Square, a1 = 0
+ * @return Positive above, 0 on and negative below the diagonal
+ */
+int offDiagonal(int square) {
+    return rankOf(square) - fileOf(square);
+}
+
+/**
+ * @brief Constructor that fills the tables
+ */
+SyzygyIndexTables::SyzygyIndexTables() {
+    std::fill(&mapPawns[0], &mapPawns[0] + 64, 0);
+    std::fill(&mapB1H1H7[0], &mapB1H1H7[0] + 64, 0);
+    std::fill(&mapA1D1D4[0], &mapA1D1D4[0] + 64, 0);
+    std::fill(&mapKK[0][0], &mapKK[0][0] + 10 * 64, 0);
+    std::fill(&binomial[0][0], &binomial[0][0] + SyzygyTablebase::MAX_PIECES * 64, 0);
+    std::fill(&leadPawnIndex[0][0], &leadPawnIndex[0][0] + SyzygyTablebase::MAX_PIECES * 64, 0);
+    std::fill(&leadPawnsSize[0][0], &leadPawnsSize[0][0] + SyzygyTablebase::MAX_PIECES * 4, 0);
+
+    int code = 0;
+    for (int square = 0; square < 64; square++) {
+        if (offDiagonal(square) < 0) {
+            mapB1H1H7[square] = code++;
+        }
+    }
+
+    // Triangle squares below the diagonal first, then the diagonal ones
+    int diagonal[4];
+    int diagonalCount = 0;
+    code = 0;
+    for (int rank = 0; rank < 4; rank++) {
+        for (int file = 0; file < 4; file++) {
+            int square = rank * 8 + file;
+            if (offDiagonal(square) < 0) {
+                mapA1D1D4[square] = code++;
+            } else if (offDiagonal(square) == 0) {
+                diagonal[diagonalCount++] = square;
+            }
+        }
+    }
+    for (int i = 0; i < diagonalCount; i++) {
+        mapA1D1D4[diagonal[i]] = code++;
+    }
+
+    // With the first king on the diagonal, the second is not above it;
+    // placements with both kings on the diagonal come last
+    int bothOnDiagonal[64][2];
+    int bothCount = 0;
+    code = 0;
+    for (int index = 0; index < 10; index++) {
+        for (int first = 0; first < 28; first++) {
+            if (mapA1D1D4[first] != index || (index == 0 && first != 1)) {
+                continue;
+            }
+            for (int second = 0; second < 64; second++) {
+                bool adjacent = qAbs(rankOf(first) - rankOf(second)) <= 1 &&
+                                qAbs(fileOf(first) - fileOf(second)) <= 1;
+                if (adjacent) {
+                    continue;
+                }
+                if (offDiagonal(first) == 0 && offDiagonal(second) > 0) {
+                    continue;
+                }
+                if (offDiagonal(first) == 0 && offDiagonal(second) == 0) {
+                    bothOnDiagonal[bothCount][0] = index;
+                    bothOnDiagonal[bothCount][1] = second;
+                    bothCount++;
+                } else {
+                    mapKK[index][second] = code++;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < bothCount; i++) {
+        mapKK[bothOnDiagonal[i][0]][bothOnDiagonal[i][1]] = code++;
+    }
+
+    // Pascal's rule
+    binomial[0][0] = 1;
+    for (int n = 1; n < 64; n++) {
+        for (int k = 0; k < SyzygyTablebase::MAX_PIECES && k <= n; k++) {
+            binomial[k][n] = (k > 0 ? binomial[k - 1][n - 1] : 0) +
+                             (k < n ? binomial[k][n - 1] : 0);
+        }
+    }
+
+    // The leading pawn is the one with the highest mapPawns value; the
+    // others can only stand on squares with lower values
+    int availableSquares = 47;
+    for (int leadPawns = 1; leadPawns <= SyzygyTablebase::MAX_PIECES - 2; leadPawns++) {
+        for (int file = 0; file < 4; file++) {
+            quint64 index = 0;
+            for (int rank = 1; rank <= 6; rank++) {
+                int square = rank * 8 + file;
+                if (leadPawns == 1) {
+                    mapPawns[square] = availableSquares--;
+                    mapPawns[square ^ 7] = availableSquares--;
+                }
+                leadPawnIndex[leadPawns][square] = index;
+                index += binomial[leadPawns - 1][mapPawns[square]];
+            }
+            leadPawnsSize[leadPawns][file] = index;
+        }
+    }
+}
+
+/**
+ * @brief Gets the index tables, built on first use
+ * @return The tables
+ */
+const SyzygyIndexTables& indexTables() {
+    static const SyzygyIndexTables tables;
+    return tables;
+}
+
+/**
+ * @brief Gets the material key bit of one piece
+ *
+ * @param color 0 for white, 1 for black
+ * @param type Piece type index
+ * @return Key to add for one such piece
+ */
+constexpr quint64 pieceKey(int color, int type) {
+    return 1ULL << (4 * (color * EvalTables::PIECE_TYPES + type));
+}
+
+/**
+ * @brief Gets the sign of a number
+ *
+ * @param value Number
+ * @return 1, 0 or -1
+ */
+int signOf(int value) {
+    return (value > 0) - (value < 0);
+}
+
+/**
+ * @brief Gets the DTZ of a position whose best move is a capture or pawn move
+ *
+ * @param wdl WdlScore of the position
+ * @return 1 for a win, 101 for a cursed win, and the negatives for losses
+ */
+int dtzBeforeZeroing(int wdl) {
+    switch (wdl) {
+        case SyzygyTablebase::Win: return 1;
+        case SyzygyTablebase::CursedWin: return 101;
+        case SyzygyTablebase::BlessedLoss: return -101;
+        case SyzygyTablebase::Loss: return -1;
+        default: return 0;
+    }
+}
+
+/**
+ * @brief Checks whether a move resets the fifty-move counter
+ *
+ * @param move Move to check
+ * @return True for captures and pawn moves
+ */
+bool isZeroing(const Move& move) {
+    return move.isCapture || move.pieceMoved[1] == 'p';
+}
+
+/**
+ * @brief Gets the left half of a symbol's pair
+ *
+ * @param tree Symbol tree of a stream
+ * @param symbol Symbol to expand; for a leaf, its value
+ * @return Left symbol
+ */
+int leftSymbol(const uchar* tree, int symbol) {
+    const uchar* pair = tree + 3 * symbol;
+    return ((pair[1] & 0xF) << 8) | pair[0];
+}
+
+/**
+ * @brief Gets the right half of a symbol's pair
+ *
+ * @param tree Symbol tree of a stream
+ * @param symbol Symbol to expand
+ * @return Right symbol, or 0xFFF for a leaf
+ */
+int rightSymbol(const uchar* tree, int symbol) {
+    const uchar* pair = tree + 3 * symbol;
+    return (pair[2] << 4) | (pair[1] >> 4);
+}
+
+/**
+ * @brief Works out how many values a symbol expands into
+ *
+ * @param pairs Stream whose symbolLength is being filled
+ * @param symbol Symbol to work out
+ * @param visited Symbols already worked out
+ * @return Values minus one
+ */
+int setSymbolLength(SyzygyPairs& pairs, int symbol, QVector<bool>& visited) {
+    visited[symbol] = true;
+    int right = rightSymbol(pairs.symbolTree, symbol);
+    if (right == 0xFFF) {
+        return 0;
+    }
+    int left = leftSymbol(pairs.symbolTree, symbol);
+    if (!visited[left]) {
+        pairs.symbolLength[left] = static_cast<quint8>(setSymbolLength(pairs, left, visited));
+    }
+    if (!visited[right]) {
+        pairs.symbolLength[right] = static_cast<quint8>(setSymbolLength(pairs, right, visited));
+    }
+    return pairs.symbolLength[left] + pairs.symbolLength[right] + 1;
+}
+
+/**
+ * @brief Splits a stream's pieces into groups and sizes each group's index
+ *
+ * The leading group is the kings (with a third unique piece if there is
+ * one) or the leading pawns; every further run of equal pieces is a
+ * group. The groups are combined in the order the file gives.
+ *
+ * @param entry Signature of the table
+ * @param pairs Stream with its pieces set
+ * @param order Position of the leading group and of the other pawns in the combination
+ * @param file File of the leading pawn
+ */
+void setGroups(const SyzygyEntry& entry, SyzygyPairs& pairs, const int order[2], int file) {
+    const SyzygyIndexTables& index = indexTables();
+    int n = 0;
+    int firstLength = entry.hasPawns ? 0 : (entry.hasUniquePieces ? 3 : 2);
+    pairs.groupLength[n] = 1;
+    for (int i = 1; i < entry.pieceCount; i++) {
+        if (--firstLength > 0 || pairs.pieces[i] == pairs.pieces[i - 1]) {
+            pairs.groupLength[n]++;
+        } else {
+            pairs.groupLength[++n] = 1;
+        }
+    }
+    pairs.groupLength[++n] = 0;
+
+    bool pawnsOnBothSides = entry.hasPawns && entry.pawnCount[1] > 0;
+    int next = pawnsOnBothSides ? 2 : 1;
+    int freeSquares = 64 - pairs.groupLength[0] - (pawnsOnBothSides ? pairs.groupLength[1] : 0);
+    quint64 size = 1;
+
+    for (int k = 0; next < n || k == order[0] || k == order[1]; k++) {
+        if (k == order[0]) {
+            pairs.groupIndex[0] = size;
+            size *= entry.hasPawns ? index.leadPawnsSize[pairs.groupLength[0]][file]
+                                   : (entry.hasUniquePieces ? 31332 : 462);
+        } else if (k == order[1]) {
+            pairs.groupIndex[1] = size;
+            size *= index.binomial[pairs.groupLength[1]][48 - pairs.groupLength[0]];
+        } else {
+            pairs.groupIndex[next] = size;
+            size *= index.binomial[pairs.groupLength[next]][freeSquares];
+            freeSquares -= pairs.groupLength[next++];
+        }
+    }
+    pairs.groupIndex[n] = size;
+}
+
+/**
+ * @brief Reads the sizes and Huffman code of a stream
+ *
+ * @param pairs Stream with its groups set
+ * @param data Start of the stream's header
+ * @return End of the header
+ */
+const uchar* setSizes(SyzygyPairs& pairs, const uchar* data) {
+    pairs.flags = *data++;
+    if (pairs.flags & SingleValue) {
+        pairs.blockCount = 0;
+        pairs.span = 0;
+        pairs.sparseIndexCount = 0;
+        pairs.blockLengthCount = 0;
+        pairs.blockSize = 0;
+        pairs.minSymbolLength = *data++;
+        return data;
+    }
+
+    // The last group index is the number of positions
+    int groups = 0;
+    while (pairs.groupLength[groups] != 0) {
+        groups++;
+    }
+    quint64 tableSize = pairs.groupIndex[groups];
+
+    pairs.blockSize = 1ULL << *data++;
+    pairs.span = 1ULL << *data++;
+    pairs.sparseIndexCount = (tableSize + pairs.span - 1) / pairs.span;
+    int padding = *data++;
+    pairs.blockCount = static_cast<int>(qFromLittleEndian<quint32>(data));
+    data += 4;
+    pairs.blockLengthCount = pairs.blockCount + padding;
+    pairs.maxSymbolLength = *data++;
+    pairs.minSymbolLength = *data++;
+    pairs.lowestSymbols = data;
+
+    // Canonical Huffman code: longer symbols have lower codes, so each
+    // length's lowest code follows from the next longer one
+    int lengths = pairs.maxSymbolLength - pairs.minSymbolLength + 1;
+    pairs.base = QVector<quint64>(lengths, 0);
+    for (int i = lengths - 2; i >= 0; i--) {
+        pairs.base[i] = (pairs.base[i + 1] + qFromLittleEndian<quint16>(pairs.lowestSymbols + 2 * i) -
+                         qFromLittleEndian<quint16>(pairs.lowestSymbols + 2 * (i + 1))) / 2;
+    }
+    for (int i = 0; i < lengths; i++) {
+        pairs.base[i] <<= 64 - i - pairs.minSymbolLength;
+    }
+    data += 2 * lengths;
+
+    int symbols = qFromLittleEndian<quint16>(data);
+    data += 2;
+    pairs.symbolTree = data;
+    pairs.symbolLength = QVector<quint8>(symbols, 0);
+    QVector<bool> visited(symbols, false);
+    for (int symbol = 0; symbol < symbols; symbol++) {
+        if (!visited[symbol]) {
+            pairs.symbolLength[symbol] = static_cast<quint8>(setSymbolLength(pairs, symbol, visited));
+        }
+    }
+    return data + 3 * symbols + (symbols & 1);
+}
+
+/**
+ * @brief Decodes one value of a stream
+ *
+ * The sparse index gives a block and offset near the wanted value; the
+ * block lengths walk from there to the block holding it. The block's
+ * symbols are then decoded until the one covering the value, which is
+ * expanded through the symbol tree down to a single value.
+ *
+ * @param pairs Stream to read
+ * @param index Index of the position
+ * @return The stored value
+ */
+int decompressPairs(const SyzygyPairs& pairs, quint64 index) {
+    if (pairs.flags & SingleValue) {
+        return pairs.minSymbolLength;
+    }
+
+    quint64 k = index / pairs.span;
+    const uchar* entry = pairs.sparseIndex + 6 * k;
+    qint64 block = qFromLittleEndian<quint32>(entry);
+    qint64 offset = qFromLittleEndian<quint16>(entry + 4);
+    offset += static_cast<qint64>(index % pairs.span) - static_cast<qint64>(pairs.span / 2);
+
+    while (offset < 0) {
+        offset += qFromLittleEndian<quint16>(pairs.blockLengths + 2 * (--block)) + 1;
+    }
+    while (offset > qFromLittleEndian<quint16>(pairs.blockLengths + 2 * block)) {
+        offset -= qFromLittleEndian<quint16>(pairs.blockLengths + 2 * (block++)) + 1;
+    }
+
+    const uchar* pointer = pairs.blocks + static_cast<quint64>(block) * pairs.blockSize;
+    quint64 buffer = qFromBigEndian<quint64>(pointer);
+    pointer += 8;
+    int bufferBits = 64;
+    int symbol;
+
+    for (;;) {
+        int length = 0;
+        while (buffer < pairs.base[length]) {
+            length++;
+        }
+        symbol = static_cast<int>((buffer - pairs.base[length]) >> (64 - length - pairs.minSymbolLength));
+        symbol += qFromLittleEndian<quint16>(pairs.lowestSymbols + 2 * length);
+        if (offset < pairs.symbolLength[symbol] + 1) {
+            break;
+        }
+        offset -= pairs.symbolLength[symbol] + 1;
+        length += pairs.minSymbolLength;
+        buffer <<= length;
+        bufferBits -= length;
+        if (bufferBits <= 32) {
+            bufferBits += 32;
+            buffer |= static_cast<quint64>(qFromBigEndian<quint32>(pointer)) << (64 - bufferBits);
+            pointer += 4;
+        }
+    }
+
+    // Expand the symbol, going left or right until a single value remains
+    while (pairs.symbolLength[symbol]) {
+        int left = leftSymbol(pairs.symbolTree, symbol);
+        if (offset < pairs.symbolLength[left] + 1) {
+            symbol = left;
+        } else {
+            offset -= pairs.symbolLength[left] + 1;
+            symbol = rightSymbol(pairs.symbolTree, symbol);
+        }
+    }
+    return leftSymbol(pairs.symbolTree, symbol);
+}
+
+/**
+ * @brief Parses the header of a mapped table
+ *
+ * @param entry Signature of the table
+ * @param table Table to set up
+ * @param start Start of the file
+ * @param end End of the file
+ * @return True if the header matches the signature and fits in the file
+ */
+bool setupTable(const SyzygyEntry& entry, SyzygyTable& table, const uchar* start, const uchar* end) {
+    const uchar* data = start + 4;
+    bool split = (*data & 1) != 0;
+    bool pawns = (*data & 2) != 0;
+    if (pawns != entry.hasPawns || (!table.dtz && split != (entry.key != entry.key2))) {
+        return false;
+    }
+    data++;
+
+    int sides = (!table.dtz && entry.key != entry.key2) ? 2 : 1;
+    int maxFile = entry.hasPawns ? 3 : 0;
+    bool pawnsOnBothSides = entry.hasPawns && entry.pawnCount[1] > 0;
+
+    for (int file = 0; file <= maxFile; file++) {
+        int order[2][2] = {
+            {*data & 0xF, pawnsOnBothSides ? *(data + 1) & 0xF : 0xF},
+            {*data >> 4, pawnsOnBothSides ? *(data + 1) >> 4 : 0xF}
+        };
+        data += 1 + (pawnsOnBothSides ? 1 : 0);
+        for (int k = 0; k < entry.pieceCount; k++, data++) {
+            for (int side = 0; side < sides; side++) {
+                table.get(side, file)->pieces[k] = side ? (*data >> 4) : (*data & 0xF);
+            }
+        }
+        for (int side = 0; side < sides; side++) {
+            setGroups(entry, *table.get(side, file), order[side], file);
+        }
+    }
+    data += (data - start) & 1;
+
+    for (int file = 0; file <= maxFile; file++) {
+        for (int side = 0; side < sides; side++) {
+            data = setSizes(*table.get(side, file), data);
+        }
+    }
+
+    // DTZ tables map stored values to distances, per result
+    if (table.dtz) {
+        table.map = data;
+        for (int file = 0; file <= maxFile; file++) {
+            SyzygyPairs* pairs = table.get(0, file);
+            if (!(pairs->flags & Mapped)) {
+                continue;
+            }
+            for (int i = 0; i < 4; i++) {
+                if (pairs->flags & Wide) {
+                    data += (data - start) & 1;
+                    pairs->mapIndex[i] = static_cast<int>((data - table.map) / 2 + 1);
+                    data += 2 * qFromLittleEndian<quint16>(data) + 2;
+                } else {
+                    pairs->mapIndex[i] = static_cast<int>(data - table.map + 1);
+                    data += *data + 1;
+                }
+            }
+        }
+        data += (data - start) & 1;
+    }
+
+    for (int file = 0; file <= maxFile; file++) {
+        for (int side = 0; side < sides; side++) {
+            SyzygyPairs* pairs = table.get(side, file);
+            pairs->sparseIndex = data;
+            data += 6 * pairs->sparseIndexCount;
+        }
+    }
+    for (int file = 0; file <= maxFile; file++) {
+        for (int side = 0; side < sides; side++) {
+            SyzygyPairs* pairs = table.get(side, file);
+            pairs->blockLengths = data;
+            data += 2 * pairs->blockLengthCount;
+        }
+    }
+    for (int file = 0; file <= maxFile; file++) {
+        for (int side = 0; side < sides; side++) {
+            SyzygyPairs* pairs = table.get(side, file);
+            data += (64 - (data - start) % 64) % 64;
+            pairs->blocks = data;
+            data += static_cast<quint64>(pairs->blockCount) * pairs->blockSize;
+        }
+    }
+    return data <= end;
+}
+
+/**
+ * @brief Parses a signature from a file name
+ *
+ * @param name Base name of the file (e.g. "KRPvKR")
+ * @param entry Receives the signature's keys and piece counts
+ * @return True if the name is a valid signature
+ */
+bool parseSignature(const QString& name, SyzygyEntry& entry) {
+    QStringList sides = name.split('v');
+    if (sides.size() != 2) {
+        return false;
+    }
+    int counts[2][EvalTables::PIECE_TYPES] = {};
+    for (int side = 0; side < 2; side++) {
+        for (QChar letter : sides[side]) {
+            const char* found = static_cast<const char*>(
+                std::memchr(PIECE_LETTERS, letter.toLatin1(), EvalTables::PIECE_TYPES));
+            if (!found) {
+                return false;
+            }
+            counts[side][found - PIECE_LETTERS]++;
+        }
+        if (counts[side][5] != 1) {
+            return false;
+        }
+    }
+
+    entry.key = 0;
+    entry.key2 = 0;
+    entry.pieceCount = 0;
+    entry.hasUniquePieces = false;
+    for (int side = 0; side < 2; side++) {
+        for (int type = 0; type < EvalTables::PIECE_TYPES; type++) {
+            entry.key += counts[side][type] * pieceKey(side, type);
+            entry.key2 += counts[side][type] * pieceKey(1 - side, type);
+            entry.pieceCount += counts[side][type];
+            if (type < 5 && counts[side][type] == 1) {
+                entry.hasUniquePieces = true;
+            }
+        }
+    }
+    entry.hasPawns = counts[0][0] + counts[1][0] > 0;
+
+    // With pawns on both sides, the side with fewer pawns leads
+    bool firstLeads = counts[1][0] == 0 || (counts[0][0] > 0 && counts[1][0] >= counts[0][0]);
+    entry.pawnCount[0] = firstLeads ? counts[0][0] : counts[1][0];
+    entry.pawnCount[1] = firstLeads ? counts[1][0] : counts[0][0];
+    return entry.pieceCount >= 3 && entry.pieceCount <= SyzygyTablebase::MAX_PIECES;
+}
+
+} // namespace
+
+/**
+ * @brief Constructor for a prober without tables
+ */
+SyzygyTablebase::SyzygyTablebase() : pieceLimit(MAX_PIECES), largestTable(0) {
+    for (int level = 0; level < PROBE_DEPTH; level++) {
+        moveLists[level].reserve(256);
+    }
+}
+
+/**
+ * @brief Destructor; unmaps the files
+ */
+SyzygyTablebase::~SyzygyTablebase() {
+    qDeleteAll(entries);
+}
+
+/**
+ * @brief Sets the directories the tables are read from
+ *
+ * @param path Directories separated by QDir::listSeparator(), or an empty string for none
+ * @return int Number of tables found
+ */
+int SyzygyTablebase::setPath(const QString& path) {
+    qDeleteAll(entries);
+    entries.clear();
+    entriesByKey.clear();
+    largestTable = 0;
+    searchPath = path;
+
+    const QStringList directories = path.split(QDir::listSeparator(), Qt::SkipEmptyParts);
+    for (const QString& directory : directories) {
+        const QFileInfoList files = QDir(directory).entryInfoList(
+            QStringList() << QString("*") + WDL_EXTENSION, QDir::Files);
+        for (const QFileInfo& info : files) {
+            std::unique_ptr<SyzygyEntry> entry(new SyzygyEntry());
+            if (!parseSignature(info.completeBaseName(), *entry) || entriesByKey.contains(entry->key)) {
+                continue;
+            }
+            entry->wdl.path = info.filePath();
+            entry->dtz.path = QDir(directory).filePath(info.completeBaseName() + DTZ_EXTENSION);
+            largestTable = qMax(largestTable, entry->pieceCount);
+            entriesByKey.insert(entry->key, entry.get());
+            entriesByKey.insert(entry->key2, entry.get());
+            entries.append(entry.release());
+        }
+    }
+    return entries.size();
+}
+
+/**
+ * @brief Gets the directories the tables are read from
+ * @return QString Path as given to setPath()
+ */
+QString SyzygyTablebase::path() const {
+    return searchPath;
+}
+
+/**
+ * @brief Limits the positions probed to a number of pieces
+ *
+ * @param pieces Most pieces, kings included
+ */
+void SyzygyTablebase::setMaxPieces(int pieces) {
+    pieceLimit = qBound(0, pieces, MAX_PIECES);
+}
+
+/**
+ * @brief Gets the most pieces of a position that can be probed
+ * @return int The smaller of the limit and the largest table found (0 without tables)
+ */
+int SyzygyTablebase::maxPieces() const {
+    return qMin(pieceLimit, largestTable);
+}
+
+/**
+ * @brief Gets the number of tables found
+ * @return int Number of WDL files listed by setPath()
+ */
+int SyzygyTablebase::tableCount() const {
+    return entries.size();
+}
+
+/**
+ * @brief Looks up the result of a position
+ *
+ * @param gs Position to look up (restored before returning)
+ * @param moves Legal moves of the position
+ * @param wdl Receives the WdlScore for the side to move
+ * @return bool True if the position is covered by the tables
+ */
+bool SyzygyTablebase::probeWdl(GameState& gs, const QVector<Move>& moves, int& wdl) {
+    if (!isProbeable(gs)) {
+        return false;
+    }
+    ProbeState state = Ok;
+    int value = search(gs, moves, false, 0, state);
+    if (state == Fail) {
+        return false;
+    }
+    wdl = value;
+    return true;
+}
+
+/**
+ * @brief Looks up the distance to zeroing of a position
+ *
+ * @param gs Position to look up (restored before returning)
+ * @param dtz Receives the signed plies until the next capture or pawn move
+ * @return bool True if the position is covered by the tables
+ */
+bool SyzygyTablebase::probeDtz(GameState& gs, int& dtz) {
+    if (!isProbeable(gs)) {
+        return false;
+    }
+    QVector<Move>& moves = moveLists[0];
+    gs.getValidMoves(moves);
+    if (moves.isEmpty()) {
+        dtz = gs.checkmate ? -1 : 0;
+        return true;
+    }
+    ProbeState state = Ok;
+    int value = distanceToZero(gs, moves, 0, state);
+    if (state == Fail) {
+        return false;
+    }
+    dtz = value;
+    return true;
+}
+
+/**
+ * @brief Keeps the root moves that best keep the result
+ *
+ * A win or loss only counts if the next capture or pawn move comes
+ * before the fifty-move counter runs out; otherwise the move draws.
+ *
+ * @param gs Root position (restored before returning)
+ * @param moves Legal moves of the root, filtered in place
+ * @return bool True if the moves were ranked, false if the root is not covered
+ */
+bool SyzygyTablebase::filterRootMoves(GameState& gs, QVector<Move>& moves) {
+    if (moves.isEmpty() || !isProbeable(gs)) {
+        return false;
+    }
+
+    // DTZ of each move, from the root side's point of view
+    QVector<int> distances(moves.size(), 0);
+    for (int i = 0; i < moves.size(); i++) {
+        const Move& move = moves[i];
+        bool zeroing = isZeroing(move);
+        gs.makeMove(move);
+        QVector<Move>& replies = moveLists[1];
+        gs.getValidMoves(replies);
+        ProbeState state = Ok;
+        int distance = 0;
+        if (replies.isEmpty()) {
+            distance = gs.checkmate ? 1 : 0;
+        } else if (zeroing) {
+            distance = dtzBeforeZeroing(-search(gs, replies, false, 1, state));
+        } else {
+            distance = -distanceToZero(gs, replies, 1, state);
+            distance += signOf(distance);
+        }
+        gs.undoMove();
+        if (state == Fail) {
+            return false;
+        }
+        distances[i] = distance;
+    }
+
+    // 1 for a win, -1 for a loss, 0 for a draw under the fifty-move rule
+    auto outcome = [&gs](int distance) {
+        int plies = qAbs(distance);
+        if (distance == 0 || plies > 100 || (plies > 1 && plies + gs.halfmoveClock > 99)) {
+            return 0;
+        }
+        return signOf(distance);
+    };
+    int best = -1;
+    for (int distance : distances) {
+        best = qMax(best, outcome(distance));
+    }
+    int target = 0;
+    if (best != 0) {
+        // Win soonest, or lose as late as possible: the lowest DTZ either way
+        target = INT_MAX;
+        for (int distance : distances) {
+            if (outcome(distance) == best) {
+                target = qMin(target, distance);
+            }
+        }
+    }
+
+    int kept = 0;
+    for (int i = 0; i < moves.size(); i++) {
+        if (outcome(distances[i]) == best && (best == 0 || distances[i] == target)) {
+            moves[kept++] = moves[i];
+        }
+    }
+    moves.resize(kept);
+    return true;
+}
+
+/**
+ * @brief Checks whether a position is small enough and free of castling rights
+ *
+ * @param gs Position to check
+ * @return bool True if the tables may cover it
+ */
+bool SyzygyTablebase::isProbeable(const GameState& gs) const {
+    if (entries.isEmpty() || gs.castlingRights.wks || gs.castlingRights.wqs ||
+        gs.castlingRights.bks || gs.castlingRights.bqs) {
+        return false;
+    }
+    return Bitboards::popCount(gs.colorPieces(0) | gs.colorPieces(1)) <= maxPieces();
+}
+
+/**
+ * @brief Resolves captures (and pawn moves) before looking up a position
+ *
+ * The tables hold "don't care" values where a capture is best, and know
+ * nothing of en passant, so the zeroing moves are searched first. If
+ * they are all the moves there are, the table is not read at all.
+ *
+ * @param gs Position to search
+ * @param moves Legal moves of the position
+ * @param zeroingPawnMoves True to try pawn moves as well as captures
+ * @param level Probe level of the position
+ * @param state Receives the ProbeState
+ * @return int WdlScore of the position
+ */
+int SyzygyTablebase::search(GameState& gs, const QVector<Move>& moves, bool zeroingPawnMoves,
+                            int level, ProbeState& state) {
+    int bestValue = Loss;
+    int moveCount = 0;
+
+    for (const Move& move : moves) {
+        if (!move.isCapture && !(zeroingPawnMoves && move.pieceMoved[1] == 'p')) {
+            continue;
+        }
+        if (level + 1 >= PROBE_DEPTH) {
+            state = Fail;
+            return Draw;
+        }
+        moveCount++;
+        gs.makeMove(move);
+        QVector<Move>& replies = moveLists[level + 1];
+        gs.getValidMoves(replies);
+        int value;
+        if (replies.isEmpty()) {
+            value = gs.checkmate ? Win : Draw;
+        } else {
+            value = -search(gs, replies, false, level + 1, state);
+        }
+        gs.undoMove();
+        if (state == Fail) {
+            return Draw;
+        }
+        if (value > bestValue) {
+            bestValue = value;
+            if (value >= Win) {
+                state = ZeroingBestMove;
+                return value;
+            }
+        }
+    }
+
+    bool noMoreMoves = moveCount > 0 && moveCount == moves.size();
+    int value = bestValue;
+    if (!noMoreMoves) {
+        value = probeTable(gs, false, Draw, state);
+        if (state == Fail) {
+            return Draw;
+        }
+    }
+
+    if (bestValue >= value) {
+        state = (bestValue > Draw || noMoreMoves) ? ZeroingBestMove : Ok;
+        return bestValue;
+    }
+    state = Ok;
+    return value;
+}
+
+/**
+ * @brief Gets the distance to zeroing of a position
+ *
+ * DTZ tables store only one side to move; for the other, the answer
+ * comes from a one-ply search over the stored side's positions.
+ *
+ * @param gs Position to look up
+ * @param moves Legal moves of the position
+ * @param level Probe level of the position
+ * @param state Receives Fail if a table is missing
+ * @return int DTZ in plies as for probeDtz()
+ */
+int SyzygyTablebase::distanceToZero(GameState& gs, const QVector<Move>& moves, int level, ProbeState& state) {
+    state = Ok;
+    int wdl = search(gs, moves, true, level, state);
+    if (state == Fail || wdl == Draw) {
+        return 0;
+    }
+    if (state == ZeroingBestMove) {
+        return dtzBeforeZeroing(wdl);
+    }
+
+    int dtz = probeTable(gs, true, wdl, state);
+    if (state == Fail) {
+        return 0;
+    }
+    if (state != ChangeSideToMove) {
+        return (dtz + ((wdl == BlessedLoss || wdl == CursedWin) ? 100 : 0)) * signOf(wdl);
+    }
+
+    // Stored for the other side: take the best reply's DTZ, one ply longer
+    if (level + 1 >= PROBE_DEPTH) {
+        state = Fail;
+        return 0;
+    }
+    int minDtz = 0xFFFF;
+    for (const Move& move : moves) {
+        bool zeroing = isZeroing(move);
+        gs.makeMove(move);
+        QVector<Move>& replies = moveLists[level + 1];
+        gs.getValidMoves(replies);
+        int value;
+        if (replies.isEmpty()) {
+            value = gs.checkmate ? 1 : 0;
+        } else if (zeroing) {
+            value = -dtzBeforeZeroing(search(gs, replies, false, level + 1, state));
+        } else {
+            value = -distanceToZero(gs, replies, level + 1, state);
+            value += signOf(value);
+        }
+        gs.undoMove();
+        if (state == Fail) {
+            return 0;
+        }
+        if (value < minDtz && signOf(value) == signOf(wdl)) {
+            minDtz = value;
+        }
+    }
+    return (minDtz == 0xFFFF) ? -1 : minDtz;
+}
+
+/**
+ * @brief Reads the value of a position from its table
+ *
+ * Tables store the first side of their name as white, so positions of
+ * the other coloring are probed with colors swapped and the board
+ * mirrored top to bottom. The pieces are then put in the table's order
+ * and the board mirrored onto the canonical squares before the index
+ * is computed group by group.
+ *
+ * @param gs Position to look up
+ * @param dtz True to read the DTZ table, false for the WDL table
+ * @param wdl WdlScore of the position, needed to decode DTZ values
+ * @param state Receives the ProbeState
+ * @return int WdlScore, or the DTZ in plies
+ */
+int SyzygyTablebase::probeTable(const GameState& gs, bool dtz, int wdl, ProbeState& state) {
+    Bitboard occupied = gs.colorPieces(0) | gs.colorPieces(1);
+    if (!dtz && Bitboards::popCount(occupied) == 2) {
+        state = Ok;
+        return Draw;
+    }
+
+    SyzygyEntry* entry = entriesByKey.value(gs.materialKey, nullptr);
+    if (!entry) {
+        state = Fail;
+        return 0;
+    }
+    SyzygyTable& table = dtz ? entry->dtz : entry->wdl;
+    if (!table.ready && (table.opened || !mapTable(*entry, table))) {
+        state = Fail;
+        return 0;
+    }
+    const SyzygyIndexTables& index = indexTables();
+
+    int blackToMove = gs.whiteToMove ? 0 : 1;
+    bool symmetricBlackToMove = entry->key == entry->key2 && blackToMove;
+    bool flip = symmetricBlackToMove || gs.materialKey != entry->key;
+    int flipColor = flip ? 8 : 0;
+    int flipSquares = flip ? 56 : 0;
+    int side = (flip ? 1 : 0) ^ blackToMove;
+
+    int squares[MAX_PIECES];
+    int pieces[MAX_PIECES];
+    int size = 0;
+    int leadPawnCount = 0;
+    int leadPawnPiece = -1;
+    int tableFile = 0;
+
+    // The leading pawn is the one nearest the edge, then the lowest
+    if (entry->hasPawns) {
+        int leadColor = ((table.get(0, 0)->pieces[0] ^ flipColor) >> 3) & 1;
+        leadPawnPiece = leadColor * EvalTables::PIECE_TYPES;
+        Bitboard pawns = gs.pieceBitboards[leadPawnPiece];
+        while (pawns) {
+            squares[size++] = Bitboards::popLsb(pawns) ^ 56 ^ flipSquares;
+        }
+        leadPawnCount = size;
+        int* lead = std::max_element(squares, squares + leadPawnCount, [&index](int a, int b) {
+            return index.mapPawns[a] < index.mapPawns[b];
+        });
+        std::swap(squares[0], *lead);
+        tableFile = fileOf(squares[0]);
+        if (tableFile > 3) {
+            tableFile = 7 - tableFile;
+        }
+    }
+
+    if (dtz) {
+        int flags = table.get(side, tableFile)->flags;
+        if ((flags & SideToMove) != side && !(entry->key == entry->key2 && !entry->hasPawns)) {
+            state = ChangeSideToMove;
+            return 0;
+        }
+    }
+
+    for (int piece = 0; piece < EvalTables::PIECES; piece++) {
+        if (piece == leadPawnPiece) {
+            continue;
+        }
+        Bitboard squaresOfPiece = gs.pieceBitboards[piece];
+        while (squaresOfPiece) {
+            squares[size] = Bitboards::popLsb(squaresOfPiece) ^ 56 ^ flipSquares;
+            int code = (piece / EvalTables::PIECE_TYPES) * 8 + piece % EvalTables::PIECE_TYPES + 1;
+            pieces[size++] = code ^ flipColor;
+        }
+    }
+
+    SyzygyPairs* pairs = table.get(side, tableFile);
+
+    // Put the pieces in the order the table encodes them
+    for (int i = leadPawnCount; i < size - 1; i++) {
+        for (int j = i + 1; j < size; j++) {
+            if (pairs->pieces[i] == pieces[j]) {
+                std::swap(pieces[i], pieces[j]);
+                std::swap(squares[i], squares[j]);
+                break;
+            }
+        }
+    }
+
+    // Mirror left to right so the leading piece is on files a to d
+    if (fileOf(squares[0]) > 3) {
+        for (int i = 0; i < size; i++) {
+            squares[i] ^= 7;
+        }
+    }
+
+    quint64 idx;
+    if (entry->hasPawns) {
+        idx = index.leadPawnIndex[leadPawnCount][squares[0]];
+        std::stable_sort(squares + 1, squares + leadPawnCount, [&index](int a, int b) {
+            return index.mapPawns[a] < index.mapPawns[b];
+        });
+        for (int i = 1; i < leadPawnCount; i++) {
+            idx += index.binomial[i][index.mapPawns[squares[i]]];
+        }
+    } else {
+        // Mirror top to bottom, then along the diagonal, into the a1-d1-d4 triangle
+        if (rankOf(squares[0]) > 3) {
+            for (int i = 0; i < size; i++) {
+                squares[i] ^= 56;
+            }
+        }
+        for (int i = 0; i < pairs->groupLength[0]; i++) {
+            if (!offDiagonal(squares[i])) {
+                continue;
+            }
+            if (offDiagonal(squares[i]) > 0) {
+                for (int j = i; j < size; j++) {
+                    squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+                }
+            }
+            break;
+        }
+
+        if (entry->hasUniquePieces) {
+            // Three unique pieces together: 6 * 63 * 62 off the diagonal, then the diagonal cases
+            int adjust1 = squares[1] > squares[0];
+            int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+            if (offDiagonal(squares[0])) {
+                idx = (index.mapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 +
+                      squares[2] - adjust2;
+            } else if (offDiagonal(squares[1])) {
+                idx = (6 * 63 + rankOf(squares[0]) * 28 + index.mapB1H1H7[squares[1]]) * 62 +
+                      squares[2] - adjust2;
+            } else if (offDiagonal(squares[2])) {
+                idx = 6 * 63 * 62 + 4 * 28 * 62 + rankOf(squares[0]) * 7 * 28 +
+                      (rankOf(squares[1]) - adjust1) * 28 + index.mapB1H1H7[squares[2]];
+            } else {
+                idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + rankOf(squares[0]) * 7 * 6 +
+                      (rankOf(squares[1]) - adjust1) * 6 + (rankOf(squares[2]) - adjust2);
+            }
+        } else {
+            idx = index.mapKK[index.mapA1D1D4[squares[0]]][squares[1]];
+        }
+    }
+
+    // The other groups: each a set of squares, skipping those taken by earlier groups
+    idx *= pairs->groupIndex[0];
+    int* group = squares + pairs->groupLength[0];
+    bool remainingPawns = entry->hasPawns && entry->pawnCount[1] > 0;
+    for (int next = 1; pairs->groupLength[next]; next++) {
+        std::stable_sort(group, group + pairs->groupLength[next]);
+        quint64 n = 0;
+        for (int i = 0; i < pairs->groupLength[next]; i++) {
+            int adjust = 0;
+            for (int* earlier = squares; earlier < group; earlier++) {
+                adjust += group[i] > *earlier;
+            }
+            n += index.binomial[i + 1][group[i] - adjust - (remainingPawns ? 8 : 0)];
+        }
+        remainingPawns = false;
+        idx += n * pairs->groupIndex[next];
+        group += pairs->groupLength[next];
+    }
+
+    int value = decompressPairs(*pairs, idx);
+    state = Ok;
+    if (!dtz) {
+        return value - 2;
+    }
+
+    // Stored DTZ values go through a per-result map and may count moves rather than plies
+    static const int WDL_MAPS[5] = {1, 3, 0, 2, 0};
+    SyzygyPairs* filePairs = table.get(0, tableFile);
+    int flags = filePairs->flags;
+    if (flags & Mapped) {
+        int start = filePairs->mapIndex[WDL_MAPS[wdl + 2]];
+        value = (flags & Wide) ? qFromLittleEndian<quint16>(table.map + 2 * (start + value))
+                               : table.map[start + value];
+    }
+    if ((wdl == Win && !(flags & WinPlies)) || (wdl == Loss && !(flags & LossPlies)) ||
+        wdl == CursedWin || wdl == BlessedLoss) {
+        value *= 2;
+    }
+    return value + 1;
+}
+
+/**
+ * @brief Maps a table's file and parses its header, the first time it is needed
+ *
+ * A file that is missing, has the wrong magic or a header that does not
+ * match its name is never tried again.
+ *
+ * @param entry Signature the table belongs to
+ * @param table The entry's WDL or DTZ table
+ * @return bool True if the table can be probed
+ */
+bool SyzygyTablebase::mapTable(const SyzygyEntry& entry, SyzygyTable& table) {
+    table.opened = true;
+    std::unique_ptr<QFile> file(new QFile(table.path));
+    if (!file->open(QIODevice::ReadOnly) || file->size() % 64 != 16) {
+        return false;
+    }
+    const uchar* mapped = file->map(0, file->size());
+    if (!mapped || std::memcmp(mapped, table.dtz ? DTZ_MAGIC : WDL_MAGIC, 4) != 0 ||
+        !setupTable(entry, table, mapped, mapped + file->size())) {
+        return false;
+    }
+    table.file = std::move(file);
+    table.ready = true;
+    return true;
+}
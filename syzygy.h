@@ -0,0 +1,230 @@
+#ifndef SYZYGY_H
+#define SYZYGY_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+class GameState;
+class Move;
+struct SyzygyEntry;
+struct SyzygyTable;
+
+/**
+ * @class SyzygyTablebase
+ * @brief Prober for Syzygy endgame tables read from local files
+ *
+ * Syzygy tables come in pairs per material signature: KQRvKR.rtbw holds
+ * the win/draw/loss result of every position (WDL) and KQRvKR.rtbz the
+ * distance to the next capture or pawn move with best play (DTZ). The
+ * files are compressed with recursive pairing and Huffman codes, and are
+ * read by probing them in place.
+ *
+ * setPath() only lists the files; each one is memory-mapped and its
+ * header parsed the first time a position needs it. Tables may hold
+ * positions where a capture is the best move with a "don't care" value,
+ * so every probe first tries the captures itself. Both kinds of probe
+ * assume a fresh fifty-move counter and no castling rights.
+ *
+ * Results are WdlScore values; cursed wins and blessed losses are wins
+ * and losses that the fifty-move rule turns into draws.
+ *
+ * @author Group 69 (mittensOS)
+ */
+class SyzygyTablebase {
+public:
+    /** @brief Most pieces, kings included, the file format can describe */
+    static const int MAX_PIECES = 7;
+
+    /** @brief Most nested moves a probe can make, so searches reserve room for them */
+    static const int PROBE_DEPTH = 16;
+
+    /** @brief Extension of WDL files */
+    static constexpr const char* WDL_EXTENSION = ".rtbw";
+
+    /** @brief Extension of DTZ files */
+    static constexpr const char* DTZ_EXTENSION = ".rtbz";
+
+    /**
+     * @enum WdlScore
+     * @brief Result of a position for the side to move
+     */
+    enum WdlScore {
+        Loss = -2,
+        BlessedLoss = -1,
+        Draw = 0,
+        CursedWin = 1,
+        Win = 2
+    };
+
+    /**
+     * @brief Constructor for a prober without tables
+     */
+    SyzygyTablebase();
+
+    /**
+     * @brief Destructor; unmaps the files
+     */
+    ~SyzygyTablebase();
+
+    SyzygyTablebase(const SyzygyTablebase&) = delete;
+    SyzygyTablebase& operator=(const SyzygyTablebase&) = delete;
+
+    /**
+     * @brief Sets the directories the tables are read from
+     *
+     * Lists the WDL files of the directories; nothing is opened yet.
+     * Files whose name is not a valid signature are skipped.
+     *
+     * @param path Directories separated by QDir::listSeparator(), or an empty string for none
+     * @return Number of tables found
+     */
+    int setPath(const QString& path);
+
+    /**
+     * @brief Gets the directories the tables are read from
+     * @return Path as given to setPath()
+     */
+    QString path() const;
+
+    /**
+     * @brief Limits the positions probed to a number of pieces
+     *
+     * @param pieces Most pieces, kings included
+     */
+    void setMaxPieces(int pieces);
+
+    /**
+     * @brief Gets the most pieces of a position that can be probed
+     * @return The smaller of the limit and the largest table found (0 without tables)
+     */
+    int maxPieces() const;
+
+    /**
+     * @brief Gets the number of tables found
+     * @return Number of WDL files listed by setPath()
+     */
+    int tableCount() const;
+
+    /**
+     * @brief Looks up the result of a position
+     *
+     * Only allocates when a table is opened, so the search can call it
+     * wherever the fifty-move counter has just been reset.
+     *
+     * @param gs Position to look up (restored before returning)
+     * @param moves Legal moves of the position
+     * @param wdl Receives the WdlScore for the side to move
+     * @return True if the position is covered by the tables
+     */
+    bool probeWdl(GameState& gs, const QVector<Move>& moves, int& wdl);
+
+    /**
+     * @brief Looks up the distance to zeroing of a position
+     *
+     * @param gs Position to look up (restored before returning)
+     * @param dtz Receives the plies until the next capture or pawn move,
+     *            positive if the side to move wins, negative if it loses,
+     *            0 for a draw; beyond 100 for cursed wins and blessed losses
+     * @return True if the position is covered by the tables
+     */
+    bool probeDtz(GameState& gs, int& dtz);
+
+    /**
+     * @brief Keeps the root moves that best keep the result
+     *
+     * Ranks every move by the DTZ of the position it leads to, taking the
+     * fifty-move counter into account. Winning keeps the moves that reach
+     * the next capture or pawn move soonest, so the win is never spoiled
+     * by the fifty-move rule; losing keeps the moves that resist longest;
+     * otherwise every drawing move is kept.
+     *
+     * @param gs Root position (restored before returning)
+     * @param moves Legal moves of the root, filtered in place
+     * @return True if the moves were ranked, false if the root is not covered
+     */
+    bool filterRootMoves(GameState& gs, QVector<Move>& moves);
+
+private:
+    /**
+     * @enum ProbeState
+     * @brief Outcome of a table lookup or capture search
+     */
+    enum ProbeState {
+        Fail,              ///< A table is missing or could not be read
+        Ok,                ///< The value is valid
+        ChangeSideToMove,  ///< The DTZ table only stores the other side to move
+        ZeroingBestMove    ///< The best move is a capture or pawn move
+    };
+
+    /** @brief Directories the tables are read from */
+    QString searchPath;
+
+    /** @brief Most pieces of a position that is probed */
+    int pieceLimit;
+
+    /** @brief Pieces of the largest table found */
+    int largestTable;
+
+    /** @brief Tables found, owned */
+    QVector<SyzygyEntry*> entries;
+
+    /** @brief Tables by the material key of both colorings */
+    QHash<quint64, SyzygyEntry*> entriesByKey;
+
+    /** @brief Move list of each probe level, reused so probes don't allocate */
+    QVector<Move> moveLists[PROBE_DEPTH];
+
+    /**
+     * @brief Checks whether a position is small enough and free of castling rights
+     *
+     * @param gs Position to check
+     * @return True if the tables may cover it
+     */
+    bool isProbeable(const GameState& gs) const;
+
+    /**
+     * @brief Resolves captures (and pawn moves) before looking up a position
+     *
+     * @param gs Position to search
+     * @param moves Legal moves of the position
+     * @param zeroingPawnMoves True to try pawn moves as well as captures
+     * @param level Probe level of the position
+     * @param state Receives the ProbeState
+     * @return WdlScore of the position
+     */
+    int search(GameState& gs, const QVector<Move>& moves, bool zeroingPawnMoves, int level, ProbeState& state);
+
+    /**
+     * @brief Gets the distance to zeroing of a position
+     *
+     * @param gs Position to look up
+     * @param moves Legal moves of the position
+     * @param level Probe level of the position
+     * @param state Receives Fail if a table is missing
+     * @return DTZ in plies as for probeDtz()
+     */
+    int distanceToZero(GameState& gs, const QVector<Move>& moves, int level, ProbeState& state);
+
+    /**
+     * @brief Reads the value of a position from its table
+     *
+     * @param gs Position to look up
+     * @param dtz True to read the DTZ table, false for the WDL table
+     * @param wdl WdlScore of the position, needed to decode DTZ values
+     * @param state Receives the ProbeState
+     * @return WdlScore, or the DTZ in plies
+     */
+    int probeTable(const GameState& gs, bool dtz, int wdl, ProbeState& state);
+
+    /**
+     * @brief Maps a table's file and parses its header, the first time it is needed
+     *
+     * @param entry Signature the table belongs to
+     * @param table The entry's WDL or DTZ table
+     * @return True if the table can be probed
+     */
+    static bool mapTable(const SyzygyEntry& entry, SyzygyTable& table);
+};
+
+#endif // SYZYGY_H
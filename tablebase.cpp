@@ -0,0 +1,1059 @@
+#include "tablebase.h"
+#include "bitboard.h"
+#include "evaltables.h"
+#include "gamestate.h"
+#include <QDir>
+#include <QFile>
+#include <QVector>
+#include <QtEndian>
+#include <cstring>
+#include <memory>
+
+/**
+ * @struct TablebasePosition
+ * @brief Compact position used to build and probe the tables
+ *
+ * Squares are indexed row * 8 + col as in GameState, colors with white
+ * as 0 and piece types as in evaltables.h.
+ */
+struct TablebasePosition {
+    /** @brief Side to move */
+    int side;
+
+    /** @brief King square of each color */
+    int kings[2];
+
+    /** @brief Number of pieces besides the kings */
+    int count;
+
+    /** @brief Type of each piece */
+    int type[EndgameTablebase::MAX_PIECES - 2];
+
+    /** @brief Color of each piece */
+    int color[EndgameTablebase::MAX_PIECES - 2];
+
+    /** @brief Square of each piece */
+    int square[EndgameTablebase::MAX_PIECES - 2];
+};
+
+/**
+ * @struct TablebaseTable
+ * @brief Packed distance-to-mate codes of one material signature
+ *
+ * The codes live either in words (a generated table) or in a mapped
+ * file. Both hold little-endian 64-bit words; code n takes bits
+ * n * bits to (n + 1) * bits - 1 of the stream.
+ */
+struct TablebaseTable {
+    /** @brief Canonical material key of the signature */
+    quint64 key;
+
+    /** @brief Number of pieces besides the kings */
+    int count;
+
+    /** @brief Type of each piece, in index order */
+    int type[EndgameTablebase::MAX_PIECES - 2];
+
+    /** @brief Color of each piece, in index order */
+    int color[EndgameTablebase::MAX_PIECES - 2];
+
+    /** @brief Number of positions (two sides to move, 64 squares per piece) */
+    qint64 size;
+
+    /** @brief Bits per code */
+    int bits;
+
+    /** @brief Greatest distance to mate in plies, or -1 if no position is won */
+    int longestMate;
+
+    /** @brief Codes of a generated table */
+    QVector<quint64> words;
+
+    /** @brief Mapped file of a cached table, kept open while mapped */
+    std::unique_ptr<QFile> file;
+
+    /** @brief Start of the codes */
+    const uchar* data;
+
+    /**
+     * @brief Constructor that sets up the index layout of a signature
+     *
+     * @param materialKey Canonical material key
+     */
+    explicit TablebaseTable(quint64 materialKey);
+
+    /**
+     * @brief Gets the number of 64-bit words holding the codes
+     * @return Word count
+     */
+    qint64 wordCount() const {
+        return (size * bits + 63) / 64;
+    }
+
+    /**
+     * @brief Gets the code of a position
+     *
+     * @param index Index of the position
+     * @return 0 for a draw, otherwise the distance to mate plus one
+     */
+    int code(qint64 index) const {
+        qint64 bit = index * bits;
+        qint64 word = bit >> 6;
+        int shift = static_cast<int>(bit & 63);
+        quint64 value = qFromLittleEndian<quint64>(data + 8 * word) >> shift;
+        if (shift + bits > 64) {
+            value |= qFromLittleEndian<quint64>(data + 8 * (word + 1)) << (64 - shift);
+        }
+        return static_cast<int>(value & ((1ULL << bits) - 1));
+    }
+
+    /**
+     * @brief Gets the index of a position whose pieces are in index order
+     *
+     * @param position Position of this signature, not flipped
+     * @return Index of the position
+     */
+    qint64 encode(const TablebasePosition& position) const {
+        qint64 index = position.side;
+        index = index * 64 + position.kings[0];
+        index = index * 64 + position.kings[1];
+        for (int i = 0; i < count; i++) {
+            index = index * 64 + position.square[i];
+        }
+        return index;
+    }
+
+    /**
+     * @brief Gets the position at an index
+     *
+     * @param index Index of the position
+     * @return The position, which may be illegal
+     */
+    TablebasePosition decode(qint64 index) const {
+        TablebasePosition position;
+        position.count = count;
+        for (int i = count - 1; i >= 0; i--) {
+            position.type[i] = type[i];
+            position.color[i] = color[i];
+            position.square[i] = static_cast<int>(index & 63);
+            index >>= 6;
+        }
+        position.kings[1] = static_cast<int>(index & 63);
+        index >>= 6;
+        position.kings[0] = static_cast<int>(index & 63);
+        index >>= 6;
+        position.side = static_cast<int>(index);
+        return position;
+    }
+
+    /**
+     * @brief Gets the index of a position in any piece order, optionally flipped
+     *
+     * @param position Position of this signature, or of its color-swapped twin
+     * @param flip True if the colors and ranks of position must be swapped
+     * @return Index of the position
+     */
+    qint64 indexOf(const TablebasePosition& position, bool flip) const {
+        int flipSquare = flip ? 56 : 0;
+        int flipColor = flip ? 1 : 0;
+        qint64 index = position.side ^ flipColor;
+        index = index * 64 + (position.kings[flipColor] ^ flipSquare);
+        index = index * 64 + (position.kings[1 - flipColor] ^ flipSquare);
+
+        // Match each slot of the layout with an unused piece of its kind
+        bool used[EndgameTablebase::MAX_PIECES - 2] = {};
+        for (int i = 0; i < count; i++) {
+            for (int j = 0; j < position.count; j++) {
+                if (!used[j] && position.type[j] == type[i] && (position.color[j] ^ flipColor) == color[i]) {
+                    used[j] = true;
+                    index = index * 64 + (position.square[j] ^ flipSquare);
+                    break;
+                }
+            }
+        }
+        return index;
+    }
+};
+
+namespace {
+
+/** @brief Identifies a table file */
+const char FILE_MAGIC[4] = {'M', 'T', 'B', 'L'};
+
+/** @brief Version of the table file layout */
+const quint32 FILE_VERSION = 1;
+
+/** @brief Bytes before the codes in a table file */
+const int HEADER_SIZE = 24;
+
+/** @brief Bits of one color's counts in a material key */
+const quint64 SIDE_MASK = 0xFFFFFF;
+
+/** @brief Generation state of a position that is not resolved yet */
+const quint8 UNKNOWN = 0;
+
+/** @brief Generation state of a stalemate */
+const quint8 STALEMATE = 254;
+
+/** @brief Generation state of an illegal position */
+const quint8 ILLEGAL = 255;
+
+/** @brief Largest code a table can hold, below the special states */
+const int MAX_CODE = 253;
+
+/** @brief Positions between two checks of the cancel flag while building; a power of two */
+const qint64 CANCEL_CHECK_INTERVAL = 4096;
+
+/** @brief Piece letters by type, for signatures */
+const char PIECE_LETTERS[EvalTables::PIECE_TYPES] = {'P', 'N', 'B', 'R', 'Q', 'K'};
+
+/**
+ * @brief Gets the material key bit of one piece
+ *
+ * @param color 0 for white, 1 for black
+ * @param type Piece type index
+ * @return Key to add for one such piece
+ */
+constexpr quint64 pieceKey(int color, int type) {
+    return 1ULL << (4 * (color * EvalTables::PIECE_TYPES + type));
+}
+
+/** @brief Material key of the two kings */
+const quint64 KINGS_KEY = pieceKey(0, 5) + pieceKey(1, 5);
+
+/**
+ * @brief Gets the count of one piece from a material key
+ *
+ * @param key Material key
+ * @param color 0 for white, 1 for black
+ * @param type Piece type index
+ * @return Number of such pieces
+ */
+int pieceCount(quint64 key, int color, int type) {
+    return static_cast<int>((key >> (4 * (color * EvalTables::PIECE_TYPES + type))) & 15);
+}
+
+/**
+ * @brief Gets the number of pieces besides the kings in a material key
+ *
+ * @param key Material key
+ * @return Piece count
+ */
+int nonKingCount(quint64 key) {
+    int count = 0;
+    for (int color = 0; color < 2; color++) {
+        for (int type = 0; type < 5; type++) {
+            count += pieceCount(key, color, type);
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Swaps the colors of a material key
+ *
+ * @param key Material key
+ * @return Key with white's and black's counts exchanged
+ */
+quint64 flipKey(quint64 key) {
+    return ((key & SIDE_MASK) << 24) | ((key >> 24) & SIDE_MASK);
+}
+
+/**
+ * @brief Checks whether a material key must be flipped to find its table
+ *
+ * Tables store the side with the larger counts (compared as a number,
+ * queens first) as white.
+ *
+ * @param key Material key
+ * @return True if black is the stronger side
+ */
+bool isFlipped(quint64 key) {
+    return (key & SIDE_MASK) < ((key >> 24) & SIDE_MASK);
+}
+
+/**
+ * @brief Gets the key of the table covering a material key
+ *
+ * @param key Material key
+ * @return The key, with the stronger side as white
+ */
+quint64 canonicalKey(quint64 key) {
+    return isFlipped(key) ? flipKey(key) : key;
+}
+
+/**
+ * @brief Checks whether a table can be built for a material key
+ *
+ * @param key Material key
+ * @return True for one king each, one to MAX_PIECES - 2 other pieces,
+ *         and pawns on at most one side
+ */
+bool isSupported(quint64 key) {
+    int count = nonKingCount(key);
+    return pieceCount(key, 0, 5) == 1 && pieceCount(key, 1, 5) == 1 &&
+           count >= 1 && count <= EndgameTablebase::MAX_PIECES - 2 &&
+           (pieceCount(key, 0, 0) == 0 || pieceCount(key, 1, 0) == 0);
+}
+
+/**
+ * @brief Gets the material key of a position
+ *
+ * @param position Position to describe
+ * @return The key, kings included
+ */
+quint64 materialKeyOf(const TablebasePosition& position) {
+    quint64 key = KINGS_KEY;
+    for (int i = 0; i < position.count; i++) {
+        key += pieceKey(position.color[i], position.type[i]);
+    }
+    return key;
+}
+
+/**
+ * @brief Gets the squares attacked by one piece
+ *
+ * @param type Piece type index
+ * @param color 0 for white, 1 for black
+ * @param square Square of the piece
+ * @param occupied Occupied squares, which block sliders
+ * @return Attacked squares
+ */
+Bitboard pieceAttacks(int type, int color, int square, Bitboard occupied) {
+    switch (type) {
+        case 0: return Bitboards::ATTACK_TABLES.pawn[color][square];
+        case 1: return Bitboards::ATTACK_TABLES.knight[square];
+        case 2: return Bitboards::bishopAttacks(square, occupied);
+        case 3: return Bitboards::rookAttacks(square, occupied);
+        case 4: return Bitboards::bishopAttacks(square, occupied) | Bitboards::rookAttacks(square, occupied);
+        default: return Bitboards::ATTACK_TABLES.king[square];
+    }
+}
+
+/**
+ * @brief Gets the squares occupied by one color
+ *
+ * @param position Position to look at
+ * @param color 0 for white, 1 for black
+ * @return Squares of the color's king and pieces
+ */
+Bitboard colorSquares(const TablebasePosition& position, int color) {
+    Bitboard squares = Bitboards::squareBit(position.kings[color]);
+    for (int i = 0; i < position.count; i++) {
+        if (position.color[i] == color) {
+            squares |= Bitboards::squareBit(position.square[i]);
+        }
+    }
+    return squares;
+}
+
+/**
+ * @brief Checks whether a color attacks a square
+ *
+ * @param position Position to look at
+ * @param square Square to test
+ * @param color Attacking color
+ * @return True if the color's king or one of its pieces attacks the square
+ */
+bool isAttacked(const TablebasePosition& position, int square, int color) {
+    Bitboard target = Bitboards::squareBit(square);
+    if (Bitboards::ATTACK_TABLES.king[position.kings[color]] & target) {
+        return true;
+    }
+    Bitboard occupied = colorSquares(position, 0) | colorSquares(position, 1);
+    for (int i = 0; i < position.count; i++) {
+        if (position.color[i] == color && (pieceAttacks(position.type[i], color, position.square[i], occupied) & target)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Checks whether a position can occur in a game
+ *
+ * @param position Position to check
+ * @return True if no two pieces share a square, no pawn is on the first
+ *         or last rank and the side that just moved is not in check
+ */
+bool isLegal(const TablebasePosition& position) {
+    Bitboard occupied = colorSquares(position, 0) | colorSquares(position, 1);
+    if (Bitboards::popCount(occupied) != position.count + 2) {
+        return false;
+    }
+    for (int i = 0; i < position.count; i++) {
+        int row = position.square[i] / 8;
+        if (position.type[i] == 0 && (row == 0 || row == 7)) {
+            return false;
+        }
+    }
+    return !isAttacked(position, position.kings[1 - position.side], position.side);
+}
+
+/**
+ * @brief Checks whether the side to move is in check
+ *
+ * @param position Position to check
+ * @return True if the side to move's king is attacked
+ */
+bool isInCheck(const TablebasePosition& position) {
+    return isAttacked(position, position.kings[position.side], 1 - position.side);
+}
+
+/**
+ * @brief Completes a move: removes a captured piece, checks legality and visits the result
+ *
+ * @param child Position with the moving piece already on its new square and the side to move unchanged
+ * @param to Destination square
+ * @param promotion Whether the move is a promotion
+ * @param visit Called with the position after the move and whether it has the same material
+ */
+template <typename Visit>
+void finishMove(TablebasePosition child, int to, bool promotion, Visit& visit) {
+    int mover = child.side;
+    bool capture = false;
+    for (int i = 0; i < child.count; i++) {
+        if (child.color[i] != mover && child.square[i] == to) {
+            for (int j = i + 1; j < child.count; j++) {
+                child.type[j - 1] = child.type[j];
+                child.color[j - 1] = child.color[j];
+                child.square[j - 1] = child.square[j];
+            }
+            child.count--;
+            capture = true;
+            break;
+        }
+    }
+    child.side = 1 - mover;
+    if (!isAttacked(child, child.kings[mover], child.side)) {
+        visit(child, !capture && !promotion);
+    }
+}
+
+/**
+ * @brief Visits every legal move of a position
+ *
+ * @param position Legal position
+ * @param visit Called with the position after each move and whether it
+ *              has the same material (neither a capture nor a promotion)
+ */
+template <typename Visit>
+void forEachMove(const TablebasePosition& position, Visit visit) {
+    int us = position.side;
+    int them = 1 - us;
+    Bitboard own = colorSquares(position, us);
+    Bitboard enemyKing = Bitboards::squareBit(position.kings[them]);
+    Bitboard occupied = own | colorSquares(position, them);
+
+    Bitboard targets = Bitboards::ATTACK_TABLES.king[position.kings[us]] & ~own & ~enemyKing;
+    while (targets) {
+        int to = Bitboards::popLsb(targets);
+        TablebasePosition child = position;
+        child.kings[us] = to;
+        finishMove(child, to, false, visit);
+    }
+
+    for (int i = 0; i < position.count; i++) {
+        if (position.color[i] != us) {
+            continue;
+        }
+        int from = position.square[i];
+
+        if (position.type[i] == 0) {
+            // White pawns move towards row 0, black pawns towards row 7
+            int step = (us == 0) ? -8 : 8;
+            int startRow = (us == 0) ? 6 : 1;
+            targets = Bitboards::ATTACK_TABLES.pawn[us][from] & occupied & ~own & ~enemyKing;
+            if (!(occupied & Bitboards::squareBit(from + step))) {
+                targets |= Bitboards::squareBit(from + step);
+                if (from / 8 == startRow && !(occupied & Bitboards::squareBit(from + 2 * step))) {
+                    targets |= Bitboards::squareBit(from + 2 * step);
+                }
+            }
+            while (targets) {
+                int to = Bitboards::popLsb(targets);
+                TablebasePosition child = position;
+                child.square[i] = to;
+                if (to / 8 == 0 || to / 8 == 7) {
+                    for (int promoted = 4; promoted >= 1; promoted--) {
+                        child.type[i] = promoted;
+                        finishMove(child, to, true, visit);
+                    }
+                } else {
+                    finishMove(child, to, false, visit);
+                }
+            }
+        } else {
+            targets = pieceAttacks(position.type[i], us, from, occupied) & ~own & ~enemyKing;
+            while (targets) {
+                int to = Bitboards::popLsb(targets);
+                TablebasePosition child = position;
+                child.square[i] = to;
+                finishMove(child, to, false, visit);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Visits every position with the same material that could have led to a position
+ *
+ * Takes back one move of the side that just moved, without uncapturing
+ * anything. The positions visited may be illegal.
+ *
+ * @param position Position to take a move back from
+ * @param visit Called with each earlier position
+ */
+template <typename Visit>
+void forEachUnmove(const TablebasePosition& position, Visit visit) {
+    int mover = 1 - position.side;
+    Bitboard occupied = colorSquares(position, 0) | colorSquares(position, 1);
+    TablebasePosition parent = position;
+    parent.side = mover;
+
+    Bitboard origins = Bitboards::ATTACK_TABLES.king[position.kings[mover]] & ~occupied;
+    while (origins) {
+        parent.kings[mover] = Bitboards::popLsb(origins);
+        visit(parent);
+    }
+    parent.kings[mover] = position.kings[mover];
+
+    for (int i = 0; i < position.count; i++) {
+        if (position.color[i] != mover) {
+            continue;
+        }
+        int to = position.square[i];
+
+        if (position.type[i] == 0) {
+            // Step the pawn back, twice from the square a double push reaches
+            int step = (mover == 0) ? 8 : -8;
+            int doublePushRow = (mover == 0) ? 4 : 3;
+            int from = to + step;
+            if (from / 8 >= 1 && from / 8 <= 6 && !(occupied & Bitboards::squareBit(from))) {
+                parent.square[i] = from;
+                visit(parent);
+                if (to / 8 == doublePushRow && !(occupied & Bitboards::squareBit(from + step))) {
+                    parent.square[i] = from + step;
+                    visit(parent);
+                }
+            }
+        } else {
+            origins = pieceAttacks(position.type[i], mover, to, occupied) & ~occupied;
+            while (origins) {
+                parent.square[i] = Bitboards::popLsb(origins);
+                visit(parent);
+            }
+        }
+        parent.square[i] = to;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Constructor that sets up the index layout of a signature
+ *
+ * Pieces are ordered white before black and by type from pawn to queen.
+ *
+ * @param materialKey Canonical material key
+ */
+TablebaseTable::TablebaseTable(quint64 materialKey)
+    : key(materialKey), count(0), size(2), bits(1), longestMate(-1), data(nullptr) {
+    for (int pieceColor = 0; pieceColor < 2; pieceColor++) {
+        for (int pieceType = 0; pieceType < 5; pieceType++) {
+            for (int n = pieceCount(materialKey, pieceColor, pieceType); n > 0; n--) {
+                type[count] = pieceType;
+                color[count] = pieceColor;
+                count++;
+            }
+        }
+    }
+    for (int i = 0; i < count + 2; i++) {
+        size *= 64;
+    }
+}
+
+/**
+ * @brief Constructor for an empty tablebase
+ */
+EndgameTablebase::EndgameTablebase()
+    : cancelFlag(nullptr) {
+}
+
+/**
+ * @brief Destructor; unmaps the cached files
+ */
+EndgameTablebase::~EndgameTablebase() {
+    qDeleteAll(tables);
+}
+
+/**
+ * @brief Sets the directory that tables are loaded from and saved to
+ *
+ * @param path Directory, or an empty string to keep tables in memory only
+ */
+void EndgameTablebase::setCacheDirectory(const QString& path) {
+    cacheDirectory = path;
+}
+
+/**
+ * @brief Sets a flag that cancels the table being built
+ *
+ * @param flag Flag to poll, or nullptr to never cancel
+ */
+void EndgameTablebase::setCancelFlag(const std::atomic<bool>* flag) {
+    cancelFlag = flag;
+}
+
+/**
+ * @brief Checks whether building has been cancelled
+ *
+ * @return bool True if the cancel flag is set and raised
+ */
+bool EndgameTablebase::cancelled() const {
+    return cancelFlag && cancelFlag->load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Makes the table of a material signature available
+ *
+ * @param materialKey Material key of the signature, either color
+ * @return bool True if the table is available, false if the signature is not supported
+ */
+bool EndgameTablebase::generate(quint64 materialKey) {
+    quint64 key = canonicalKey(materialKey);
+    if (!isSupported(key)) {
+        return false;
+    }
+    if (tables.contains(key)) {
+        return true;
+    }
+
+    bool cached = !cacheDirectory.isEmpty() && QDir(cacheDirectory).exists();
+    TablebaseTable* table = cached ? loadFile(filePath(key)) : nullptr;
+    if (table && table->key != key) {
+        delete table;
+        table = nullptr;
+    }
+    if (!table) {
+        table = build(key);
+        if (!table) {
+            return false;
+        }
+        if (cached) {
+            saveFile(*table);
+        }
+    }
+    tables.insert(key, table);
+    return true;
+}
+
+/**
+ * @brief Makes every table with up to the given number of pieces available
+ *
+ * Tries every combination of pieces; combinations with the same canonical
+ * key or without support are skipped by generate().
+ *
+ * @param maxPieces Most pieces, kings included (at most MAX_PIECES)
+ * @return int Number of tables available afterwards
+ */
+int EndgameTablebase::generateAll(int maxPieces) {
+    // Non-king pieces by (color, type), white pawn to black queen
+    const int kinds = 10;
+    for (int first = 0; first < kinds && maxPieces >= 3; first++) {
+        quint64 key = KINGS_KEY + pieceKey(first / 5, first % 5);
+        generate(key);
+        for (int second = first; second < kinds && maxPieces >= 4; second++) {
+            generate(key + pieceKey(second / 5, second % 5));
+        }
+    }
+    return tables.size();
+}
+
+/**
+ * @brief Maps every table found in the cache directory
+ *
+ * @return int Number of tables loaded
+ */
+int EndgameTablebase::loadCachedTables() {
+    if (cacheDirectory.isEmpty()) {
+        return 0;
+    }
+    QDir directory(cacheDirectory);
+    int loaded = 0;
+    const QStringList files = directory.entryList(QStringList() << QString("*") + FILE_EXTENSION, QDir::Files);
+    for (const QString& name : files) {
+        TablebaseTable* table = loadFile(directory.filePath(name));
+        if (!table) {
+            continue;
+        }
+        if (tables.contains(table->key)) {
+            delete table;
+            continue;
+        }
+        tables.insert(table->key, table);
+        loaded++;
+    }
+    return loaded;
+}
+
+/**
+ * @brief Checks whether the table of a signature is available
+ *
+ * @param materialKey Material key of the signature, either color
+ * @return bool True if the table has been generated or loaded
+ */
+bool EndgameTablebase::contains(quint64 materialKey) const {
+    return tables.contains(canonicalKey(materialKey));
+}
+
+/**
+ * @brief Gets the number of tables available
+ *
+ * @return int Number of tables
+ */
+int EndgameTablebase::tableCount() const {
+    return tables.size();
+}
+
+/**
+ * @brief Gets the longest mate in a table
+ *
+ * @param materialKey Material key of the signature, either color
+ * @return int Greatest distance to mate in plies, or -1 if the table is not available
+ */
+int EndgameTablebase::longestMate(quint64 materialKey) const {
+    const TablebaseTable* table = tables.value(canonicalKey(materialKey), nullptr);
+    return table ? table->longestMate : -1;
+}
+
+/**
+ * @brief Looks up the result of a position
+ *
+ * Reads the pieces from the piece bitboards and gives up as soon as there
+ * are too many, so positions outside the tables cost almost nothing.
+ *
+ * @param gs Position to look up
+ * @param wdl Receives 1 if the side to move wins, 0 for a draw, -1 if it loses
+ * @param dtm Receives the plies to mate with best play (0 for a draw)
+ * @return bool True if the position is covered by an available table
+ */
+bool EndgameTablebase::probe(const GameState& gs, int& wdl, int& dtm) const {
+    if (tables.isEmpty() || gs.enPassantPossible.first >= 0 ||
+        gs.castlingRights.wks || gs.castlingRights.wqs || gs.castlingRights.bks || gs.castlingRights.bqs) {
+        return false;
+    }
+
+    TablebasePosition position;
+    position.side = gs.whiteToMove ? 0 : 1;
+    position.kings[0] = gs.whiteKingLocation.first * 8 + gs.whiteKingLocation.second;
+    position.kings[1] = gs.blackKingLocation.first * 8 + gs.blackKingLocation.second;
+    position.count = 0;
+    for (int piece = 0; piece < EvalTables::PIECES; piece++) {
+        if (piece % EvalTables::PIECE_TYPES == 5) {
+            continue;
+        }
+        Bitboard squares = gs.pieceBitboards[piece];
+        while (squares) {
+            if (position.count == MAX_PIECES - 2) {
+                return false;
+            }
+            position.type[position.count] = piece % EvalTables::PIECE_TYPES;
+            position.color[position.count] = piece / EvalTables::PIECE_TYPES;
+            position.square[position.count] = Bitboards::popLsb(squares);
+            position.count++;
+        }
+    }
+
+    int code = lookup(position);
+    if (code < 0) {
+        return false;
+    }
+    dtm = (code > 0) ? code - 1 : 0;
+    wdl = (code == 0) ? 0 : ((dtm % 2 == 1) ? 1 : -1);
+    return true;
+}
+
+/**
+ * @brief Gets the name of a material signature
+ *
+ * @param materialKey Material key of the signature
+ * @return QString Stronger side first, pieces from queen to pawn (e.g. "KBNvK")
+ */
+QString EndgameTablebase::signature(quint64 materialKey) {
+    quint64 key = canonicalKey(materialKey);
+    QString name;
+    for (int color = 0; color < 2; color++) {
+        if (color == 1) {
+            name += 'v';
+        }
+        for (int type = 5; type >= 0; type--) {
+            name += QString(pieceCount(key, color, type), QChar(PIECE_LETTERS[type]));
+        }
+    }
+    return name;
+}
+
+/**
+ * @brief Builds a table by retrograde analysis
+ *
+ * The tables that captures and promotions lead into are made available
+ * first. A first pass marks illegal positions, mates and stalemates,
+ * counts each position's moves that keep the material, and settles what
+ * can be settled from the other moves alone. Then, for each distance in
+ * turn, the positions resolved at that distance are taken back one move:
+ * a loss makes every earlier position a win one ply longer, and a win
+ * counts down the earlier position's undecided moves, which is lost once
+ * all of them are known to win for the opponent. Positions still
+ * unresolved at the end are draws.
+ *
+ * @param key Canonical material key of the table
+ * @return TablebaseTable* The table, or nullptr if a table it leads into could not be built
+ */
+TablebaseTable* EndgameTablebase::build(quint64 key) {
+    for (int color = 0; color < 2; color++) {
+        for (int type = 0; type < 5; type++) {
+            if (pieceCount(key, color, type) == 0) {
+                continue;
+            }
+            quint64 captured = key - pieceKey(color, type);
+            if (nonKingCount(captured) > 0 && !generate(captured)) {
+                return nullptr;
+            }
+            for (int promoted = 1; type == 0 && promoted <= 4; promoted++) {
+                if (!generate(captured + pieceKey(color, promoted))) {
+                    return nullptr;
+                }
+            }
+        }
+    }
+
+    std::unique_ptr<TablebaseTable> table(new TablebaseTable(key));
+    const qint64 size = table->size;
+    QVector<quint8> state(static_cast<int>(size), UNKNOWN);
+    QVector<quint8> remaining(static_cast<int>(size), 0);
+    int longest = -1;
+    bool overflow = false;
+
+    // Codes of the positions after a move: looked up in this table or a smaller one
+    auto childCode = [&](const TablebasePosition& child, bool sameMaterial) {
+        if (!sameMaterial) {
+            return lookup(child);
+        }
+        int code = state[static_cast<int>(table->encode(child))];
+        return (code == STALEMATE) ? 0 : code;
+    };
+
+    // Lost if every move lets the opponent mate; the longest such mate is the distance
+    auto resolveLoss = [&](qint64 index, const TablebasePosition& position) {
+        bool lost = true;
+        int longestWin = -1;
+        forEachMove(position, [&](const TablebasePosition& child, bool sameMaterial) {
+            int code = childCode(child, sameMaterial);
+            if (code <= 0 || (code - 1) % 2 == 0) {
+                lost = false;
+            } else {
+                longestWin = qMax(longestWin, code - 1);
+            }
+        });
+        if (lost) {
+            int dtm = longestWin + 1;
+            overflow = overflow || dtm + 1 > MAX_CODE;
+            state[static_cast<int>(index)] = static_cast<quint8>(qMin(dtm + 1, MAX_CODE));
+            longest = qMax(longest, dtm);
+        }
+    };
+
+    for (qint64 index = 0; index < size; index++) {
+        if ((index & (CANCEL_CHECK_INTERVAL - 1)) == 0 && cancelled()) {
+            return nullptr;
+        }
+        TablebasePosition position = table->decode(index);
+        if (!isLegal(position)) {
+            state[static_cast<int>(index)] = ILLEGAL;
+            continue;
+        }
+
+        int moves = 0;
+        int sameMaterialMoves = 0;
+        int shortestWin = MAX_CODE + 1;
+        forEachMove(position, [&](const TablebasePosition& child, bool sameMaterial) {
+            moves++;
+            if (sameMaterial) {
+                sameMaterialMoves++;
+                return;
+            }
+            int code = lookup(child);
+            if (code > 0 && (code - 1) % 2 == 0) {
+                shortestWin = qMin(shortestWin, code);
+            }
+        });
+
+        remaining[static_cast<int>(index)] = static_cast<quint8>(sameMaterialMoves);
+        if (moves == 0 && isInCheck(position)) {
+            state[static_cast<int>(index)] = 1;
+            longest = qMax(longest, 0);
+        } else if (moves == 0) {
+            state[static_cast<int>(index)] = STALEMATE;
+        } else if (shortestWin <= MAX_CODE) {
+            // A capture or promotion wins; a quieter move may still mate sooner
+            overflow = overflow || shortestWin + 1 > MAX_CODE;
+            state[static_cast<int>(index)] = static_cast<quint8>(qMin(shortestWin + 1, MAX_CODE));
+            longest = qMax(longest, shortestWin);
+        } else if (sameMaterialMoves == 0) {
+            resolveLoss(index, position);
+        }
+    }
+
+    for (int dtm = 0; dtm <= longest && !overflow; dtm++) {
+        const quint8 code = static_cast<quint8>(dtm + 1);
+        const bool lossLevel = (dtm % 2 == 0);
+        for (qint64 index = 0; index < size; index++) {
+            if ((index & (CANCEL_CHECK_INTERVAL - 1)) == 0 && cancelled()) {
+                return nullptr;
+            }
+            if (state[static_cast<int>(index)] != code) {
+                continue;
+            }
+            forEachUnmove(table->decode(index), [&](const TablebasePosition& parent) {
+                int parentIndex = static_cast<int>(table->encode(parent));
+                quint8 parentState = state[parentIndex];
+                if (parentState == ILLEGAL) {
+                    return;
+                }
+                if (lossLevel) {
+                    // Moving here mates one ply later than the loss
+                    if (parentState == UNKNOWN || (parentState != STALEMATE && parentState > code + 1)) {
+                        overflow = overflow || code + 1 > MAX_CODE;
+                        state[parentIndex] = static_cast<quint8>(qMin(code + 1, MAX_CODE));
+                        longest = qMax(longest, dtm + 1);
+                    }
+                } else if (parentState == UNKNOWN && --remaining[parentIndex] == 0) {
+                    resolveLoss(parentIndex, parent);
+                }
+            });
+        }
+    }
+    if (overflow) {
+        return nullptr;
+    }
+
+    // Pack the codes into as few bits as the longest mate needs
+    table->longestMate = longest;
+    table->bits = 1;
+    while ((1 << table->bits) <= longest + 1) {
+        table->bits++;
+    }
+    table->words = QVector<quint64>(static_cast<int>(table->wordCount()), 0);
+    quint64* words = table->words.data();
+    for (qint64 index = 0; index < size; index++) {
+        quint64 code = state[static_cast<int>(index)];
+        if (code == ILLEGAL || code == STALEMATE) {
+            code = 0;
+        }
+        qint64 bit = index * table->bits;
+        int shift = static_cast<int>(bit & 63);
+        words[bit >> 6] |= code << shift;
+        if (shift + table->bits > 64) {
+            words[(bit >> 6) + 1] |= code >> (64 - shift);
+        }
+    }
+    for (int i = 0; i < table->words.size(); i++) {
+        words[i] = qToLittleEndian(words[i]);
+    }
+    table->data = reinterpret_cast<const uchar*>(table->words.constData());
+    return table.release();
+}
+
+/**
+ * @brief Maps a table from a cached file
+ *
+ * The header holds the magic, the layout version, the material key, the
+ * bits per code and the longest mate, all little-endian.
+ *
+ * @param path File to map
+ * @return TablebaseTable* The table, or nullptr if the file is missing or invalid
+ */
+TablebaseTable* EndgameTablebase::loadFile(const QString& path) {
+    std::unique_ptr<QFile> file(new QFile(path));
+    if (!file->open(QIODevice::ReadOnly) || file->size() < HEADER_SIZE) {
+        return nullptr;
+    }
+    const uchar* mapped = file->map(0, file->size());
+    if (!mapped || std::memcmp(mapped, FILE_MAGIC, 4) != 0 ||
+        qFromLittleEndian<quint32>(mapped + 4) != FILE_VERSION) {
+        return nullptr;
+    }
+
+    quint64 key = qFromLittleEndian<quint64>(mapped + 8);
+    int bits = static_cast<int>(qFromLittleEndian<quint32>(mapped + 16));
+    if (!isSupported(key) || canonicalKey(key) != key || bits < 1 || bits > 8) {
+        return nullptr;
+    }
+
+    std::unique_ptr<TablebaseTable> table(new TablebaseTable(key));
+    table->bits = bits;
+    table->longestMate = static_cast<int>(qFromLittleEndian<qint32>(mapped + 20));
+    if (file->size() != HEADER_SIZE + 8 * table->wordCount()) {
+        return nullptr;
+    }
+    table->data = mapped + HEADER_SIZE;
+    table->file = std::move(file);
+    return table.release();
+}
+
+/**
+ * @brief Writes a table to the cache directory
+ *
+ * @param table Table to save
+ * @return bool True if the file was written
+ */
+bool EndgameTablebase::saveFile(const TablebaseTable& table) const {
+    QFile file(filePath(table.key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    uchar header[HEADER_SIZE];
+    std::memcpy(header, FILE_MAGIC, 4);
+    qToLittleEndian<quint32>(FILE_VERSION, header + 4);
+    qToLittleEndian<quint64>(table.key, header + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(table.bits), header + 16);
+    qToLittleEndian<qint32>(table.longestMate, header + 20);
+
+    qint64 dataSize = 8 * table.wordCount();
+    return file.write(reinterpret_cast<const char*>(header), HEADER_SIZE) == HEADER_SIZE &&
+           file.write(reinterpret_cast<const char*>(table.data), dataSize) == dataSize;
+}
+
+/**
+ * @brief Gets the stored code of a position
+ *
+ * @param position Position in any piece order and either color
+ * @return int 0 for a draw, otherwise the distance to mate plus one;
+ *         -1 if no table covers the position
+ */
+int EndgameTablebase::lookup(const TablebasePosition& position) const {
+    // Bare kings can't mate
+    if (position.count == 0) {
+        return 0;
+    }
+    quint64 key = materialKeyOf(position);
+    bool flip = isFlipped(key);
+    auto it = tables.constFind(flip ? flipKey(key) : key);
+    if (it == tables.constEnd()) {
+        return -1;
+    }
+    const TablebaseTable* table = it.value();
+    return table->code(table->indexOf(position, flip));
+}
+
+/**
+ * @brief Gets the path of a table's file in the cache directory
+ *
+ * @param key Canonical material key of the table
+ * @return QString Path of the file
+ */
+QString EndgameTablebase::filePath(quint64 key) const {
+    return QDir(cacheDirectory).filePath(signature(key) + FILE_EXTENSION);
+}
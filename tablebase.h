@@ -0,0 +1,210 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <QHash>
+#include <QString>
+#include <atomic>
+
+class GameState;
+struct TablebaseTable;
+struct TablebasePosition;
+
+/**
+ * @class EndgameTablebase
+ * @brief Distance-to-mate tables for endings with few pieces, built in-process
+ *
+ * Every table covers one material signature (KQvK, KPvK, KBNvK, ...)
+ * with both kings and up to MAX_PIECES pieces in all. It is built by
+ * retrograde analysis: starting from the checkmates, positions are
+ * resolved backwards one ply at a time, so each legal position gets its
+ * exact result and the number of plies to mate with best play. Captures
+ * and promotions lead into smaller tables, which are built first.
+ *
+ * A table is stored as one code per position, packed into as few bits as
+ * its longest mate needs: 0 for a draw (or an illegal position), or the
+ * distance to mate plus one. Odd distances are wins for the side to move,
+ * even ones losses. Positions are indexed by side to move, the two kings
+ * and the other pieces in order of color and type, with the stronger side
+ * stored as white; the weaker side's positions are probed with the board
+ * flipped.
+ *
+ * Tables ignore castling, en passant and the fifty-move rule, so positions
+ * with castling rights or an en passant square are never probed, and
+ * signatures with pawns on both sides are not built.
+ *
+ * With a cache directory, generated tables are saved there and later
+ * memory-mapped instead of generated again. Building can be cancelled
+ * from another thread through setCancelFlag().
+ *
+ * @author Group 69 (mittensOS)
+ */
+class EndgameTablebase {
+public:
+    /** @brief Most pieces, kings included, of any table */
+    static const int MAX_PIECES = 4;
+
+    /** @brief Extension of the files in the cache directory */
+    static constexpr const char* FILE_EXTENSION = ".mtb";
+
+    /**
+     * @brief Constructor for an empty tablebase
+     */
+    EndgameTablebase();
+
+    /**
+     * @brief Destructor; unmaps the cached files
+     */
+    ~EndgameTablebase();
+
+    EndgameTablebase(const EndgameTablebase&) = delete;
+    EndgameTablebase& operator=(const EndgameTablebase&) = delete;
+
+    /**
+     * @brief Sets the directory that tables are loaded from and saved to
+     *
+     * Only used if the directory exists.
+     *
+     * @param path Directory, or an empty string to keep tables in memory only
+     */
+    void setCacheDirectory(const QString& path);
+
+    /**
+     * @brief Sets a flag that cancels the table being built
+     *
+     * While the flag is raised, building stops within a few thousand
+     * positions and generate() returns false; nothing is saved.
+     *
+     * @param flag Flag to poll, or nullptr to never cancel
+     */
+    void setCancelFlag(const std::atomic<bool>* flag);
+
+    /**
+     * @brief Makes the table of a material signature available
+     *
+     * Maps the cached file if there is one, and otherwise builds the table
+     * (and any smaller tables it leads into) and saves it to the cache.
+     *
+     * @param materialKey Material key of the signature (see GameState::materialKey), either color
+     * @return True if the table is available, false if the signature is not supported
+     *         or building was cancelled
+     */
+    bool generate(quint64 materialKey);
+
+    /**
+     * @brief Makes every table with up to the given number of pieces available
+     *
+     * @param maxPieces Most pieces, kings included (at most MAX_PIECES)
+     * @return Number of tables available afterwards
+     */
+    int generateAll(int maxPieces);
+
+    /**
+     * @brief Maps every table found in the cache directory
+     *
+     * Files that don't hold a valid table are skipped.
+     *
+     * @return Number of tables loaded
+     */
+    int loadCachedTables();
+
+    /**
+     * @brief Checks whether the table of a signature is available
+     *
+     * @param materialKey Material key of the signature, either color
+     * @return True if the table has been generated or loaded
+     */
+    bool contains(quint64 materialKey) const;
+
+    /**
+     * @brief Gets the number of tables available
+     * @return Number of tables
+     */
+    int tableCount() const;
+
+    /**
+     * @brief Gets the longest mate in a table
+     *
+     * @param materialKey Material key of the signature, either color
+     * @return Greatest distance to mate in plies, or -1 if the table is not available
+     */
+    int longestMate(quint64 materialKey) const;
+
+    /**
+     * @brief Looks up the result of a position
+     *
+     * Never allocates, so the search can call it at every node.
+     *
+     * @param gs Position to look up
+     * @param wdl Receives 1 if the side to move wins, 0 for a draw, -1 if it loses
+     * @param dtm Receives the plies to mate with best play (0 for a draw)
+     * @return True if the position is covered by an available table
+     */
+    bool probe(const GameState& gs, int& wdl, int& dtm) const;
+
+    /**
+     * @brief Gets the name of a material signature
+     *
+     * @param materialKey Material key of the signature
+     * @return Stronger side first, pieces from queen to pawn (e.g. "KBNvK")
+     */
+    static QString signature(quint64 materialKey);
+
+private:
+    /** @brief Available tables by canonical material key, owned */
+    QHash<quint64, TablebaseTable*> tables;
+
+    /** @brief Directory for cached tables, or empty */
+    QString cacheDirectory;
+
+    /** @brief Flag that cancels building, or nullptr */
+    const std::atomic<bool>* cancelFlag;
+
+    /**
+     * @brief Checks whether building has been cancelled
+     * @return True if the cancel flag is set and raised
+     */
+    bool cancelled() const;
+
+    /**
+     * @brief Builds a table by retrograde analysis
+     *
+     * @param key Canonical material key of the table
+     * @return The table, or nullptr if a table it leads into could not be built
+     */
+    TablebaseTable* build(quint64 key);
+
+    /**
+     * @brief Maps a table from a cached file
+     *
+     * @param path File to map
+     * @return The table, or nullptr if the file is missing or invalid
+     */
+    static TablebaseTable* loadFile(const QString& path);
+
+    /**
+     * @brief Writes a table to the cache directory
+     *
+     * @param table Table to save
+     * @return True if the file was written
+     */
+    bool saveFile(const TablebaseTable& table) const;
+
+    /**
+     * @brief Gets the stored code of a position
+     *
+     * @param position Position in any piece order and either color
+     * @return 0 for a draw, otherwise the distance to mate plus one;
+     *         -1 if no table covers the position
+     */
+    int lookup(const TablebasePosition& position) const;
+
+    /**
+     * @brief Gets the path of a table's file in the cache directory
+     *
+     * @param key Canonical material key of the table
+     * @return Path of the file
+     */
+    QString filePath(quint64 key) const;
+};
+
+#endif // TABLEBASE_H
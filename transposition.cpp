@@ -0,0 +1,59 @@
+#include "transposition.h"
+
+/**
+ * @brief Constructor for the TranspositionTable class
+ *
+ * Allocates all entries up front so that probing never allocates.
+ */
+TranspositionTable::TranspositionTable() : entries(SIZE, TTEntry{0, 0, 0, 0, TTEntry::None}) {
+}
+
+/**
+ * @brief Looks up a position
+ *
+ * @param key Zobrist hash of the position
+ * @return const TTEntry* The entry for the position, or nullptr if it is not stored
+ */
+const TTEntry* TranspositionTable::probe(quint64 key) const {
+    const TTEntry& entry = entries[static_cast<int>(key & (SIZE - 1))];
+    if (entry.bound == TTEntry::None || entry.key != key) {
+        return nullptr;
+    }
+    return &entry;
+}
+
+/**
+ * @brief Stores the result of a search
+ *
+ * A deeper result for a different position is only replaced by an exact
+ * score, so the entries most expensive to recompute survive longest.
+ * When the new result has no best move, the stored one is kept if it is
+ * for the same position.
+ *
+ * @param key Zobrist hash of the position
+ * @param score Score adjusted with ChessAI::scoreToTT()
+ * @param bestMove moveID of the best move, or 0 to keep the stored one
+ * @param depth Remaining depth of the search
+ * @param bound Kind of bound the score is
+ */
+void TranspositionTable::store(quint64 key, int score, int bestMove, int depth, TTEntry::Bound bound) {
+    TTEntry& entry = entries[static_cast<int>(key & (SIZE - 1))];
+    if (entry.bound != TTEntry::None && entry.key != key && entry.depth > depth && bound != TTEntry::Exact) {
+        return;
+    }
+    if (bestMove == 0 && entry.key == key) {
+        bestMove = entry.bestMove;
+    }
+    entry.key = key;
+    entry.score = score;
+    entry.bestMove = bestMove;
+    entry.depth = static_cast<qint16>(depth);
+    entry.bound = static_cast<quint8>(bound);
+}
+
+/**
+ * @brief Empties the table
+ */
+void TranspositionTable::clear() {
+    entries.fill(TTEntry{0, 0, 0, 0, TTEntry::None});
+}
@@ -0,0 +1,93 @@
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @struct TTEntry
+ * @brief Result of one search stored in the transposition table
+ */
+struct TTEntry {
+    /**
+     * @brief How the stored score relates to the true value of the position
+     */
+    enum Bound {
+        /** @brief Empty entry */
+        None,
+        /** @brief The score is exact (a PV node) */
+        Exact,
+        /** @brief The true value is at least the score (a beta cutoff) */
+        Lower,
+        /** @brief The true value is at most the score (no move beat alpha) */
+        Upper
+    };
+
+    /** @brief Zobrist hash of the position */
+    quint64 key;
+
+    /** @brief Score, with mate scores counted from this position (see ChessAI::scoreToTT()) */
+    int score;
+
+    /** @brief moveID of the best move found, or 0 */
+    int bestMove;
+
+    /** @brief Remaining depth the position was searched to */
+    qint16 depth;
+
+    /** @brief Kind of bound the score is */
+    quint8 bound;
+};
+
+/**
+ * @class TranspositionTable
+ * @brief Fixed-size cache of search results keyed by Zobrist hash
+ *
+ * Positions reached again by a different move order, or in the next
+ * iteration of iterative deepening, can reuse the stored score if it was
+ * searched deep enough, and otherwise search the stored best move first.
+ * The table is direct-mapped; a store replaces the old entry unless that
+ * one is for another position searched deeper and this one is not exact.
+ *
+ * @author Group 69 (mittensOS)
+ */
+class TranspositionTable {
+public:
+    /** @brief Number of entries in the table (a power of two) */
+    static const int SIZE = 262144;
+
+    /**
+     * @brief Constructor for the TranspositionTable class
+     */
+    TranspositionTable();
+
+    /**
+     * @brief Looks up a position
+     *
+     * @param key Zobrist hash of the position
+     * @return The entry for the position, or nullptr if it is not stored
+     */
+    const TTEntry* probe(quint64 key) const;
+
+    /**
+     * @brief Stores the result of a search
+     *
+     * @param key Zobrist hash of the position
+     * @param score Score adjusted with ChessAI::scoreToTT()
+     * @param bestMove moveID of the best move, or 0 to keep the stored one
+     * @param depth Remaining depth of the search
+     * @param bound Kind of bound the score is
+     */
+    void store(quint64 key, int score, int bestMove, int depth, TTEntry::Bound bound);
+
+    /**
+     * @brief Empties the table
+     */
+    void clear();
+
+private:
+    /** @brief Table entries, indexed by the low bits of the hash */
+    QVector<TTEntry> entries;
+};
+
+#endif // TRANSPOSITION_H